@@ -0,0 +1,106 @@
+/**
+ * @file bench.c
+ * @brief Microbenchmarks of the geometry kernels and utilities (gaegebra_bench [filter]),
+ * and the scaling benchmark of whole scenes (gaegebra_bench --scaling [csv path] [max shapes])
+ */
+
+#include "bench.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+volatile double bench_sink = 0.0;
+
+static const char* filter = NULL;
+static Uint32 random_state = BENCH_SEED;
+
+static int _bench_compare(const void* a, const void* b)
+{
+    double x = *(const double*)a;
+    double y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+static double _bench_measure(BenchFunction function, void* data, size_t iterations)
+{
+    Uint64 start = SDL_GetPerformanceCounter();
+    function(data, iterations);
+    Uint64 end = SDL_GetPerformanceCounter();
+    return (double)(end - start) / (double)SDL_GetPerformanceFrequency();
+}
+
+void bench_init(int argc, char** argv)
+{
+    filter = argc > 1 ? argv[1] : NULL;
+    printf("%-44s %10s %10s %10s %10s %10s %10s\n", "benchmark (ns/op)", "iters", "min", "median", "mean", "stddev", "p99");
+}
+bool bench_selected(const char* name)
+{
+    return filter == NULL || strstr(name, filter) != NULL;
+}
+BenchResult bench_run(const char* name, BenchFunction function, void* data)
+{
+    BenchResult result = { 0, 0.0, 0.0, 0.0, 0.0, 0.0 };
+    if (!bench_selected(name))
+        return result;
+
+    //warm up and calibrate the batch size
+    size_t iterations = 1;
+    while (_bench_measure(function, data, iterations) < BENCH_MIN_BATCH_TIME && iterations < ((size_t)1 << 30))
+        iterations *= 2;
+
+    double samples[BENCH_REPETITIONS];
+    double sum = 0.0;
+    for (int i = 0; i < BENCH_REPETITIONS; i++)
+    {
+        samples[i] = _bench_measure(function, data, iterations) * 1e9 / iterations;
+        sum += samples[i];
+    }
+    qsort(samples, BENCH_REPETITIONS, sizeof(double), _bench_compare);
+
+    result.iterations = iterations;
+    result.min = samples[0];
+    result.median = samples[BENCH_REPETITIONS / 2];
+    result.mean = sum / BENCH_REPETITIONS;
+    double variance = 0.0;
+    for (int i = 0; i < BENCH_REPETITIONS; i++)
+        variance += (samples[i] - result.mean) * (samples[i] - result.mean);
+    result.stddev = sqrt(variance / (BENCH_REPETITIONS - 1));
+    result.p99 = samples[(BENCH_REPETITIONS * 99 - 1) / 100];
+
+    printf("%-44s %10zu %10.2f %10.2f %10.2f %10.2f %10.2f\n", name, result.iterations,
+           result.min, result.median, result.mean, result.stddev, result.p99);
+    fflush(stdout);
+    return result;
+}
+void bench_seed()
+{
+    random_state = BENCH_SEED;
+}
+Uint32 bench_random()
+{
+    random_state ^= random_state << 13;
+    random_state ^= random_state >> 17;
+    random_state ^= random_state << 5;
+    return random_state;
+}
+double bench_random_double(double min, double max)
+{
+    return min + (max - min) * (bench_random() / 4294967296.0);
+}
+
+int main(int argc, char** argv)
+{
+    if (argc > 1 && strcmp(argv[1], "--scaling") == 0)
+    {
+        const char* path = argc > 2 ? argv[2] : "gaegebra_scaling.csv";
+        size_t max_shapes = argc > 3 ? strtoull(argv[3], NULL, 10) : BENCH_SCALING_MAX_SHAPES;
+        bench_scaling(path, max_shapes);
+        return 0;
+    }
+    bench_init(argc, argv);
+    bench_geometry();
+    bench_utils();
+    return 0;
+}
@@ -0,0 +1,106 @@
+#pragma once
+
+#ifdef _WIN32
+    #include <SDL.h>
+#elif defined(__unix__) || defined(__linux__)
+    #include <SDL2/SDL.h>
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "geometry/coordinate_system/coordinate_system.h"
+
+#define BENCH_REPETITIONS 51
+#define BENCH_MIN_BATCH_TIME 0.002
+#define BENCH_SEED 0x9E3779B9u
+#define BENCH_SCALING_MAX_SHAPES 1000000
+
+/**
+ * @brief A benchmarked function, it has to run the measured operation the given number of times
+ */
+typedef void (*BenchFunction)(void* data, size_t iterations);
+
+/**
+ * @brief The result of a benchmark (times are in nanoseconds per operation)
+ */
+typedef struct BenchResult
+{
+    size_t iterations;
+    double min;
+    double median;
+    double mean;
+    double stddev;
+    double p99;
+} BenchResult;
+
+/**
+ * @brief Results are written here, so the compiler can not optimize the measured code away
+ */
+extern volatile double bench_sink;
+
+/**
+ * @brief Parses the command line (the first argument is an optional substring filter for the benchmark names) and prints the header
+ *
+ * @param argc The argument count
+ * @param argv The arguments
+ */
+void bench_init(int argc, char** argv);
+/**
+ * @brief Checks if a benchmark is selected by the filter
+ *
+ * @param name The name of the benchmark
+ * @return true If the benchmark should run
+ * @return false If the benchmark is filtered out
+ */
+bool bench_selected(const char* name);
+/**
+ * @brief Runs a benchmark: calibrates the batch size to at least BENCH_MIN_BATCH_TIME, then measures BENCH_REPETITIONS batches and prints the statistics
+ *
+ * @param name The name of the benchmark
+ * @param function The benchmarked function
+ * @param data The data passed to the function
+ * @return BenchResult The statistics of the benchmark (all zero if it was filtered out)
+ */
+BenchResult bench_run(const char* name, BenchFunction function, void* data);
+/**
+ * @brief Resets the random generator, so every benchmark gets the same input
+ */
+void bench_seed();
+/**
+ * @brief Returns a pseudo random number (xorshift32)
+ *
+ * @return Uint32 The random number
+ */
+Uint32 bench_random();
+/**
+ * @brief Returns a pseudo random double in a range
+ *
+ * @param min The lower bound
+ * @param max The upper bound
+ * @return double The random number
+ */
+double bench_random_double(double min, double max);
+
+/**
+ * @brief Runs the geometry benchmarks (intersections, overlap tests, coordinate transforms, line drawing)
+ */
+void bench_geometry();
+/**
+ * @brief Runs the utility benchmarks (Vector container, Vector2 math)
+ */
+void bench_utils();
+/**
+ * @brief Generates a scene like a user would build it: free points, lines and circles through them, and parallels, perpendiculars, angle bisectors and tangents built on those (the same count always gives the same scene)
+ *
+ * @param shape_count The number of shapes in the scene
+ * @return CoordinateSystem* The generated coordinate system (1280x720, origin in the middle)
+ */
+CoordinateSystem* bench_scene_create(size_t shape_count);
+/**
+ * @brief Measures the update, picking, save, load and cascading delete of generated scenes from 10 shapes up to max_shapes (1-2-5 steps), and writes the scaling curves as CSV
+ *
+ * @param path The path of the CSV file
+ * @param max_shapes The size of the largest scene
+ */
+void bench_scaling(const char* path, size_t max_shapes);
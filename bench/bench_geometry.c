@@ -0,0 +1,369 @@
+#include "bench.h"
+
+#include "geometry/clip/clip.h"
+#include "geometry/coordinate_system/coordinate_system.h"
+#include "geometry/intersection/intersection.h"
+#include "geometry/shape/shape.h"
+#include "renderer/renderer.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define BENCH_SHAPES 64
+#define BENCH_POINTS 1024
+#define BENCH_WIDTH 1280
+#define BENCH_HEIGHT 720
+#define BENCH_TILED_SIZE 4096
+
+typedef struct GeometryData
+{
+    CoordinateSystem* cs;
+    Shape* shapes[ST_COUNT][BENCH_SHAPES];
+    Vector2 screen_points[BENCH_POINTS];
+    Vector2 world_points[BENCH_POINTS];
+} GeometryData;
+
+typedef struct PairData
+{
+    GeometryData* geometry;
+    ShapeType type1;
+    ShapeType type2;
+} PairData;
+
+typedef struct TypeData
+{
+    GeometryData* geometry;
+    ShapeType type;
+} TypeData;
+
+typedef struct BatchData
+{
+    LineCircleBatch* line_circle;
+    CircleCircleBatch* circle_circle;
+} BatchData;
+
+typedef struct RasterData
+{
+    GeometryData* geometry;
+    RasterImage* image;
+    ThreadPool* pool;
+} RasterData;
+
+static const char* type_names[ST_COUNT] = { "point", "line", "circle", "parallel", "perpendicular", "bisector", "tangent" };
+
+static Point* _random_point(CoordinateSystem* cs)
+{
+    return point_create(cs, vector2_create(bench_random_double(-30.0, 30.0), bench_random_double(-18.0, 18.0)));
+}
+static void _create_shapes(GeometryData* data)
+{
+    CoordinateSystem* cs = data->cs;
+    for (int i = 0; i < BENCH_SHAPES; i++)
+    {
+        Point* p1 = _random_point(cs);
+        Point* p2 = _random_point(cs);
+        Point* p3 = _random_point(cs);
+        Point* p4 = _random_point(cs);
+        Line* line1 = line_create(cs, p1, p2);
+        Line* line2 = line_create(cs, p3, p4);
+        Circle* circle = circle_create(cs, p3, p1);
+        data->shapes[ST_POINT][i] = (Shape*)p1;
+        data->shapes[ST_LINE][i] = (Shape*)line1;
+        data->shapes[ST_CIRCLE][i] = (Shape*)circle;
+        data->shapes[ST_PARALLEL][i] = (Shape*)parallel_create(cs, line1, p3);
+        data->shapes[ST_PERPENDICULAR][i] = (Shape*)perpendicular_create(cs, line1, p4);
+        data->shapes[ST_ANGLE_BISECTOR][i] = (Shape*)angle_bisector_create(cs, line1, line2);
+        data->shapes[ST_TANGENT][i] = (Shape*)tangent_create(cs, circle, p4);
+    }
+    for (int i = 0; i < BENCH_POINTS; i++)
+    {
+        data->screen_points[i] = vector2_create(bench_random_double(0.0, BENCH_WIDTH), bench_random_double(0.0, BENCH_HEIGHT));
+        data->world_points[i] = vector2_create(bench_random_double(-30.0, 30.0), bench_random_double(-18.0, 18.0));
+    }
+}
+static void _free_intersections(Vector* intersections)
+{
+    if (intersections == NULL)
+        return;
+    for (size_t i = 0; i < vector_size(intersections); i++)
+        free(vector_get(intersections, i));
+    vector_destroy(intersections);
+}
+
+static void _bench_intersection(void* data, size_t iterations)
+{
+    PairData* pair = (PairData*)data;
+    size_t count = 0;
+    for (size_t i = 0; i < iterations; i++)
+    {
+        Shape* shape1 = pair->geometry->shapes[pair->type1][i % BENCH_SHAPES];
+        Shape* shape2 = pair->geometry->shapes[pair->type2][(i * 7 + 3) % BENCH_SHAPES];
+        Vector* intersections = intersection_get(shape1, shape2);
+        count += vector_size(intersections);
+        _free_intersections(intersections);
+    }
+    bench_sink = count;
+}
+static void _bench_line_circle_batch(void* data, size_t iterations)
+{
+    //one operation is one pair, the batch holds BENCH_POINTS pairs and is shortened for the last run
+    LineCircleBatch* batch = ((BatchData*)data)->line_circle;
+    size_t count = 0;
+    for (size_t i = 0; i < iterations; i += BENCH_POINTS)
+    {
+        batch->count = SDL_min(iterations - i, BENCH_POINTS);
+        line_circle_batch_run(batch);
+        count += batch->found[0] + batch->found[batch->count - 1];
+    }
+    batch->count = BENCH_POINTS;
+    bench_sink = count;
+}
+static void _bench_circle_circle_batch(void* data, size_t iterations)
+{
+    CircleCircleBatch* batch = ((BatchData*)data)->circle_circle;
+    size_t count = 0;
+    for (size_t i = 0; i < iterations; i += BENCH_POINTS)
+    {
+        batch->count = SDL_min(iterations - i, BENCH_POINTS);
+        circle_circle_batch_run(batch);
+        count += batch->found[0] + batch->found[batch->count - 1];
+    }
+    batch->count = BENCH_POINTS;
+    bench_sink = count;
+}
+static void _bench_overlap(void* data, size_t iterations)
+{
+    TypeData* type = (TypeData*)data;
+    size_t count = 0;
+    for (size_t i = 0; i < iterations; i++)
+    {
+        Shape* shape = type->geometry->shapes[type->type][i % BENCH_SHAPES];
+        count += shape_overlap_point(type->geometry->cs, shape, type->geometry->screen_points[i % BENCH_POINTS]);
+    }
+    bench_sink = count;
+}
+static void _bench_coordinates_to_screen(void* data, size_t iterations)
+{
+    GeometryData* geometry = (GeometryData*)data;
+    double sum = 0.0;
+    for (size_t i = 0; i < iterations; i++)
+    {
+        Vector2 point = coordinates_to_screen(geometry->cs, geometry->world_points[i % BENCH_POINTS]);
+        sum += point.x + point.y;
+    }
+    bench_sink = sum;
+}
+static void _bench_screen_to_coordinates(void* data, size_t iterations)
+{
+    GeometryData* geometry = (GeometryData*)data;
+    double sum = 0.0;
+    for (size_t i = 0; i < iterations; i++)
+    {
+        Vector2 point = screen_to_coordinates(geometry->cs, geometry->screen_points[i % BENCH_POINTS]);
+        sum += point.x + point.y;
+    }
+    bench_sink = sum;
+}
+static void _bench_to_screen_batch(void* data, size_t iterations)
+{
+    //one operation is one converted point, the batches are at most BENCH_POINTS long
+    GeometryData* geometry = (GeometryData*)data;
+    Vector2 screen[BENCH_POINTS];
+    double sum = 0.0;
+    for (size_t i = 0; i < iterations; i += BENCH_POINTS)
+    {
+        size_t count = SDL_min(iterations - i, BENCH_POINTS);
+        view_transform_to_screen_batch(&geometry->cs->view, geometry->world_points, screen, count);
+        sum += screen[0].x + screen[count - 1].y;
+    }
+    bench_sink = sum;
+}
+static void _bench_distance(void* data, size_t iterations)
+{
+    GeometryData* geometry = (GeometryData*)data;
+    Vector2 center = geometry->world_points[0];
+    double sum = 0.0;
+    for (size_t i = 0; i < iterations; i++)
+        sum += vector2_distance(geometry->world_points[i % BENCH_POINTS], center);
+    bench_sink = sum;
+}
+static void _bench_distance_squared_x4(void* data, size_t iterations)
+{
+    //one operation is one vector, 4 of them are processed at once
+    GeometryData* geometry = (GeometryData*)data;
+    Vector2x4 center = vector2x4_splat(geometry->world_points[0]);
+    Doublex4 sum = { 0.0, 0.0, 0.0, 0.0 };
+    for (size_t i = 0; i < iterations; i += 4)
+    {
+        Doublex4 distances;
+        vector2x4_distance_squared(vector2x4_load(&geometry->world_points[i % BENCH_POINTS]), center, &distances);
+        sum += distances;
+    }
+    bench_sink = sum[0] + sum[1] + sum[2] + sum[3];
+}
+static void _bench_clip_line(void* data, size_t iterations)
+{
+    GeometryData* geometry = (GeometryData*)data;
+    Vector2 min = vector2_create(0, 0);
+    Vector2 max = vector2_create(BENCH_WIDTH, BENCH_HEIGHT);
+    double sum = 0.0;
+    for (size_t i = 0; i < iterations; i++)
+    {
+        Vector2 a, b;
+        if (clip_line_to_rect(geometry->screen_points[i % BENCH_POINTS], geometry->screen_points[(i + 1) % BENCH_POINTS], min, max, &a, &b))
+            sum += a.x + b.y;
+    }
+    bench_sink = sum;
+}
+static void _bench_line_draw(void* data, size_t iterations)
+{
+    TypeData* type = (TypeData*)data;
+    for (size_t i = 0; i < iterations; i++)
+        shape_draw(type->geometry->cs, type->geometry->shapes[type->type][i % BENCH_SHAPES]);
+}
+static void _bench_raster_scene(void* data, size_t iterations)
+{
+    RasterData* raster = (RasterData*)data;
+    for (size_t i = 0; i < iterations; i++)
+    {
+        renderer_clear(WHITE);
+        coordinate_system_draw(raster->geometry->cs);
+    }
+}
+static void _bench_raster_tiled(void* data, size_t iterations)
+{
+    RasterData* raster = (RasterData*)data;
+    for (size_t i = 0; i < iterations; i++)
+    {
+        raster_begin_batch(raster->image);
+        renderer_clear(WHITE);
+        coordinate_system_draw(raster->geometry->cs);
+        raster_end_batch(raster->image, raster->pool);
+    }
+}
+static void _bench_update_intersections(void* data, size_t iterations)
+{
+    GeometryData* geometry = (GeometryData*)data;
+    for (size_t i = 0; i < iterations; i++)
+        coordinate_system_update_intersections(geometry->cs);
+    bench_sink = vector_size(geometry->cs->intersection_points);
+}
+static void _bench_raster_line(void* data, size_t iterations)
+{
+    RasterData* raster = (RasterData*)data;
+    for (size_t i = 0; i < iterations; i++)
+    {
+        Vector2 p1 = raster->geometry->screen_points[i % BENCH_POINTS];
+        Vector2 p2 = raster->geometry->screen_points[(i + 1) % BENCH_POINTS];
+        raster_draw_line(raster->image, p1.x, p1.y, p2.x, p2.y, 1.0, BLACK);
+    }
+}
+static void _bench_raster_circle(void* data, size_t iterations)
+{
+    RasterData* raster = (RasterData*)data;
+    for (size_t i = 0; i < iterations; i++)
+    {
+        Vector2 center = raster->geometry->screen_points[i % BENCH_POINTS];
+        raster_draw_filled_ellipse(raster->image, center.x, center.y, 50.0, 50.0, (Color){ 40, 80, 200, 128 });
+    }
+}
+
+void bench_geometry()
+{
+    bench_seed();
+    GeometryData data;
+    data.cs = coordinate_system_create(vector2_create(0, 0), vector2_create(BENCH_WIDTH, BENCH_HEIGHT), vector2_create(0.5, 0.5));
+    _create_shapes(&data);
+
+    char name[64];
+    for (int i = 0; i < ST_COUNT; i++)
+    {
+        for (int j = 0; j < ST_COUNT; j++)
+        {
+            PairData pair = { &data, (ShapeType)i, (ShapeType)j };
+            snprintf(name, sizeof(name), "intersection_get %s x %s", type_names[i], type_names[j]);
+            bench_run(name, _bench_intersection, &pair);
+        }
+    }
+    //the same kind of pairs as above, gathered into batches
+    BatchData batches = { line_circle_batch_create(), circle_circle_batch_create() };
+    for (int i = 0; i < BENCH_POINTS; i++)
+    {
+        Line* line = (Line*)data.shapes[ST_LINE][i % BENCH_SHAPES];
+        Circle* circle1 = (Circle*)data.shapes[ST_CIRCLE][i % BENCH_SHAPES];
+        Circle* circle2 = (Circle*)data.shapes[ST_CIRCLE][(i * 7 + 3) % BENCH_SHAPES];
+        double radius1 = vector2_distance(circle1->center->coordinates, circle1->perimeter_point->coordinates);
+        double radius2 = vector2_distance(circle2->center->coordinates, circle2->perimeter_point->coordinates);
+        line_circle_batch_add(batches.line_circle, line->p1->coordinates, vector2_subtract(line->p2->coordinates, line->p1->coordinates), circle2->center->coordinates, radius2);
+        circle_circle_batch_add(batches.circle_circle, circle1->center->coordinates, radius1, circle2->center->coordinates, radius2);
+    }
+    bench_run("line_circle_batch_run", _bench_line_circle_batch, &batches);
+    bench_run("circle_circle_batch_run", _bench_circle_circle_batch, &batches);
+    line_circle_batch_destroy(batches.line_circle);
+    circle_circle_batch_destroy(batches.circle_circle);
+    for (int i = 0; i < ST_COUNT; i++)
+    {
+        TypeData type = { &data, (ShapeType)i };
+        snprintf(name, sizeof(name), "shape_overlap_point %s", type_names[i]);
+        bench_run(name, _bench_overlap, &type);
+    }
+    bench_run("coordinates_to_screen", _bench_coordinates_to_screen, &data);
+    bench_run("screen_to_coordinates", _bench_screen_to_coordinates, &data);
+    bench_run("view_transform_to_screen_batch", _bench_to_screen_batch, &data);
+    bench_run("vector2_distance", _bench_distance, &data);
+    bench_run("vector2x4_distance_squared", _bench_distance_squared_x4, &data);
+    bench_run("clip_line_to_rect", _bench_clip_line, &data);
+
+    //the lines are drawn into a 1x1 software renderer, so the clipping dominates instead of the rasterization
+    SDL_Surface* surface = SDL_CreateRGBSurfaceWithFormat(0, 1, 1, 32, SDL_PIXELFORMAT_RGBA8888);
+    SDL_Renderer* renderer = SDL_CreateSoftwareRenderer(surface);
+    _renderer_set_target(renderer);
+    for (int i = ST_LINE; i < ST_COUNT; i++)
+    {
+        if (i == ST_CIRCLE)
+            continue;
+        TypeData type = { &data, (ShapeType)i };
+        snprintf(name, sizeof(name), "line draw (clip) %s", type_names[i]);
+        bench_run(name, _bench_line_draw, &type);
+    }
+    SDL_DestroyRenderer(renderer);
+    SDL_FreeSurface(surface);
+
+    RasterData raster = { &data, raster_create(BENCH_WIDTH, BENCH_HEIGHT), NULL };
+    renderer_bind_raster(raster.image);
+    bench_run("raster coordinate_system_draw", _bench_raster_scene, &raster);
+    bench_run("raster line", _bench_raster_line, &raster);
+    bench_run("raster filled circle r50", _bench_raster_circle, &raster);
+    renderer_bind_raster(NULL);
+    raster_destroy(raster.image);
+
+    //the same scene on a larger canvas with 1, 2, 4, ... workers to see how the tiles scale with the cores
+    coordinate_system_update_dimensions(data.cs, vector2_create(0, 0), vector2_create(BENCH_TILED_SIZE, BENCH_TILED_SIZE));
+    raster.image = raster_create(BENCH_TILED_SIZE, BENCH_TILED_SIZE);
+    renderer_bind_raster(raster.image);
+    int cpu_count = SDL_GetCPUCount();
+    for (int workers = 1; ; workers = workers * 2 > cpu_count && workers < cpu_count ? cpu_count : workers * 2)
+    {
+        raster.pool = thread_pool_create(workers);
+        snprintf(name, sizeof(name), "raster tiled %dx%d (%d workers)", BENCH_TILED_SIZE, BENCH_TILED_SIZE, workers);
+        bench_run(name, _bench_raster_tiled, &raster);
+        thread_pool_destroy(raster.pool);
+        if (workers >= cpu_count)
+            break;
+    }
+    renderer_bind_raster(NULL);
+    raster_destroy(raster.image);
+
+    //the intersection pass of the whole scene (all the pairs of its shapes) with 1, 2, 4, ... workers
+    for (int workers = 1; ; workers = workers * 2 > cpu_count && workers < cpu_count ? cpu_count : workers * 2)
+    {
+        thread_pool_destroy(data.cs->intersection_pool);
+        data.cs->intersection_pool = thread_pool_create(workers);
+        snprintf(name, sizeof(name), "update_intersections %zu shapes (%d workers)", vector_size(data.cs->shapes), workers);
+        bench_run(name, _bench_update_intersections, &data);
+        if (workers >= cpu_count)
+            break;
+    }
+
+    coordinate_system_destroy(data.cs);
+}
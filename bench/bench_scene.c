@@ -0,0 +1,195 @@
+#include "bench.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define BENCH_SCENE_WIDTH 1280
+#define BENCH_SCENE_HEIGHT 720
+#define BENCH_SCENE_FILE "gaegebra_bench_scene.txt"
+#define BENCH_SCALING_PICKS 256
+#define BENCH_SCALING_BUDGET 5.0
+#define BENCH_SCALING_REPEAT_SHAPES 10000
+
+typedef enum ScalingOperation
+{
+    SO_UPDATE,
+    SO_PICK,
+    SO_SAVE,
+    SO_LOAD,
+    SO_DELETE,
+
+    SO_COUNT
+} ScalingOperation;
+
+static void* _random_element(Vector* vector)
+{
+    return vector_get(vector, bench_random() % vector_size(vector));
+}
+static double _elapsed(Uint64 start)
+{
+    return (double)(SDL_GetPerformanceCounter() - start) / (double)SDL_GetPerformanceFrequency();
+}
+static void _write_time(FILE* file, double time, double scale)
+{
+    //skipped operations leave an empty field
+    if (time < 0.0)
+        fprintf(file, ",");
+    else
+        fprintf(file, ",%.4f", time * scale);
+}
+static void _write_count(FILE* file, size_t count, bool measured)
+{
+    if (measured)
+        fprintf(file, ",%zu", count);
+    else
+        fprintf(file, ",");
+}
+
+CoordinateSystem* bench_scene_create(size_t shape_count)
+{
+    bench_seed();
+    CoordinateSystem* cs = coordinate_system_create(vector2_create(0, 0), vector2_create(BENCH_SCENE_WIDTH, BENCH_SCENE_HEIGHT), vector2_create(0.5, 0.5));
+    double half_width = BENCH_SCENE_WIDTH * 0.5 / cs->zoom;
+    double half_height = BENCH_SCENE_HEIGHT * 0.5 / cs->zoom;
+    Vector* points = vector_create(0);
+    Vector* lines = vector_create(0);
+    Vector* circles = vector_create(0);
+
+    while (vector_size(cs->shapes) < shape_count)
+    {
+        //roughly a third of the shapes are free points, the rest is built on them like a user would
+        Uint32 kind = bench_random() % 100;
+        if (kind >= 35 && vector_size(points) >= 2)
+        {
+            if (kind < 55)
+                vector_push_back(lines, line_create(cs, _random_element(points), _random_element(points)));
+            else if (kind < 65)
+                vector_push_back(circles, circle_create(cs, _random_element(points), _random_element(points)));
+            else if (kind < 75 && vector_size(lines) > 0)
+                parallel_create(cs, _random_element(lines), _random_element(points));
+            else if (kind < 85 && vector_size(lines) > 0)
+                perpendicular_create(cs, _random_element(lines), _random_element(points));
+            else if (kind < 92 && vector_size(lines) >= 2)
+                angle_bisector_create(cs, _random_element(lines), _random_element(lines));
+            else if (kind >= 92 && vector_size(circles) > 0)
+                tangent_create(cs, _random_element(circles), _random_element(points));
+            continue;
+        }
+        Vector2 coordinates = vector2_create(bench_random_double(-half_width, half_width), bench_random_double(-half_height, half_height));
+        vector_push_back(points, point_create(cs, coordinates));
+    }
+
+    vector_destroy(points);
+    vector_destroy(lines);
+    vector_destroy(circles);
+    return cs;
+}
+
+void bench_scaling(const char* path, size_t max_shapes)
+{
+    FILE* file = fopen(path, "w");
+    if (file == NULL)
+    {
+        printf("couldn't open scaling output file: %s\n", path);
+        exit(1);
+    }
+    fprintf(file, "shapes,generate_ms,update_ms,intersection_points,pick_us,save_ms,load_ms,delete_ms,deleted_shapes\n");
+
+    //an operation is dropped from the larger scenes once it exceeds the time budget (e.g. the O(n^2) intersection pass)
+    bool enabled[SO_COUNT];
+    for (int i = 0; i < SO_COUNT; i++)
+        enabled[i] = true;
+
+    static const size_t steps[] = { 1, 2, 5 };
+    for (size_t decade = 10; decade <= max_shapes; decade *= 10)
+    {
+        for (size_t step = 0; step < sizeof(steps) / sizeof(steps[0]) && decade * steps[step] <= max_shapes; step++)
+        {
+            size_t shape_count = decade * steps[step];
+            size_t repeats = shape_count < BENCH_SCALING_REPEAT_SHAPES ? BENCH_SCALING_REPEAT_SHAPES / shape_count : 1;
+            double times[SO_COUNT];
+            for (int i = 0; i < SO_COUNT; i++)
+                times[i] = -1.0;
+            size_t intersection_points = 0, deleted_shapes = 0;
+
+            Uint64 start = SDL_GetPerformanceCounter();
+            CoordinateSystem* cs = bench_scene_create(shape_count);
+            double generate_time = _elapsed(start);
+
+            if (enabled[SO_UPDATE])
+            {
+                for (size_t i = 0; i < repeats; i++)
+                {
+                    //the update skips the intersections while the shapes are unchanged, so they are recalculated explicitly
+                    start = SDL_GetPerformanceCounter();
+                    coordinate_system_update(cs);
+                    coordinate_system_update_intersections(cs);
+                    double time = _elapsed(start);
+                    if (times[SO_UPDATE] < 0.0 || time < times[SO_UPDATE])
+                        times[SO_UPDATE] = time;
+                }
+                intersection_points = vector_size(cs->intersection_points);
+            }
+            if (enabled[SO_PICK])
+            {
+                size_t hits = 0;
+                start = SDL_GetPerformanceCounter();
+                for (int i = 0; i < BENCH_SCALING_PICKS; i++)
+                {
+                    Vector2 point = vector2_create(bench_random_double(0, BENCH_SCENE_WIDTH), bench_random_double(0, BENCH_SCENE_HEIGHT));
+                    hits += coordinate_system_get_hovered_shape(cs, point) != NULL;
+                }
+                times[SO_PICK] = _elapsed(start) / BENCH_SCALING_PICKS;
+                bench_sink = hits;
+            }
+            if (enabled[SO_SAVE])
+            {
+                start = SDL_GetPerformanceCounter();
+                coordinate_system_save(cs, BENCH_SCENE_FILE);
+                times[SO_SAVE] = _elapsed(start);
+            }
+            if (enabled[SO_LOAD] && times[SO_SAVE] >= 0.0)
+            {
+                start = SDL_GetPerformanceCounter();
+                CoordinateSystem* loaded = coordinate_system_load(BENCH_SCENE_FILE);
+                times[SO_LOAD] = _elapsed(start);
+                coordinate_system_destroy(loaded);
+            }
+            if (enabled[SO_DELETE])
+            {
+                //select ~1% of the free points, deleting them cascades to everything built on them
+                size_t shapes_before = vector_size(cs->shapes);
+                for (size_t i = 0; i < shapes_before; i++)
+                {
+                    Shape* shape = vector_get(cs->shapes, i);
+                    if (shape->type == ST_POINT && bench_random() % 100 == 0)
+                        coordinate_system_select_shape(cs, shape);
+                }
+                start = SDL_GetPerformanceCounter();
+                coordinate_system_delete_selected_shapes(cs);
+                times[SO_DELETE] = _elapsed(start);
+                deleted_shapes = shapes_before - vector_size(cs->shapes);
+            }
+            coordinate_system_destroy(cs);
+
+            fprintf(file, "%zu,%.4f", shape_count, generate_time * 1e3);
+            _write_time(file, times[SO_UPDATE], 1e3);
+            _write_count(file, intersection_points, times[SO_UPDATE] >= 0.0);
+            _write_time(file, times[SO_PICK], 1e6);
+            _write_time(file, times[SO_SAVE], 1e3);
+            _write_time(file, times[SO_LOAD], 1e3);
+            _write_time(file, times[SO_DELETE], 1e3);
+            _write_count(file, deleted_shapes, times[SO_DELETE] >= 0.0);
+            fprintf(file, "\n");
+            for (int i = 0; i < SO_COUNT; i++)
+                if (times[i] > BENCH_SCALING_BUDGET)
+                    enabled[i] = false;
+            fflush(file);
+            printf("scaling: %zu shapes done\n", shape_count);
+            fflush(stdout);
+        }
+    }
+
+    fclose(file);
+    remove(BENCH_SCENE_FILE);
+}
@@ -0,0 +1,133 @@
+#include "bench.h"
+
+#include "geometry/vector2/vector2.h"
+#include "utils/vector/vector.h"
+
+#define BENCH_VECTOR_SIZE 1024
+
+typedef struct UtilsData
+{
+    Vector* vector;
+    int values[BENCH_VECTOR_SIZE];
+    Vector2 points[BENCH_VECTOR_SIZE];
+} UtilsData;
+
+static void _bench_vector_push_back(void* data, size_t iterations)
+{
+    UtilsData* utils = (UtilsData*)data;
+    Vector* vector = vector_create(0);
+    for (size_t i = 0; i < iterations; i++)
+        vector_push_back(vector, &utils->values[i % BENCH_VECTOR_SIZE]);
+    bench_sink = vector_size(vector);
+    vector_destroy(vector);
+}
+static void _bench_vector_get(void* data, size_t iterations)
+{
+    UtilsData* utils = (UtilsData*)data;
+    int sum = 0;
+    for (size_t i = 0; i < iterations; i++)
+        sum += *(int*)vector_get(utils->vector, i % BENCH_VECTOR_SIZE);
+    bench_sink = sum;
+}
+static void _bench_vector_index_of(void* data, size_t iterations)
+{
+    UtilsData* utils = (UtilsData*)data;
+    int sum = 0;
+    for (size_t i = 0; i < iterations; i++)
+        sum += vector_index_of(utils->vector, &utils->values[bench_random() % BENCH_VECTOR_SIZE]);
+    bench_sink = sum;
+}
+static void _bench_vector_insert_remove(void* data, size_t iterations)
+{
+    UtilsData* utils = (UtilsData*)data;
+    for (size_t i = 0; i < iterations; i++)
+    {
+        size_t idx = bench_random() % BENCH_VECTOR_SIZE;
+        vector_insert(utils->vector, idx, &utils->values[idx]);
+        vector_remove_at(utils->vector, idx);
+    }
+    bench_sink = vector_size(utils->vector);
+}
+static void _bench_vector2_add(void* data, size_t iterations)
+{
+    UtilsData* utils = (UtilsData*)data;
+    Vector2 sum = vector2_zero();
+    for (size_t i = 0; i < iterations; i++)
+        sum = vector2_add(sum, utils->points[i % BENCH_VECTOR_SIZE]);
+    bench_sink = sum.x + sum.y;
+}
+static void _bench_vector2_scale(void* data, size_t iterations)
+{
+    UtilsData* utils = (UtilsData*)data;
+    double sum = 0.0;
+    for (size_t i = 0; i < iterations; i++)
+        sum += vector2_scale(utils->points[i % BENCH_VECTOR_SIZE], 1.5).x;
+    bench_sink = sum;
+}
+static void _bench_vector2_dot(void* data, size_t iterations)
+{
+    UtilsData* utils = (UtilsData*)data;
+    double sum = 0.0;
+    for (size_t i = 0; i < iterations; i++)
+        sum += vector2_dot(utils->points[i % BENCH_VECTOR_SIZE], utils->points[(i + 1) % BENCH_VECTOR_SIZE]);
+    bench_sink = sum;
+}
+static void _bench_vector2_length(void* data, size_t iterations)
+{
+    UtilsData* utils = (UtilsData*)data;
+    double sum = 0.0;
+    for (size_t i = 0; i < iterations; i++)
+        sum += vector2_length(utils->points[i % BENCH_VECTOR_SIZE]);
+    bench_sink = sum;
+}
+static void _bench_vector2_normalize(void* data, size_t iterations)
+{
+    UtilsData* utils = (UtilsData*)data;
+    double sum = 0.0;
+    for (size_t i = 0; i < iterations; i++)
+        sum += vector2_normalize(utils->points[i % BENCH_VECTOR_SIZE]).x;
+    bench_sink = sum;
+}
+static void _bench_vector2_rotate(void* data, size_t iterations)
+{
+    UtilsData* utils = (UtilsData*)data;
+    double sum = 0.0;
+    for (size_t i = 0; i < iterations; i++)
+        sum += vector2_rotate(utils->points[i % BENCH_VECTOR_SIZE], 0.25).x;
+    bench_sink = sum;
+}
+static void _bench_vector2_rotate90(void* data, size_t iterations)
+{
+    UtilsData* utils = (UtilsData*)data;
+    double sum = 0.0;
+    for (size_t i = 0; i < iterations; i++)
+        sum += vector2_rotate90(utils->points[i % BENCH_VECTOR_SIZE]).x;
+    bench_sink = sum;
+}
+
+void bench_utils()
+{
+    bench_seed();
+    static UtilsData data;
+    data.vector = vector_create(BENCH_VECTOR_SIZE);
+    for (int i = 0; i < BENCH_VECTOR_SIZE; i++)
+    {
+        data.values[i] = i;
+        vector_push_back(data.vector, &data.values[i]);
+        data.points[i] = vector2_create(bench_random_double(-100.0, 100.0), bench_random_double(-100.0, 100.0));
+    }
+
+    bench_run("vector_push_back", _bench_vector_push_back, &data);
+    bench_run("vector_get", _bench_vector_get, &data);
+    bench_run("vector_index_of (1024 elements)", _bench_vector_index_of, &data);
+    bench_run("vector_insert + remove_at (1024 elements)", _bench_vector_insert_remove, &data);
+    bench_run("vector2_add", _bench_vector2_add, &data);
+    bench_run("vector2_scale", _bench_vector2_scale, &data);
+    bench_run("vector2_dot", _bench_vector2_dot, &data);
+    bench_run("vector2_length", _bench_vector2_length, &data);
+    bench_run("vector2_normalize", _bench_vector2_normalize, &data);
+    bench_run("vector2_rotate", _bench_vector2_rotate, &data);
+    bench_run("vector2_rotate90", _bench_vector2_rotate90, &data);
+
+    vector_destroy(data.vector);
+}
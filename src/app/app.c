@@ -9,12 +9,87 @@
 #include "../renderer/renderer.h"
 #include "../input/input.h"
 #include "../ui/ui.h"
+#include "../profiler/profiler.h"
+#include "../replay/replay.h"
+#include "../utils/trace/trace.h"
+
+#include <string.h>
 
 static AppData app_data;
 static Window* target;
 
+static double _app_seconds(Uint64 ticks)
+{
+    return (double)ticks / (double)app_data.frequency;
+}
+static void _app_wait_for_deadline(Uint64 deadline)
+{
+    Uint64 now = SDL_GetPerformanceCounter();
+    Uint64 spin_ticks = (Uint64)(APP_SPIN_THRESHOLD * app_data.frequency);
+    if (deadline > now + spin_ticks)
+    {
+        SDL_Delay((Uint32)((deadline - now - spin_ticks) * 1000 / app_data.frequency));
+        Uint64 slept = SDL_GetPerformanceCounter();
+        app_data.frame_stats.sleep_time = _app_seconds(slept - now);
+        now = slept;
+    }
+    Uint64 spin_start = now;
+    while (now < deadline)
+        now = SDL_GetPerformanceCounter();
+    app_data.frame_stats.spin_time = _app_seconds(now - spin_start);
+}
+static void _app_run_tasks()
+{
+    //the tasks take turns, so a long task doesn't starve the others, and every task gets at least one step per frame
+    size_t task_count = vector_size(app_data.tasks);
+    if (task_count == 0)
+        return;
+    TRACE_BEGIN("app tasks");
+    profiler_begin(PS_TASKS);
+    Uint64 start = SDL_GetPerformanceCounter();
+    size_t steps = 0;
+    while (vector_size(app_data.tasks) > 0 && (steps < task_count || SDL_GetPerformanceCounter() - start < app_data.task_budget))
+    {
+        if (app_data.next_task >= vector_size(app_data.tasks))
+            app_data.next_task = 0;
+        AppTask* task = (AppTask*)vector_get(app_data.tasks, app_data.next_task);
+        TRACE_BEGIN(task->name);
+        bool finished = task->step(task->data, &task->progress);
+        TRACE_END(task->name);
+        if (finished)
+        {
+            vector_remove_at(app_data.tasks, app_data.next_task);
+            free(task);
+            app_data.finished_tasks++;
+        }
+        else
+            app_data.next_task++;
+        steps++;
+    }
+    profiler_end(PS_TASKS);
+    profiler_set_counter(PC_PENDING_TASKS, vector_size(app_data.tasks));
+    TRACE_END("app tasks");
+    //the results of the tasks have to be shown, and the next update must not block while tasks are pending
+    app_data.redraw_requested = true;
+}
+static void _app_dispatch_event(SDL_Event* event)
+{
+    app_data.redraw_requested = true;
+    for (size_t i = 0; i < vector_size(app_data.windows); i++)
+    {
+        Window* window = (Window*)vector_get(app_data.windows, i);
+        if (event->window.windowID == SDL_GetWindowID(window->window))
+        {
+            _window_handle_event(window, event);
+            break;
+        }
+    }
+}
+
 void app_init()
 {
+    if (app_data.headless)
+        SDL_setenv("SDL_VIDEODRIVER", "dummy", 1);
     if (SDL_Init(SDL_INIT_EVERYTHING) < 0)
     {
         SDL_Log("unable to start SDL: %s", SDL_GetError());
@@ -26,49 +101,91 @@ void app_init()
         exit(1);
     }
     app_data.windows = vector_create(0);
-    app_data.target_frame_time = 1000 / 60;
-    app_data.last_frame_start = SDL_GetTicks();
-    app_data.frame_start = SDL_GetTicks();
+    app_data.frequency = SDL_GetPerformanceFrequency();
+    app_data.start_time = SDL_GetPerformanceCounter();
+    app_data.target_frame_time = app_data.frequency / 60;
+    app_data.last_frame_start = app_data.start_time;
+    app_data.frame_start = app_data.start_time;
+    app_data.next_frame_deadline = app_data.start_time;
     app_data.delta_time = 0.0;
+    app_data.vsync = false;
+    memset(&app_data.frame_stats, 0, sizeof(AppFrameStats));
+    app_data.idle_mode = false;
+    app_data.redraw_requested = true;
+    app_data.tasks = vector_create(0);
+    app_data.next_task = 0;
+    app_data.finished_tasks = 0;
+    app_data.task_budget = (Uint64)(APP_TASK_BUDGET * app_data.frequency);
     target = NULL;
     _font_init();
     _texture_init();
 }
 void app_update()
 {
-    app_data.frame_start = SDL_GetTicks();
-    app_data.delta_time = (double)(app_data.frame_start - app_data.last_frame_start) / 1000.0;
+    SDL_Event event;
+    bool event_received = false;
+    if (app_data.idle_mode && !app_data.redraw_requested && replay_get_mode() != RM_PLAYBACK)
+        event_received = SDL_WaitEventTimeout(&event, APP_IDLE_TIMEOUT) != 0;
+    app_data.redraw_requested = false;
+
+    TRACE_BEGIN("app_update");
+    app_data.frame_start = SDL_GetPerformanceCounter();
+    app_data.delta_time = _app_seconds(app_data.frame_start - app_data.last_frame_start);
     app_data.last_frame_start = app_data.frame_start;
 
     for (size_t i = 0; i < vector_size(app_data.windows); i++)
         _window_reset((Window*)vector_get(app_data.windows, i));
 
-    SDL_Event event;
+    profiler_begin(PS_INPUT);
+    if (event_received)
+        _app_dispatch_event(&event);
     while (SDL_PollEvent(&event) != 0)
     {
-        for (size_t i = 0; i < vector_size(app_data.windows); i++)
-        {
-            Window* window = (Window*)vector_get(app_data.windows, i);
-            if (event.window.windowID == SDL_GetWindowID(window->window))
-            {
-                _window_handle_event(window, &event);
-                break;
-            }
-        }
+        //in playback the recorded input replaces the real one
+        if (replay_get_mode() != RM_PLAYBACK)
+            _app_dispatch_event(&event);
     }
+    if (vector_size(app_data.windows) > 0)
+        app_data.redraw_requested = _replay_frame((Window*)vector_get(app_data.windows, 0), app_data.redraw_requested);
+    profiler_end(PS_INPUT);
     for (size_t i = 0; i < vector_size(app_data.windows); i++)
         _window_update((Window*)vector_get(app_data.windows, i));
+    _app_run_tasks();
+    TRACE_END("app_update");
 }
 void app_render()
 {
+    if (!app_needs_redraw())
+        return;
+
     for (size_t i = 0; i < vector_size(app_data.windows); i++)
     {
 		Window* window = (Window*)vector_get(app_data.windows, i);
         _window_render(window);
 	}
-    Uint32 frame_time = SDL_GetTicks() - app_data.frame_start;
-    if (frame_time < app_data.target_frame_time)
-        SDL_Delay(app_data.target_frame_time - frame_time);
+    _profiler_end_frame();
+    AppFrameStats* stats = &app_data.frame_stats;
+    Uint64 frame_end = SDL_GetPerformanceCounter();
+    stats->frame_count++;
+    stats->frame_time = _app_seconds(frame_end - app_data.frame_start);
+    stats->delta_time = app_data.delta_time;
+    stats->target_frame_time = _app_seconds(app_data.target_frame_time);
+    stats->budget_used = app_data.target_frame_time == 0 ? 0.0 : stats->frame_time / stats->target_frame_time;
+    stats->sleep_time = 0.0;
+    stats->spin_time = 0.0;
+    stats->average_frame_time = stats->frame_count == 1 ? stats->frame_time : stats->average_frame_time * 0.95 + stats->frame_time * 0.05;
+    if (app_data.target_frame_time != 0 && frame_end - app_data.frame_start > app_data.target_frame_time)
+        stats->missed_frames++;
+
+    if (app_data.vsync || app_data.target_frame_time == 0)
+        return;
+
+    //the deadlines are advanced by whole frames, so rounding errors do not add up, but a long stall does not cause a burst of frames
+    app_data.next_frame_deadline += app_data.target_frame_time;
+    if (app_data.next_frame_deadline < frame_end || app_data.next_frame_deadline > frame_end + app_data.target_frame_time)
+        app_data.next_frame_deadline = app_data.frame_start + app_data.target_frame_time;
+    if (app_data.next_frame_deadline > frame_end)
+        _app_wait_for_deadline(app_data.next_frame_deadline);
 }
 void app_request_close()
 {
@@ -77,6 +194,8 @@ void app_request_close()
 }
 void app_close()
 {
+    trace_stop();
+    replay_stop();
     _font_close();
     _texture_close();
     for (size_t i = 0; i < vector_size(app_data.windows); i++)
@@ -86,12 +205,43 @@ void app_close()
         free(window);
     }
     vector_destroy(app_data.windows);
+    for (size_t i = 0; i < vector_size(app_data.tasks); i++)
+        free(vector_get(app_data.tasks, i));
+    vector_destroy(app_data.tasks);
     TTF_Quit();
     SDL_Quit();
 }
+void app_set_headless(bool headless)
+{
+    app_data.headless = headless;
+}
+bool app_is_headless()
+{
+    return app_data.headless;
+}
 void app_set_target_fps(Uint32 fps)
 {
-    app_data.target_frame_time = 1000 / fps;
+    app_data.target_frame_time = fps == 0 ? 0 : app_data.frequency / fps;
+}
+void app_set_vsync(bool vsync)
+{
+    app_data.vsync = vsync;
+    for (size_t i = 0; i < vector_size(app_data.windows); i++)
+        SDL_RenderSetVSync(((Window*)vector_get(app_data.windows, i))->renderer, vsync ? 1 : 0);
+}
+
+void app_set_idle_mode(bool idle_mode)
+{
+    app_data.idle_mode = idle_mode;
+    app_data.redraw_requested = true;
+}
+void app_request_redraw()
+{
+    app_data.redraw_requested = true;
+}
+bool app_needs_redraw()
+{
+    return !app_data.idle_mode || app_data.redraw_requested;
 }
 
 void app_set_target(Window* window)
@@ -111,15 +261,68 @@ Vector* app_get_windows()
 }
 double app_get_time()
 {
-    return (double)SDL_GetTicks() / 1000.0;
+    return _app_seconds(SDL_GetPerformanceCounter() - app_data.start_time);
 }
 double app_get_delta_time()
 {
     return (double)app_data.delta_time;
 }
+AppFrameStats app_get_frame_stats()
+{
+    return app_data.frame_stats;
+}
+
+AppTask* app_add_task(const char* name, AppTaskStep step, void* data)
+{
+    AppTask* task = (AppTask*)malloc(sizeof(AppTask));
+    if (task == NULL)
+    {
+        printf("failed to allocate memory for the task\n");
+        exit(1);
+    }
+    *task = (AppTask){ name, step, data, 0.0 };
+    if (vector_size(app_data.tasks) == 0)
+        app_data.finished_tasks = 0;
+    vector_push_back(app_data.tasks, task);
+    profiler_set_counter(PC_PENDING_TASKS, vector_size(app_data.tasks));
+    app_data.redraw_requested = true;
+    return task;
+}
+void app_remove_task(AppTask* task)
+{
+    int index = task == NULL ? -1 : vector_index_of(app_data.tasks, task);
+    if (index < 0)
+        return;
+    vector_remove_at(app_data.tasks, index);
+    if (app_data.next_task > (size_t)index)
+        app_data.next_task--;
+    free(task);
+    app_data.finished_tasks++;
+    profiler_set_counter(PC_PENDING_TASKS, vector_size(app_data.tasks));
+}
+void app_set_task_budget(double budget)
+{
+    app_data.task_budget = budget <= 0.0 ? 0 : (Uint64)(budget * app_data.frequency);
+}
+size_t app_get_pending_task_count()
+{
+    return vector_size(app_data.tasks);
+}
+double app_get_task_progress()
+{
+    size_t task_count = vector_size(app_data.tasks);
+    if (task_count == 0)
+        return 1.0;
+    double progress = (double)app_data.finished_tasks;
+    for (size_t i = 0; i < task_count; i++)
+        progress += ((AppTask*)vector_get(app_data.tasks, i))->progress;
+    return progress / (app_data.finished_tasks + task_count);
+}
 
 void _app_add_window(Window* window)
 {
     vector_push_back(app_data.windows, (void*)window);
+    if (app_data.vsync)
+        SDL_RenderSetVSync(window->renderer, 1);
     app_set_target(window);
 }
\ No newline at end of file
@@ -9,16 +9,71 @@
 #include "../window/window.h"
 #include "../utils/vector/vector.h"
 
+#include <stdbool.h>
+
+#define APP_IDLE_TIMEOUT 500
+#define APP_SPIN_THRESHOLD 0.002
+#define APP_TASK_BUDGET 0.004
+
+/**
+ * @brief Frame timing statistics of the last rendered frame (times are in seconds)
+ */
+typedef struct AppFrameStats
+{
+    Uint64 frame_count;
+    Uint64 missed_frames;
+    double frame_time;
+    double delta_time;
+    double target_frame_time;
+    double budget_used;
+    double sleep_time;
+    double spin_time;
+    double average_frame_time;
+} AppFrameStats;
+
+/**
+ * @brief Does a small piece of an incremental task (it is called again and again while the time budget of the frame lasts, so a call should take well under a millisecond)
+ * 
+ * @param data The data given to app_add_task
+ * @param progress Receives the progress of the task (between 0 and 1)
+ * @return true If the task is finished (it is removed after this call)
+ * @return false If the task has more work to do
+ */
+typedef bool (*AppTaskStep)(void* data, double* progress);
+
+/**
+ * @brief An incremental task, that is spread across frames by the scheduler of the application
+ */
+typedef struct AppTask
+{
+    const char* name;
+    AppTaskStep step;
+    void* data;
+    double progress;
+} AppTask;
+
 /**
  * @brief Contains the application data, like windows and target fps. There is only one instance of this struct, and should not be modified directly
  */
 typedef struct AppData
 {
     Vector* windows;
-    Uint32 target_frame_time;
-    Uint32 last_frame_start;
-    Uint32 frame_start;
+    Uint64 frequency;
+    Uint64 start_time;
+    Uint64 target_frame_time;
+    Uint64 last_frame_start;
+    Uint64 frame_start;
+    Uint64 next_frame_deadline;
     double delta_time;
+    bool idle_mode;
+    bool redraw_requested;
+    bool vsync;
+    bool headless;
+    AppFrameStats frame_stats;
+    Vector* tasks;
+    size_t next_task;
+    size_t finished_tasks;
+    Uint64 task_budget;
 } AppData;
 
 /**
@@ -26,11 +81,25 @@ typedef struct AppData
  */
 void app_init();
 /**
- * @brief Updates the windows and handles events
+ * @brief Sets the headless mode, it has to be called before app_init. Headless windows are hidden and rendered in software with the dummy video driver (used to replay recorded input)
+ * 
+ * @param headless Whether the application should run without a visible window
+ */
+void app_set_headless(bool headless);
+/**
+ * @brief Checks if the application runs without a visible window
+ * 
+ * @return true If the application is headless
+ * @return false If the windows are visible
+ */
+bool app_is_headless();
+/**
+ * @brief Updates the windows and handles events (in idle mode it blocks until an event arrives if no redraw was requested),
+ * then runs the pending tasks for at most the task budget
  */
 void app_update();
 /**
- * @brief Renders the windows and waits for the target frame time
+ * @brief Renders the windows and waits for the target frame time by sleeping and spinning for the last few milliseconds, or by presenting with vsync if it is enabled (in idle mode it does nothing if no redraw was requested)
  */
 void app_render();
 /**
@@ -44,9 +113,32 @@ void app_close();
 /**
  * @brief Sets the target fps
  * 
- * @param fps The target fps
+ * @param fps The target fps (0 means unlimited)
  */
 void app_set_target_fps(Uint32 fps);
+/**
+ * @brief Enables or disables vsync for all windows (with vsync the presentation paces the frames instead of the scheduler)
+ * 
+ * @param vsync Whether vsync should be enabled
+ */
+void app_set_vsync(bool vsync);
+/**
+ * @brief Sets the idle mode. In idle mode frames are only rendered after an event or app_request_redraw, otherwise the application sleeps until the next event
+ * 
+ * @param idle_mode Whether the idle mode should be enabled
+ */
+void app_set_idle_mode(bool idle_mode);
+/**
+ * @brief Requests a redraw of the current frame and keeps the next update from blocking (call it every frame while something is animated, so the frame rate does not drop in idle mode)
+ */
+void app_request_redraw();
+/**
+ * @brief Checks whether the current frame has to be redrawn (always true if the idle mode is disabled)
+ * 
+ * @return true If the frame has to be redrawn
+ * @return false If nothing changed since the last rendered frame
+ */
+bool app_needs_redraw();
 
 /**
  * @brief Sets the target window for rendering, input handling and UI. A target should be set before doing any of these things
@@ -78,6 +170,47 @@ double app_get_time();
  * @return double The delta time
  */
 double app_get_delta_time();
+/**
+ * @brief Returns the timing statistics of the last rendered frame (how much of the frame budget was used, how long the scheduler slept and spun, etc.)
+ * 
+ * @return AppFrameStats The frame statistics
+ */
+AppFrameStats app_get_frame_stats();
+
+/**
+ * @brief Adds an incremental task, its steps are run at the end of every app_update while the task budget of the frame lasts
+ * (the tasks take turns, and every pending task gets at least one step per frame)
+ * 
+ * @param name The name of the task (shown in the traces, it is not copied)
+ * @param step The function that does a piece of the task
+ * @param data The data passed to the step function
+ * @return AppTask* The task (valid until it is finished or removed)
+ */
+AppTask* app_add_task(const char* name, AppTaskStep step, void* data);
+/**
+ * @brief Removes a task before it is finished (it should not be called from a step function)
+ * 
+ * @param task The task to remove (NULL is ignored)
+ */
+void app_remove_task(AppTask* task);
+/**
+ * @brief Sets how much of every frame can be spent on the tasks
+ * 
+ * @param budget The time budget in seconds (APP_TASK_BUDGET by default)
+ */
+void app_set_task_budget(double budget);
+/**
+ * @brief Returns the number of the tasks that are not finished yet
+ * 
+ * @return size_t The number of pending tasks
+ */
+size_t app_get_pending_task_count();
+/**
+ * @brief Returns the progress of the tasks added since the queue was last empty (the finished and removed tasks count as done, so it never jumps back when a task finishes)
+ * 
+ * @return double The progress between 0 and 1 (1 if there are no pending tasks)
+ */
+double app_get_task_progress();
 
 /**
  * @brief Adds a window to the application (this is an internal function, should not be called directly)
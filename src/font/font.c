@@ -1,8 +1,97 @@
 #include "font.h"
 #include "../utils/vector/vector.h"
 
+#include <stdio.h>
+#include <string.h>
+
 static Vector* fonts;
 
+static Uint32 _font_hash(Uint32 a, Uint32 b)
+{
+	Uint32 hash = a * 2654435761u ^ b * 2246822519u;
+	return hash ^ (hash >> 15);
+}
+static void* _font_calloc(size_t count, size_t size)
+{
+	void* data = calloc(count, size);
+	if (data == NULL)
+	{
+		printf("couldn't allocate memory for the glyph cache\n");
+		exit(1);
+	}
+	return data;
+}
+static FontGlyph* _font_find_glyph_slot(FontGlyph* glyphs, size_t capacity, Uint32 codepoint)
+{
+	size_t index = _font_hash(codepoint, 0) & (capacity - 1);
+	while (glyphs[index].codepoint != 0 && glyphs[index].codepoint != codepoint)
+		index = (index + 1) & (capacity - 1);
+	return &glyphs[index];
+}
+static FontKerning* _font_find_kerning_slot(FontKerning* kernings, size_t capacity, Uint32 left, Uint32 right)
+{
+	size_t index = _font_hash(left, right) & (capacity - 1);
+	while (kernings[index].left != 0 && (kernings[index].left != left || kernings[index].right != right))
+		index = (index + 1) & (capacity - 1);
+	return &kernings[index];
+}
+static void _font_grow_glyphs(Font* font)
+{
+	size_t capacity = font->glyph_capacity * 2;
+	FontGlyph* glyphs = _font_calloc(capacity, sizeof(FontGlyph));
+	for (size_t i = 0; i < font->glyph_capacity; i++)
+		if (font->glyphs[i].codepoint != 0)
+			*_font_find_glyph_slot(glyphs, capacity, font->glyphs[i].codepoint) = font->glyphs[i];
+	free(font->glyphs);
+	font->glyphs = glyphs;
+	font->glyph_capacity = capacity;
+}
+static void _font_grow_kernings(Font* font)
+{
+	size_t capacity = font->kerning_capacity * 2;
+	FontKerning* kernings = _font_calloc(capacity, sizeof(FontKerning));
+	for (size_t i = 0; i < font->kerning_capacity; i++)
+	{
+		FontKerning* kerning = &font->kernings[i];
+		if (kerning->left != 0)
+			*_font_find_kerning_slot(kernings, capacity, kerning->left, kerning->right) = *kerning;
+	}
+	free(font->kernings);
+	font->kernings = kernings;
+	font->kerning_capacity = capacity;
+}
+static void _font_clear_atlas(Font* font)
+{
+	for (size_t i = 0; i < vector_size(font->atlas_pages); i++)
+		SDL_DestroyTexture(vector_get(font->atlas_pages, i));
+	vector_clear(font->atlas_pages);
+	for (size_t i = 0; i < font->glyph_capacity; i++)
+		font->glyphs[i].rasterized = false;
+	font->atlas_cursor = (SDL_Point){ FONT_ATLAS_PADDING, FONT_ATLAS_PADDING };
+	font->atlas_row_height = 0;
+}
+static SDL_Texture* _font_add_atlas_page(Font* font, SDL_Renderer* renderer)
+{
+	SDL_Texture* page = SDL_CreateTexture(renderer,
+		SDL_PIXELFORMAT_ARGB8888,
+		SDL_TEXTUREACCESS_STATIC,
+		FONT_ATLAS_SIZE, FONT_ATLAS_SIZE);
+	if (page == NULL)
+	{
+		printf("couldn't create glyph atlas page: %s\n", SDL_GetError());
+		exit(1);
+	}
+	Uint32* pixels = _font_calloc(FONT_ATLAS_SIZE * FONT_ATLAS_SIZE, sizeof(Uint32));
+	SDL_UpdateTexture(page, NULL, pixels, FONT_ATLAS_SIZE * sizeof(Uint32));
+	free(pixels);
+	SDL_SetTextureBlendMode(page, SDL_BLENDMODE_BLEND);
+
+	vector_push_back(font->atlas_pages, page);
+	font->atlas_cursor = (SDL_Point){ FONT_ATLAS_PADDING, FONT_ATLAS_PADDING };
+	font->atlas_row_height = 0;
+	return page;
+}
+
 Font* font_load(const char* path, int size)
 {
 	Font* font = (Font*)malloc(sizeof(Font));
@@ -18,9 +107,189 @@ Font* font_load(const char* path, int size)
 		exit(1);
 	}
 	font->size = size;
+	font->height = TTF_FontHeight(font->font);
+	font->kerning_enabled = TTF_GetFontKerning(font->font) != 0;
+
+	font->glyph_count = 0;
+	font->glyph_capacity = 128;
+	font->glyphs = _font_calloc(font->glyph_capacity, sizeof(FontGlyph));
+	font->kerning_count = 0;
+	font->kerning_capacity = 256;
+	font->kernings = _font_calloc(font->kerning_capacity, sizeof(FontKerning));
+
+	font->atlas_renderer = NULL;
+	font->atlas_pages = vector_create(0);
+	font->atlas_cursor = (SDL_Point){ FONT_ATLAS_PADDING, FONT_ATLAS_PADDING };
+	font->atlas_row_height = 0;
+
 	vector_push_back(fonts, font);
 	return font;
 }
+SDL_Point font_query_text_size(Font* font, const char* text)
+{
+	SDL_Point size = { 0, font->height };
+	int pen = 0, min_x = 0, max_x = 0;
+	Uint32 previous = 0;
+	Uint32 codepoint;
+	while ((codepoint = _font_decode_utf8(&text)) != 0)
+	{
+		if (previous != 0)
+			pen += _font_get_kerning(font, previous, codepoint);
+		FontGlyph* glyph = _font_get_glyph(font, codepoint);
+		if (pen + glyph->offset_x < min_x)
+			min_x = pen + glyph->offset_x;
+		if (pen + glyph->offset_x + glyph->width > max_x)
+			max_x = pen + glyph->offset_x + glyph->width;
+		pen += glyph->advance;
+		previous = codepoint;
+	}
+	size.x = max_x - min_x;
+	return size;
+}
+
+Uint32 _font_decode_utf8(const char** text)
+{
+	const unsigned char* s = (const unsigned char*)*text;
+	if (s[0] == 0)
+		return 0;
+
+	int length;
+	Uint32 codepoint;
+	if (s[0] < 0x80)
+	{
+		length = 1;
+		codepoint = s[0];
+	}
+	else if ((s[0] & 0xE0) == 0xC0)
+	{
+		length = 2;
+		codepoint = s[0] & 0x1F;
+	}
+	else if ((s[0] & 0xF0) == 0xE0)
+	{
+		length = 3;
+		codepoint = s[0] & 0x0F;
+	}
+	else if ((s[0] & 0xF8) == 0xF0)
+	{
+		length = 4;
+		codepoint = s[0] & 0x07;
+	}
+	else
+	{
+		*text += 1;
+		return 0xFFFD;
+	}
+
+	for (int i = 1; i < length; i++)
+	{
+		if ((s[i] & 0xC0) != 0x80)
+		{
+			*text += i;
+			return 0xFFFD;
+		}
+		codepoint = (codepoint << 6) | (s[i] & 0x3F);
+	}
+	*text += length;
+	return codepoint;
+}
+FontGlyph* _font_get_glyph(Font* font, Uint32 codepoint)
+{
+	FontGlyph* glyph = _font_find_glyph_slot(font->glyphs, font->glyph_capacity, codepoint);
+	if (glyph->codepoint == codepoint)
+		return glyph;
+
+	if ((font->glyph_count + 1) * 10 > font->glyph_capacity * 7)
+	{
+		_font_grow_glyphs(font);
+		glyph = _font_find_glyph_slot(font->glyphs, font->glyph_capacity, codepoint);
+	}
+
+	int min_x = 0, max_x = 0, min_y = 0, max_y = 0, advance = 0;
+	TTF_GlyphMetrics32(font->font, codepoint, &min_x, &max_x, &min_y, &max_y, &advance);
+	glyph->codepoint = codepoint;
+	glyph->offset_x = min_x < 0 ? min_x : 0;
+	glyph->advance = advance;
+	glyph->width = (max_x > advance ? max_x : advance) - glyph->offset_x;
+	glyph->rasterized = false;
+	glyph->page = -1;
+	glyph->atlas_rect = (SDL_Rect){ 0, 0, 0, 0 };
+	font->glyph_count++;
+	return glyph;
+}
+int _font_get_kerning(Font* font, Uint32 left, Uint32 right)
+{
+	if (!font->kerning_enabled)
+		return 0;
+
+	FontKerning* kerning = _font_find_kerning_slot(font->kernings, font->kerning_capacity, left, right);
+	if (kerning->left == left && kerning->right == right)
+		return kerning->kerning;
+
+	if ((font->kerning_count + 1) * 10 > font->kerning_capacity * 7)
+	{
+		_font_grow_kernings(font);
+		kerning = _font_find_kerning_slot(font->kernings, font->kerning_capacity, left, right);
+	}
+	kerning->left = left;
+	kerning->right = right;
+	kerning->kerning = TTF_GetFontKerningSizeGlyphs32(font->font, left, right);
+	font->kerning_count++;
+	return kerning->kerning;
+}
+SDL_Texture* _font_rasterize_glyph(Font* font, SDL_Renderer* renderer, FontGlyph* glyph)
+{
+	if (font->atlas_renderer != renderer)
+	{
+		_font_clear_atlas(font);
+		font->atlas_renderer = renderer;
+	}
+	if (glyph->rasterized)
+		return glyph->page < 0 ? NULL : vector_get(font->atlas_pages, glyph->page);
+
+	glyph->rasterized = true;
+	glyph->page = -1;
+
+	SDL_Color white = { 255, 255, 255, 255 };
+	SDL_Surface* surface = TTF_RenderGlyph32_Blended(font->font, glyph->codepoint, white);
+	if (surface == NULL)
+		return NULL;
+	if (surface->format->format != SDL_PIXELFORMAT_ARGB8888)
+	{
+		SDL_Surface* converted = SDL_ConvertSurfaceFormat(surface, SDL_PIXELFORMAT_ARGB8888, 0);
+		SDL_FreeSurface(surface);
+		if (converted == NULL)
+			return NULL;
+		surface = converted;
+	}
+	if (surface->w + 2 * FONT_ATLAS_PADDING > FONT_ATLAS_SIZE || surface->h + 2 * FONT_ATLAS_PADDING > FONT_ATLAS_SIZE)
+	{
+		SDL_FreeSurface(surface);
+		return NULL;
+	}
+
+	if (vector_size(font->atlas_pages) == 0)
+		_font_add_atlas_page(font, renderer);
+	if (font->atlas_cursor.x + surface->w + FONT_ATLAS_PADDING > FONT_ATLAS_SIZE)
+	{
+		font->atlas_cursor.x = FONT_ATLAS_PADDING;
+		font->atlas_cursor.y += font->atlas_row_height + FONT_ATLAS_PADDING;
+		font->atlas_row_height = 0;
+	}
+	if (font->atlas_cursor.y + surface->h + FONT_ATLAS_PADDING > FONT_ATLAS_SIZE)
+		_font_add_atlas_page(font, renderer);
+
+	SDL_Texture* page = vector_get(font->atlas_pages, vector_size(font->atlas_pages) - 1);
+	glyph->page = (int)vector_size(font->atlas_pages) - 1;
+	glyph->atlas_rect = (SDL_Rect){ font->atlas_cursor.x, font->atlas_cursor.y, surface->w, surface->h };
+	SDL_UpdateTexture(page, &glyph->atlas_rect, surface->pixels, surface->pitch);
+
+	font->atlas_cursor.x += surface->w + FONT_ATLAS_PADDING;
+	if (surface->h > font->atlas_row_height)
+		font->atlas_row_height = surface->h;
+	SDL_FreeSurface(surface);
+	return page;
+}
 
 void _font_init()
 {
@@ -31,8 +300,12 @@ void _font_close()
 	for (size_t i = 0; i < vector_size(fonts); i++)
 	{
 		Font* font = vector_get(fonts, i);
+		_font_clear_atlas(font);
+		vector_destroy(font->atlas_pages);
+		free(font->glyphs);
+		free(font->kernings);
 		TTF_CloseFont(font->font);
 		free(font);
 	}
 	vector_destroy(fonts);
-}
\ No newline at end of file
+}
@@ -6,23 +6,111 @@
     #include <SDL2/SDL_ttf.h>
 #endif
 
+#include <stdbool.h>
+
+#include "../utils/vector/vector.h"
+
+#define FONT_ATLAS_SIZE 512
+#define FONT_ATLAS_PADDING 1
+
+/**
+ * @brief A cached glyph of a font (metrics and its place in the glyph atlas)
+ */
+typedef struct FontGlyph
+{
+	Uint32 codepoint;
+	int offset_x;
+	int advance;
+	int width;
+	bool rasterized;
+	int page;
+	SDL_Rect atlas_rect;
+} FontGlyph;
+
 /**
- * @brief Holds a TTF_Font and its size
+ * @brief A cached kerning value between two glyphs
+ */
+typedef struct FontKerning
+{
+	Uint32 left;
+	Uint32 right;
+	int kerning;
+} FontKerning;
+
+/**
+ * @brief Holds a TTF_Font and its size, as well as the glyph cache (glyph metrics, kerning and the glyph atlas pages)
  */
 typedef struct Font
 {
 	TTF_Font* font;
 	int size;
+	int height;
+	bool kerning_enabled;
+
+	FontGlyph* glyphs;
+	size_t glyph_count;
+	size_t glyph_capacity;
+
+	FontKerning* kernings;
+	size_t kerning_count;
+	size_t kerning_capacity;
+
+	SDL_Renderer* atlas_renderer;
+	Vector* atlas_pages;
+	SDL_Point atlas_cursor;
+	int atlas_row_height;
 } Font;
 
 /**
  * @brief Loads a font from a file (freed automatically when the program closes)
- * 
+ *
  * @param path The path to the font file
  * @param size The size of the font
  * @return Font* The font
  */
 Font* font_load(const char* path, int size);
+/**
+ * @brief Returns the size of a text rendered with the font (uses the glyph cache, so TTF is only queried for new glyphs)
+ *
+ * @param font The font to measure the text with
+ * @param text The text to measure (UTF-8)
+ * @return SDL_Point The size of the text
+ */
+SDL_Point font_query_text_size(Font* font, const char* text);
+
+/**
+ * @brief Decodes the next codepoint of a UTF-8 string and advances the string pointer (should not be called manually)
+ *
+ * @param text The pointer to the string to decode
+ * @return Uint32 The decoded codepoint (0 at the end of the string)
+ */
+Uint32 _font_decode_utf8(const char** text);
+/**
+ * @brief Returns the cached metrics of a glyph, loading them on the first use (should not be called manually)
+ *
+ * @param font The font to get the glyph from
+ * @param codepoint The codepoint of the glyph
+ * @return FontGlyph* The glyph (only valid until the next glyph is added)
+ */
+FontGlyph* _font_get_glyph(Font* font, Uint32 codepoint);
+/**
+ * @brief Returns the cached kerning between two glyphs (should not be called manually)
+ *
+ * @param font The font to get the kerning from
+ * @param left The codepoint of the left glyph
+ * @param right The codepoint of the right glyph
+ * @return int The kerning in pixels
+ */
+int _font_get_kerning(Font* font, Uint32 left, Uint32 right);
+/**
+ * @brief Makes sure that the glyph is rasterized into the glyph atlas of the renderer (should not be called manually)
+ *
+ * @param font The font of the glyph
+ * @param renderer The renderer that owns the atlas pages
+ * @param glyph The glyph to rasterize
+ * @return SDL_Texture* The atlas page that contains the glyph (NULL if the glyph could not be rasterized)
+ */
+SDL_Texture* _font_rasterize_glyph(Font* font, SDL_Renderer* renderer, FontGlyph* glyph);
 
 /**
  * @brief Creates the font vector that contains all the loaded fonts (should not be called directly, it is needed for the _font_close function)
@@ -0,0 +1,39 @@
+#include "clip.h"
+
+#include <math.h>
+
+static bool _clip_edge(double p, double q, double* t0, double* t1)
+{
+    //p is the speed towards the outside of the edge, q is the distance from it
+    if (p == 0.0)
+        return q >= 0.0;
+    double t = q / p;
+    if (p < 0.0)
+        *t0 = fmax(*t0, t);
+    else
+        *t1 = fmin(*t1, t);
+    return *t0 <= *t1;
+}
+
+bool clip_line_to_rect(Vector2 p1, Vector2 p2, Vector2 min, Vector2 max, Vector2* a, Vector2* b)
+{
+    double dx = p2.x - p1.x;
+    double dy = p2.y - p1.y;
+    if ((dx == 0.0 && dy == 0.0) || isnan(dx) || isnan(dy))
+        return false;
+    double t0 = -INFINITY, t1 = INFINITY;
+    if (!_clip_edge(-dx, p1.x - min.x, &t0, &t1) || !_clip_edge(dx, max.x - p1.x, &t0, &t1) ||
+        !_clip_edge(-dy, p1.y - min.y, &t0, &t1) || !_clip_edge(dy, max.y - p1.y, &t0, &t1))
+        return false;
+    *a = vector2_create(p1.x + dx * t0, p1.y + dy * t0);
+    *b = vector2_create(p1.x + dx * t1, p1.y + dy * t1);
+    return true;
+}
+double segment_distance(Vector2 point, Vector2 a, Vector2 b)
+{
+    Vector2 ab = vector2_subtract(b, a);
+    double length_squared = vector2_dot(ab, ab);
+    double t = length_squared > 0.0 ? vector2_dot(vector2_subtract(point, a), ab) / length_squared : 0.0;
+    t = fmin(fmax(t, 0.0), 1.0);
+    return vector2_distance(point, vector2_add(a, vector2_scale(ab, t)));
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <stdbool.h>
+
+#include "../vector2/vector2.h"
+
+/**
+ * @brief Clips the infinite line through two points to a rectangle (Liang–Barsky, a few multiply-adds instead of solving against every edge)
+ * 
+ * @param p1 A point of the line
+ * @param p2 Another point of the line (the line is empty if it equals p1)
+ * @param min The top left corner of the rectangle
+ * @param max The bottom right corner of the rectangle
+ * @param a The first end of the visible segment (only set if the line crosses the rectangle)
+ * @param b The second end of the visible segment (only set if the line crosses the rectangle)
+ * @return true If the line crosses the rectangle
+ * @return false If the line misses the rectangle
+ */
+bool clip_line_to_rect(Vector2 p1, Vector2 p2, Vector2 min, Vector2 max, Vector2* a, Vector2* b);
+/**
+ * @brief Calculates the distance of a point from a segment
+ * 
+ * @param point The point
+ * @param a The first end of the segment
+ * @param b The second end of the segment
+ * @return double The distance from the closest point of the segment
+ */
+double segment_distance(Vector2 point, Vector2 a, Vector2 b);
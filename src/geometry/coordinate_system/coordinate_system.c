@@ -1,16 +1,111 @@
 #include "coordinate_system.h"
 
 #include "../../renderer/renderer.h"
+#include "../../raster/png_writer.h"
+#include "../../svg/svg_writer.h"
 #include "../intersection/intersection.h"
 #include "../../utils/math/math.h"
+#include "../../profiler/profiler.h"
+#include "../../utils/trace/trace.h"
 
-static double _x_screen_to_coordinate(CoordinateSystem* cs, double x);
-static double _y_screen_to_coordinate(CoordinateSystem* cs, double y);
-static double _x_coordinate_to_screen(CoordinateSystem* cs, double x);
-static double _y_coordinate_to_screen(CoordinateSystem* cs, double y);
+#include <errno.h>
+#include <string.h>
+
+#define EXPORT_BAND_PIXELS (1 << 22)
+#define INTERSECTION_MARKER_RADIUS 6
+#define INTERSECTION_MARKER_ID "intersection"
+#define INTERSECTION_BLOCK_PAIRS 4096
+#define INTERSECTION_PARALLEL_PAIRS (1 << 16)
+
+static void _coordinate_system_update_view(CoordinateSystem* cs);
+static void _coordinate_system_number_shapes(CoordinateSystem* cs);
+static int _save_index(Shape* shape);
+static void _coordinate_system_save_shape(FILE* file, Shape* shape);
+static Vector2* _coordinate_system_reserve_screen_points(CoordinateSystem* cs, size_t count);
+static Vector2* _coordinate_system_project_points(CoordinateSystem* cs);
+static Vector2* _coordinate_system_project_intersections(CoordinateSystem* cs);
+static ThreadPool* _coordinate_system_intersection_pool(CoordinateSystem* cs);
+static void _coordinate_system_prepare_intersections(CoordinateSystem* cs, ThreadPool* pool);
+static void _coordinate_system_run_intersections(CoordinateSystem* cs, size_t end_block);
+static void _intersection_block_run(void* data, size_t index, int worker);
+static void _intersection_worker_push(IntersectionWorker* worker, Vector2 point);
+
+static void _coordinate_system_draw_grid(CoordinateSystem* cs);
+
+typedef struct _HoverQuery
+{
+    CoordinateSystem* cs;
+    Vector2 point;
+} _HoverQuery;
+static bool _hover_filter(Shape* shape, void* data);
+static void _select_visit(Shape* shape, void* data);
+
+static void _shape_set_insert(Vector* set, Shape* shape, int* slot);
+static void _shape_set_erase(Vector* set, int* slot, bool dragged);
+static int _compare_shapes(const void* a, const void* b);
+
+static void _shape_set_insert(Vector* set, Shape* shape, int* slot)
+{
+    *slot = (int)vector_size(set);
+    vector_push_back(set, shape);
+}
+static void _shape_set_erase(Vector* set, int* slot, bool dragged)
+{
+    //the last shape of the set takes the place of the erased one
+    Shape* last = vector_pop_back(set);
+    if (*slot < (int)vector_size(set))
+    {
+        vector_set(set, *slot, last);
+        if (dragged)
+            last->dragged_slot = *slot;
+        else
+            last->selected_slot = *slot;
+    }
+    *slot = -1;
+}
+
+void coordinate_system_drag(CoordinateSystem* cs, Vector2 motion)
+{
+    if (cs == NULL || vector_size(cs->dragged_shapes) == 0 || (motion.x == 0 && motion.y == 0))
+        return;
+    profiler_begin(PS_SHAPE_UPDATE);
+    //the view only scales and translates, so the mouse motion is the same world-space delta for every point
+    Vector2 delta = vector2_create(motion.x / cs->zoom, -motion.y / cs->zoom);
+
+    //a point shared by several dragged shapes (e.g. the common point of two lines) is only moved once
+    vector_clear(cs->drag_points);
+    for (size_t i = 0; i < vector_size(cs->dragged_shapes); i++)
+    {
+        Shape* points[SHAPE_DRAG_MAX_POINTS];
+        int point_count = shape_get_drag_points(vector_get(cs->dragged_shapes, i), points);
+        for (int j = 0; j < point_count; j++)
+            vector_push_back(cs->drag_points, points[j]);
+    }
+    qsort(cs->drag_points->data, vector_size(cs->drag_points), sizeof(void*), _compare_shapes);
+    size_t point_count = 0;
+    for (size_t i = 0; i < vector_size(cs->drag_points); i++)
+        if (point_count == 0 || cs->drag_points->data[point_count - 1] != cs->drag_points->data[i])
+            cs->drag_points->data[point_count++] = cs->drag_points->data[i];
+
+    for (size_t i = 0; i < point_count; i++)
+    {
+        Point* point = (Point*)cs->drag_points->data[i];
+        point->coordinates.x += delta.x;
+        point->coordinates.y += delta.y;
+    }
+    //the shapes calculated from the points are only marked, the index recalculates them once when it is queried
+    spatial_index_move_points(cs->index, (Shape**)cs->drag_points->data, (int)point_count);
+    profiler_end(PS_SHAPE_UPDATE);
+}
+static int _compare_shapes(const void* a, const void* b)
+{
+    uintptr_t shape1 = (uintptr_t)*(Shape* const*)a;
+    uintptr_t shape2 = (uintptr_t)*(Shape* const*)b;
+    return (shape1 > shape2) - (shape1 < shape2);
+}
 
 static Point* _intersection_point_create(CoordinateSystem* cs, Vector2 coordinates);
-static void _intersection_point_draw(CoordinateSystem* cs, Point* self);
+static void _intersection_marker_draw(Vector2 position);
 
 CoordinateSystem* coordinate_system_create(Vector2 position, Vector2 size, Vector2 origin)
 {
@@ -21,6 +116,25 @@ CoordinateSystem* coordinate_system_create(Vector2 position, Vector2 size, Vecto
     cs->zoom = INITIAL_ZOOM;
     cs->shapes = vector_create(0);
     cs->intersection_points = vector_create(0);
+    cs->index = spatial_index_create();
+    cs->selected_shapes = vector_create(0);
+    cs->dragged_shapes = vector_create(0);
+    cs->drag_points = vector_create(0);
+    cs->hover_cache.valid = false;
+    cs->screen_points = NULL;
+    cs->screen_point_capacity = 0;
+    cs->intersection_geometry = NULL;
+    cs->intersection_geometry_capacity = 0;
+    cs->intersection_blocks = NULL;
+    cs->intersection_block_capacity = 0;
+    cs->intersection_workers = NULL;
+    cs->intersection_worker_count = 0;
+    cs->intersection_pool = NULL;
+    cs->intersection_version = cs->index->version;
+    cs->intersection_block_count = 0;
+    cs->intersection_next_block = 0;
+    cs->intersection_rebuilding = false;
+    _coordinate_system_update_view(cs);
     return cs;
 }
 void coordinate_system_clear(CoordinateSystem* cs)
@@ -50,6 +164,21 @@ void coordinate_system_destroy(CoordinateSystem* cs)
         coordinate_system_destroy_shape(cs, shape);
     }
     vector_destroy(cs->shapes);
+    vector_destroy(cs->selected_shapes);
+    vector_destroy(cs->dragged_shapes);
+    vector_destroy(cs->drag_points);
+    free(cs->screen_points);
+    free(cs->intersection_geometry);
+    free(cs->intersection_blocks);
+    for (int i = 0; i < cs->intersection_worker_count; i++)
+    {
+        line_circle_batch_destroy(cs->intersection_workers[i].line_circle_batch);
+        circle_circle_batch_destroy(cs->intersection_workers[i].circle_circle_batch);
+        free(cs->intersection_workers[i].points);
+    }
+    free(cs->intersection_workers);
+    thread_pool_destroy(cs->intersection_pool);
+    spatial_index_destroy(cs->index);
     free(cs);
 }
 
@@ -58,64 +187,86 @@ void coordinate_system_save(CoordinateSystem* cs, const char* path)
     FILE* file = fopen(path, "w");
     if (file == NULL)
         return;
+    TRACE_BEGIN("coordinate_system_save");
     
+    _coordinate_system_number_shapes(cs);
     for (size_t i = 0; i < vector_size(cs->shapes); i++)
+        _coordinate_system_save_shape(file, vector_get(cs->shapes, i));
+    fclose(file);
+    TRACE_END("coordinate_system_save");
+}
+CoordinateSystemSaver* coordinate_system_save_begin(CoordinateSystem* cs, const char* path)
+{
+    CoordinateSystemSaver* saver = (CoordinateSystemSaver*)malloc(sizeof(CoordinateSystemSaver));
+    char* saver_path = (char*)malloc(strlen(path) + 1);
+    char* temporary_path = (char*)malloc(strlen(path) + 5);
+    if (saver == NULL || saver_path == NULL || temporary_path == NULL)
     {
-        Shape* shape = vector_get(cs->shapes, i);
-        switch (shape->type)
-        {
-        case ST_POINT:
-        {
-            fprintf(file, "point %lf %lf\n", ((Point*)shape)->coordinates.x, ((Point*)shape)->coordinates.y);
-            break;
-        }
-        case ST_LINE:
-        {
-            int idx1 = vector_index_of(cs->shapes, ((Line*)shape)->p1);
-            int idx2 = vector_index_of(cs->shapes, ((Line*)shape)->p2);
-            fprintf(file, "line %d %d\n", idx1, idx2);
-            break;
-        }
-        case ST_CIRCLE:
-        {
-            int idx1 = vector_index_of(cs->shapes, ((Circle*)shape)->center);
-            int idx2 = vector_index_of(cs->shapes, ((Circle*)shape)->perimeter_point);
-            fprintf(file, "circle %d %d\n", idx1, idx2);
-            break;
-        }
-        case ST_PARALLEL:
-        {
-            int idx1 = vector_index_of(cs->shapes, ((Parallel*)shape)->line);
-            int idx2 = vector_index_of(cs->shapes, ((Parallel*)shape)->point);
-            fprintf(file, "parallel %d %d\n", idx1, idx2);
-            break;
-        }
-        case ST_PERPENDICULAR:
-        {
-            int idx1 = vector_index_of(cs->shapes, ((Perpendicular*)shape)->line);
-            int idx2 = vector_index_of(cs->shapes, ((Perpendicular*)shape)->point);
-            fprintf(file, "perpendicular %d %d\n", idx1, idx2);
-            break;
-        }
-        case ST_ANGLE_BISECTOR:
-        {
-            int idx1 = vector_index_of(cs->shapes, ((AngleBisector*)shape)->line1);
-            int idx2 = vector_index_of(cs->shapes, ((AngleBisector*)shape)->line1);
-            fprintf(file, "bisector %d %d\n", idx1, idx2);
-            break;
-        }
-        case ST_TANGENT:
+        printf("failed to allocate memory for the saver\n");
+        exit(1);
+    }
+    strcpy(saver_path, path);
+    strcpy(temporary_path, path);
+    strcat(temporary_path, ".tmp");
+    *saver = (CoordinateSystemSaver){ cs, fopen(temporary_path, "w"), saver_path, temporary_path, 0, cs->index->version };
+    if (saver->file == NULL)
+    {
+        SDL_Log("couldn't create file: %s", temporary_path);
+        free(saver_path);
+        free(temporary_path);
+        free(saver);
+        return NULL;
+    }
+    _coordinate_system_number_shapes(cs);
+    return saver;
+}
+bool coordinate_system_save_step(CoordinateSystemSaver* saver, double* progress)
+{
+    //a save that is spread across frames must not mix two versions of the shapes
+    CoordinateSystem* cs = saver->cs;
+    if (saver->version != cs->index->version)
+    {
+        fclose(saver->file);
+        saver->file = fopen(saver->temporary_path, "w");
+        saver->next_shape = 0;
+        saver->version = cs->index->version;
+        _coordinate_system_number_shapes(cs);
+        if (saver->file == NULL)
         {
-            int idx1 = vector_index_of(cs->shapes, ((Tangent*)shape)->circle);
-            int idx2 = vector_index_of(cs->shapes, ((Tangent*)shape)->point);
-            fprintf(file, "tangent %d %d\n", idx1, idx2);
-            break;
-        }
-        default:
-            break;
+            SDL_Log("couldn't create file: %s", saver->temporary_path);
+            coordinate_system_save_cancel(saver);
+            *progress = 1.0;
+            return true;
         }
     }
-    fclose(file);
+    size_t shape_count = vector_size(cs->shapes);
+    size_t end = SDL_min(saver->next_shape + SAVE_STEP_SHAPES, shape_count);
+    for (; saver->next_shape < end; saver->next_shape++)
+        _coordinate_system_save_shape(saver->file, vector_get(cs->shapes, saver->next_shape));
+    *progress = shape_count == 0 ? 1.0 : (double)saver->next_shape / shape_count;
+    if (saver->next_shape < shape_count)
+        return false;
+
+    bool written = fclose(saver->file) == 0;
+    saver->file = NULL;
+    //rename doesn't replace an existing file on every platform
+    if (!written || (remove(saver->path) != 0 && errno != ENOENT) || rename(saver->temporary_path, saver->path) != 0)
+        SDL_Log("couldn't save file: %s", saver->path);
+    coordinate_system_save_cancel(saver);
+    return true;
+}
+void coordinate_system_save_cancel(CoordinateSystemSaver* saver)
+{
+    if (saver == NULL)
+        return;
+    if (saver->file != NULL)
+    {
+        fclose(saver->file);
+        remove(saver->temporary_path);
+    }
+    free(saver->path);
+    free(saver->temporary_path);
+    free(saver);
 }
 CoordinateSystem* coordinate_system_load(const char* path)
 {
@@ -123,9 +274,10 @@ CoordinateSystem* coordinate_system_load(const char* path)
     FILE* file = fopen(path, "r");
     if (file == NULL)
     {
-        free(cs);
+        coordinate_system_destroy(cs);
         return NULL;
     }
+    TRACE_BEGIN("coordinate_system_load");
     char buffer[256];
     while (fgets(buffer, 256, file) != NULL)
     {
@@ -155,6 +307,7 @@ CoordinateSystem* coordinate_system_load(const char* path)
         }
     }
     fclose(file);
+    TRACE_END("coordinate_system_load");
     return cs;
 }
 
@@ -163,16 +316,14 @@ Vector2 screen_to_coordinates(CoordinateSystem* cs, Vector2 point)
     if (cs == NULL)
         return vector2_create(-1, -1);
 
-    return (Vector2){_x_screen_to_coordinate(cs, point.x),
-                     _y_screen_to_coordinate(cs, point.y)};
+    return view_transform_to_world(&cs->view, point);
 }
 Vector2 coordinates_to_screen(CoordinateSystem* cs, Vector2 point)
 {
     if (cs == NULL)
         return vector2_create(-1, -1);
 
-    return (Vector2){_x_coordinate_to_screen(cs, point.x),
-                     _y_coordinate_to_screen(cs, point.y)};
+    return view_transform_to_screen(&cs->view, point);
 }
 
 bool coordinate_system_is_hovered(CoordinateSystem* cs, Vector2 point)
@@ -183,91 +334,104 @@ bool coordinate_system_is_hovered(CoordinateSystem* cs, Vector2 point)
 }
 void coordinate_system_select_shape(CoordinateSystem* cs, Shape* shape)
 {
-    if (cs == NULL || shape == NULL)
+    if (cs == NULL || shape == NULL || shape->selected)
         return;
     shape->selected = true;
+    _shape_set_insert(cs->selected_shapes, shape, &shape->selected_slot);
 }
 void coordinate_system_deselect_shape(CoordinateSystem* cs, Shape* shape)
 {
-    if (cs == NULL || shape == NULL)
+    if (cs == NULL || shape == NULL || !shape->selected)
         return;
     shape->selected = false;
+    _shape_set_erase(cs->selected_shapes, &shape->selected_slot, false);
 }
 void coordinate_system_select_all_shapes(CoordinateSystem* cs)
 {
     if (cs == NULL)
         return;
     for (size_t i = 0; i < vector_size(cs->shapes); i++)
+        coordinate_system_select_shape(cs, vector_get(cs->shapes, i));
+}
+void coordinate_system_select_region(CoordinateSystem* cs, const Vector2* polygon, size_t vertex_count, bool crossing)
+{
+    if (cs == NULL || polygon == NULL || vertex_count < 3)
+        return;
+    Vector2* world_polygon = (Vector2*)malloc(sizeof(Vector2) * vertex_count);
+    if (world_polygon == NULL)
     {
-        Shape* shape = vector_get(cs->shapes, i);
-        shape->selected = true;
+        printf("failed to allocate memory for the selected region\n");
+        exit(1);
     }
+    for (size_t i = 0; i < vertex_count; i++)
+        world_polygon[i] = screen_to_coordinates(cs, polygon[i]);
+    spatial_index_query_polygon(cs->index, world_polygon, (int)vertex_count, crossing, _select_visit, cs);
+    free(world_polygon);
 }
 void coordinate_system_drag_selected_shapes(CoordinateSystem* cs, bool drag)
 {
     if (cs == NULL)
         return;
 
-    for (size_t i = 0; i < vector_size(cs->shapes); i++)
+    for (size_t i = 0; i < vector_size(cs->selected_shapes); i++)
     {
-        Shape* shape = vector_get(cs->shapes, i);
-        if (shape->selected)
-            shape->dragged = drag;
+        Shape* shape = vector_get(cs->selected_shapes, i);
+        if (shape->dragged == drag)
+            continue;
+        shape->dragged = drag;
+        if (drag)
+            _shape_set_insert(cs->dragged_shapes, shape, &shape->dragged_slot);
+        else
+            _shape_set_erase(cs->dragged_shapes, &shape->dragged_slot, true);
     }
 }
 Shape* coordinate_system_get_hovered_shape(CoordinateSystem* cs, Vector2 point)
 {
-    if (cs == NULL || !coordinate_system_is_hovered(cs, point))
+    if (cs == NULL)
         return NULL;
-    for (size_t i = 0; i < vector_size(cs->shapes); i++)
-    {
-        Shape* shape = vector_get(cs->shapes, i);
-        if (shape->type == ST_POINT && shape_overlap_point(cs, shape, point))
-            return shape;
-    }
-    for (size_t i = 0; i < vector_size(cs->shapes); i++)
+    //the state machine and the cursor ask for the same point every frame, and mostly nothing has changed since the last frame
+    HoverCache* cache = &cs->hover_cache;
+    if (cache->valid && cache->version == cs->index->version && cache->point.x == point.x && cache->point.y == point.y &&
+        cache->zoom == cs->zoom && cache->position.x == cs->position.x && cache->position.y == cs->position.y &&
+        cache->size.x == cs->size.x && cache->size.y == cs->size.y && cache->origin.x == cs->origin.x && cache->origin.y == cs->origin.y)
+        return cache->shape;
+
+    Shape* shape = NULL;
+    if (coordinate_system_is_hovered(cs, point))
     {
-        Shape* shape = vector_get(cs->shapes, i);
-        if (shape->type != ST_POINT && shape_overlap_point(cs, shape, point))
-            return shape;
+        //the view only scales uniformly, so the overlap distance on the screen is a fixed distance in world space
+        _HoverQuery query = { cs, point };
+        shape = spatial_index_pick(cs->index, screen_to_coordinates(cs, point), OVERLAP_DISTANCE / cs->zoom, _hover_filter, &query);
     }
-    return NULL;
+    *cache = (HoverCache){ true, point, cs->index->version, cs->position, cs->size, cs->origin, cs->zoom, shape };
+    return shape;
 }
 Vector* coordinate_system_get_selected_shapes(CoordinateSystem* cs)
 {
-    Vector* shapes = vector_create(0);
-    for (size_t i = 0; i < vector_size(cs->shapes); i++)
-    {
-        Shape* shape = vector_get(cs->shapes, i);
-        if (shape->selected)
-            vector_push_back(shapes, shape);
-    }
+    Vector* shapes = vector_create(vector_size(cs->selected_shapes));
+    for (size_t i = 0; i < vector_size(cs->selected_shapes); i++)
+        vector_push_back(shapes, vector_get(cs->selected_shapes, i));
     return shapes;
 }
 void coordinate_system_deselect_shapes(CoordinateSystem* cs)
 {
     if (cs == NULL)
         return;
-    for (size_t i = 0; i < vector_size(cs->shapes); i++)
+    for (size_t i = 0; i < vector_size(cs->selected_shapes); i++)
     {
-        Shape* shape = vector_get(cs->shapes, i);
+        Shape* shape = vector_get(cs->selected_shapes, i);
         shape->selected = false;
+        shape->selected_slot = -1;
     }
-
+    vector_clear(cs->selected_shapes);
 }
 void coordinate_system_delete_selected_shapes(CoordinateSystem* cs)
 {
     if (cs == NULL)
         return;
-    for (int32_t i = 0; i < (int32_t)vector_size(cs->shapes); i++)
-    {
-        Shape* shape = vector_get(cs->shapes, i);
-        if (shape->selected)
-        {
-            coordinate_system_destroy_shape(cs, shape);
-            i = -1;
-        }
-    }
+    //destroying a shape removes it (and the shapes defined by it) from the selection
+    while (vector_size(cs->selected_shapes) > 0)
+        coordinate_system_destroy_shape(cs, vector_get(cs->selected_shapes, vector_size(cs->selected_shapes) - 1));
 }
 void coordinate_system_translate(CoordinateSystem* cs, Vector2 translation)
 {
@@ -275,43 +439,246 @@ void coordinate_system_translate(CoordinateSystem* cs, Vector2 translation)
         return;
     translation = vector2_divide(translation, cs->size);
     cs->origin = vector2_add(cs->origin, translation);
+    _coordinate_system_update_view(cs);
 }
 void coordinate_system_zoom(CoordinateSystem* cs, double zoom)
 {
     if (cs == NULL)
         return;
     cs->zoom *= zoom;
+    _coordinate_system_update_view(cs);
 }
 void coordinate_system_update(CoordinateSystem* cs)
 {
     if (cs == NULL)
         return;
 
-    for (size_t i = 0; i < vector_size(cs->shapes); i++)
-        shape_update(cs, vector_get(cs->shapes, i));
+    TRACE_BEGIN("coordinate_system_update");
+    _coordinate_system_update_view(cs);
+
+    profiler_begin(PS_INTERSECTIONS);
+    //the intersections only change with the shapes, and an incremental recalculation is left to its steps
+    if (cs->intersection_version != cs->index->version)
+        coordinate_system_update_intersections(cs);
+    profiler_end(PS_INTERSECTIONS);
+    profiler_set_counter(PC_SHAPES, vector_size(cs->shapes));
+    profiler_set_counter(PC_INTERSECTIONS, vector_size(cs->intersection_points));
+    TRACE_COUNTER("shapes", vector_size(cs->shapes));
+    TRACE_COUNTER("intersection points", vector_size(cs->intersection_points));
+    TRACE_END("coordinate_system_update");
+}
+void coordinate_system_update_intersections(CoordinateSystem* cs)
+{
+    if (cs == NULL)
+        return;
+
+    TRACE_BEGIN("intersection_get batch");
+    coordinate_system_begin_intersections(cs);
+    _coordinate_system_run_intersections(cs, cs->intersection_block_count);
+    cs->intersection_rebuilding = false;
+    TRACE_END("intersection_get batch");
+}
+void coordinate_system_begin_intersections(CoordinateSystem* cs)
+{
+    if (cs == NULL)
+        return;
 
     for (size_t i = 0; i < vector_size(cs->intersection_points); i++)
         shape_destroy(cs, (Shape*)vector_get(cs->intersection_points, i));
     vector_clear(cs->intersection_points);
-    for (size_t i = 0; i < vector_size(cs->shapes); i++)
+    _coordinate_system_prepare_intersections(cs, _coordinate_system_intersection_pool(cs));
+
+    size_t shape_count = vector_size(cs->shapes);
+    size_t block_count = 0;
+    for (size_t row = 0; row < shape_count; block_count++)
     {
-        Shape* shape1 = vector_get(cs->shapes, i);
-        for (size_t j = i + 1; j < vector_size(cs->shapes); j++)
-        {
-            Shape* shape2 = vector_get(cs->shapes, j);
-            Vector* intersections = intersection_get(shape1, shape2);
-            if (intersections != NULL)
-                for (size_t i = 0; i < vector_size(intersections); i++)
-                    _intersection_point_create(cs, *(Vector2*)vector_get(intersections, i));
-            vector_destroy(intersections);
-        }
+        IntersectionBlock* block = &cs->intersection_blocks[block_count];
+        block->first_row = row;
+        for (size_t pairs = 0; row < shape_count && pairs < INTERSECTION_BLOCK_PAIRS; row++)
+            pairs += shape_count - 1 - row;
+        block->end_row = row;
     }
+    cs->intersection_block_count = block_count;
+    cs->intersection_next_block = 0;
+    cs->intersection_version = cs->index->version;
+    cs->intersection_rebuilding = true;
+}
+bool coordinate_system_step_intersections(CoordinateSystem* cs, double* progress)
+{
+    if (cs->intersection_rebuilding)
+    {
+        if (cs->intersection_version != cs->index->version)
+            coordinate_system_begin_intersections(cs);
+        TRACE_BEGIN("intersection_get batch");
+        int worker_count = thread_pool_get_worker_count(_coordinate_system_intersection_pool(cs));
+        _coordinate_system_run_intersections(cs, SDL_min(cs->intersection_next_block + worker_count, cs->intersection_block_count));
+        TRACE_END("intersection_get batch");
+        cs->intersection_rebuilding = cs->intersection_next_block < cs->intersection_block_count;
+    }
+    *progress = cs->intersection_rebuilding ? (double)cs->intersection_next_block / cs->intersection_block_count : 1.0;
+    return !cs->intersection_rebuilding;
 }
 void coordinate_system_draw(CoordinateSystem* cs)
 {
     if (cs == NULL)
         return;
 
+    TRACE_BEGIN("coordinate_system_draw");
+    profiler_begin(PS_SHAPE_DRAW);
+    _coordinate_system_draw_grid(cs);
+
+    for (size_t i = 0; i < vector_size(cs->shapes); i++)
+    {
+        Shape* shape = vector_get(cs->shapes, i);
+        if (shape->type != ST_POINT)
+            shape_draw(cs, shape);
+    }
+    //the intersection points and the points are converted to the screen in batches
+    Vector2* markers = _coordinate_system_project_intersections(cs);
+    for (size_t i = 0; i < vector_size(cs->intersection_points); i++)
+        _intersection_marker_draw(markers[i]);
+    Vector2* points = _coordinate_system_project_points(cs);
+    for (size_t i = 0, j = 0; i < vector_size(cs->shapes); i++)
+    {
+        Shape* shape = vector_get(cs->shapes, i);
+        if (shape->type == ST_POINT)
+            point_draw_at(shape, points[j++]);
+    }
+    profiler_end(PS_SHAPE_DRAW);
+    TRACE_END("coordinate_system_draw");
+}
+void coordinate_system_update_dimensions(CoordinateSystem* cs, Vector2 position, Vector2 size)
+{
+    if (cs == NULL)
+        return;
+    cs->position = position;
+    cs->size = size;
+    _coordinate_system_update_view(cs);
+}
+bool coordinate_system_export(CoordinateSystem* cs, const char* path, int width, int height)
+{
+    if (cs == NULL || width <= 0 || height <= 0)
+        return false;
+
+    PngWriter* writer = png_writer_open(path, width, height);
+    if (writer == NULL)
+        return false;
+
+    //the image is rendered in horizontal bands of at most EXPORT_BAND_PIXELS pixels (whole tiles high),
+    //coordinates_to_screen still maps to the whole image and the raster origin selects the band
+    TRACE_BEGIN("coordinate_system_export");
+    int band_height = (EXPORT_BAND_PIXELS / width) / RASTER_TILE_SIZE * RASTER_TILE_SIZE;
+    band_height = SDL_min(SDL_max(band_height, RASTER_TILE_SIZE), height);
+    Vector2 position = cs->position;
+    Vector2 size = cs->size;
+    RasterImage* image = raster_create(width, band_height);
+    ThreadPool* pool = thread_pool_create(0);
+    renderer_bind_raster(image);
+    coordinate_system_update_dimensions(cs, vector2_create(0, 0), vector2_create(width, height));
+    bool saved = true;
+    for (int top = 0; top < height && saved; top += band_height)
+    {
+        raster_set_origin(image, 0, top);
+        raster_begin_batch(image);
+        renderer_clear(WHITE);
+        coordinate_system_draw(cs);
+        raster_end_batch(image, pool);
+        saved = png_writer_write_rows(writer, image->pixels, SDL_min(band_height, height - top), image->width);
+    }
+    renderer_bind_raster(NULL);
+    thread_pool_destroy(pool);
+    raster_destroy(image);
+    coordinate_system_update_dimensions(cs, position, size);
+
+    saved = png_writer_close(writer) && saved;
+    TRACE_END("coordinate_system_export");
+    return saved;
+}
+bool coordinate_system_export_svg(CoordinateSystem* cs, const char* path, int width, int height)
+{
+    if (cs == NULL || width <= 0 || height <= 0)
+        return false;
+
+    SvgWriter* writer = svg_writer_open(path, width, height);
+    if (writer == NULL)
+        return false;
+
+    //the shapes draw themselves through the renderer (so the lines are clipped to the view the same way),
+    //the intersection points are references to a single marker, which keeps huge scenes small
+    TRACE_BEGIN("coordinate_system_export_svg");
+    Vector2 position = cs->position;
+    Vector2 size = cs->size;
+    coordinate_system_update_dimensions(cs, vector2_create(0, 0), vector2_create(width, height));
+    renderer_bind_svg(writer);
+    svg_writer_begin_symbol(writer, INTERSECTION_MARKER_ID);
+    _intersection_marker_draw(vector2_create(0, 0));
+    svg_writer_end_symbol(writer);
+
+    renderer_clear(WHITE);
+    _coordinate_system_draw_grid(cs);
+    for (size_t i = 0; i < vector_size(cs->shapes); i++)
+    {
+        Shape* shape = vector_get(cs->shapes, i);
+        if (shape->type != ST_POINT)
+            shape_draw(cs, shape);
+    }
+    Vector2* markers = _coordinate_system_project_intersections(cs);
+    for (size_t i = 0; i < vector_size(cs->intersection_points); i++)
+    {
+        Vector2 marker = markers[i];
+        if (marker.x >= -INTERSECTION_MARKER_RADIUS && marker.y >= -INTERSECTION_MARKER_RADIUS &&
+            marker.x <= width + INTERSECTION_MARKER_RADIUS && marker.y <= height + INTERSECTION_MARKER_RADIUS)
+            svg_writer_use(writer, INTERSECTION_MARKER_ID, (int)marker.x, (int)marker.y);
+    }
+    Vector2* points = _coordinate_system_project_points(cs);
+    for (size_t i = 0, j = 0; i < vector_size(cs->shapes); i++)
+    {
+        Shape* shape = vector_get(cs->shapes, i);
+        if (shape->type == ST_POINT)
+            point_draw_at(shape, points[j++]);
+    }
+    renderer_bind_svg(NULL);
+    coordinate_system_update_dimensions(cs, position, size);
+
+    bool saved = svg_writer_close(writer);
+    TRACE_END("coordinate_system_export_svg");
+    return saved;
+}
+void coordinate_system_destroy_shape(CoordinateSystem* cs, Shape* shape)
+{
+    shape_destroy(cs, shape);
+    vector_remove(cs->shapes, shape);
+    for (size_t i = 0; i < vector_size(cs->shapes); i++)
+    {
+        Shape* shp = vector_get(cs->shapes, i);
+        if (shape_is_defined_by(shp, shape))
+        {
+            coordinate_system_destroy_shape(cs, shp);
+            i--;
+        }
+    }
+}
+void coordinate_system_shape_changed(CoordinateSystem* cs, Shape* shape)
+{
+    spatial_index_update(cs->index, shape);
+}
+Uint64 coordinate_system_get_version(CoordinateSystem* cs)
+{
+    return cs->index->version;
+}
+void _coordinate_system_release_shape(CoordinateSystem* cs, Shape* shape)
+{
+    //no set may keep a pointer to a freed shape, whichever path destroys it
+    if (shape->selected_slot >= 0)
+        _shape_set_erase(cs->selected_shapes, &shape->selected_slot, false);
+    if (shape->dragged_slot >= 0)
+        _shape_set_erase(cs->dragged_shapes, &shape->dragged_slot, true);
+    shape->selected = false;
+    shape->dragged = false;
+}
+
+static void _coordinate_system_draw_grid(CoordinateSystem* cs)
+{
     Color grid_color = color_from_grayscale(240);
     double step = cs->zoom;
     double y = cs->origin.y * cs->size.y + cs->position.y;
@@ -342,70 +709,295 @@ void coordinate_system_draw(CoordinateSystem* cs)
     y = cs->position.y + cs->origin.y * cs->size.y;
     renderer_draw_line(x, cs->position.y - 10, x, cs->position.y + cs->size.y + 10, 1, BLACK);
     renderer_draw_line(cs->position.x - 10, y, cs->position.x + cs->size.x + 10, y, 1, BLACK);
+}
 
+static void _coordinate_system_number_shapes(CoordinateSystem* cs)
+{
     for (size_t i = 0; i < vector_size(cs->shapes); i++)
+        ((Shape*)vector_get(cs->shapes, i))->save_index = (int)i;
+}
+static int _save_index(Shape* shape)
+{
+    //a shape that is still being constructed can miss a reference
+    return shape == NULL ? -1 : shape->save_index;
+}
+static void _coordinate_system_save_shape(FILE* file, Shape* shape)
+{
+    switch (shape->type)
     {
-        Shape* shape = vector_get(cs->shapes, i);
-        if (shape->type != ST_POINT)
-            shape_draw(cs, shape);
+    case ST_POINT:
+    {
+        fprintf(file, "point %lf %lf\n", ((Point*)shape)->coordinates.x, ((Point*)shape)->coordinates.y);
+        break;
     }
-    for (size_t i = 0; i < vector_size(cs->intersection_points); i++)
+    case ST_LINE:
+    {
+        int idx1 = _save_index((Shape*)((Line*)shape)->p1);
+        int idx2 = _save_index((Shape*)((Line*)shape)->p2);
+        fprintf(file, "line %d %d\n", idx1, idx2);
+        break;
+    }
+    case ST_CIRCLE:
+    {
+        int idx1 = _save_index((Shape*)((Circle*)shape)->center);
+        int idx2 = _save_index((Shape*)((Circle*)shape)->perimeter_point);
+        fprintf(file, "circle %d %d\n", idx1, idx2);
+        break;
+    }
+    case ST_PARALLEL:
+    {
+        int idx1 = _save_index((Shape*)((Parallel*)shape)->line);
+        int idx2 = _save_index((Shape*)((Parallel*)shape)->point);
+        fprintf(file, "parallel %d %d\n", idx1, idx2);
+        break;
+    }
+    case ST_PERPENDICULAR:
+    {
+        int idx1 = _save_index((Shape*)((Perpendicular*)shape)->line);
+        int idx2 = _save_index((Shape*)((Perpendicular*)shape)->point);
+        fprintf(file, "perpendicular %d %d\n", idx1, idx2);
+        break;
+    }
+    case ST_ANGLE_BISECTOR:
+    {
+        int idx1 = _save_index((Shape*)((AngleBisector*)shape)->line1);
+        int idx2 = _save_index((Shape*)((AngleBisector*)shape)->line1);
+        fprintf(file, "bisector %d %d\n", idx1, idx2);
+        break;
+    }
+    case ST_TANGENT:
+    {
+        int idx1 = _save_index((Shape*)((Tangent*)shape)->circle);
+        int idx2 = _save_index((Shape*)((Tangent*)shape)->point);
+        fprintf(file, "tangent %d %d\n", idx1, idx2);
+        break;
+    }
+    default:
+        break;
+    }
+}
+static void _coordinate_system_update_view(CoordinateSystem* cs)
+{
+    cs->view = view_transform_create(cs->position, cs->size, cs->origin, cs->zoom);
+}
+static Vector2* _coordinate_system_reserve_screen_points(CoordinateSystem* cs, size_t count)
+{
+    if (count > cs->screen_point_capacity)
     {
-        Point* point = vector_get(cs->intersection_points, i);
-        _intersection_point_draw(cs, point);
+        size_t capacity = SDL_max(count, cs->screen_point_capacity * 2);
+        Vector2* screen_points = (Vector2*)realloc(cs->screen_points, sizeof(Vector2) * capacity);
+        if (screen_points == NULL)
+        {
+            printf("failed to allocate memory for the screen points\n");
+            exit(1);
+        }
+        cs->screen_points = screen_points;
+        cs->screen_point_capacity = capacity;
     }
+    return cs->screen_points;
+}
+static Vector2* _coordinate_system_project_points(CoordinateSystem* cs)
+{
+    //the coordinates of the points (in the order of the shapes) are gathered, then converted in one pass
+    Vector2* screen_points = _coordinate_system_reserve_screen_points(cs, vector_size(cs->shapes));
+    size_t count = 0;
     for (size_t i = 0; i < vector_size(cs->shapes); i++)
     {
         Shape* shape = vector_get(cs->shapes, i);
         if (shape->type == ST_POINT)
-            shape_draw(cs, shape);
+            screen_points[count++] = ((Point*)shape)->coordinates;
     }
+    view_transform_to_screen_batch(&cs->view, screen_points, screen_points, count);
+    return screen_points;
 }
-void coordinate_system_update_dimensions(CoordinateSystem* cs, Vector2 position, Vector2 size)
+static Vector2* _coordinate_system_project_intersections(CoordinateSystem* cs)
 {
-    if (cs == NULL)
-        return;
-    cs->position = position;
-    cs->size = size;
+    size_t count = vector_size(cs->intersection_points);
+    Vector2* screen_points = _coordinate_system_reserve_screen_points(cs, count);
+    for (size_t i = 0; i < count; i++)
+        screen_points[i] = ((Point*)vector_get(cs->intersection_points, i))->coordinates;
+    view_transform_to_screen_batch(&cs->view, screen_points, screen_points, count);
+    return screen_points;
 }
-void coordinate_system_destroy_shape(CoordinateSystem* cs, Shape* shape)
+
+static ThreadPool* _coordinate_system_intersection_pool(CoordinateSystem* cs)
 {
-    shape_destroy(cs, shape);
-    vector_remove(cs->shapes, shape);
-    for (size_t i = 0; i < vector_size(cs->shapes); i++)
+    //small scenes stay on the calling thread, waking the workers would cost more than the pairs
+    size_t shape_count = vector_size(cs->shapes);
+    if (shape_count * (shape_count - 1) / 2 < INTERSECTION_PARALLEL_PAIRS)
+        return NULL;
+    if (cs->intersection_pool == NULL)
+        cs->intersection_pool = thread_pool_create(0);
+    return cs->intersection_pool;
+}
+static void _coordinate_system_prepare_intersections(CoordinateSystem* cs, ThreadPool* pool)
+{
+    //the geometry of every line and circle is calculated once, there is room for the blocks of the pair space,
+    //and every worker gets its batches and point buffer
+    size_t shape_count = vector_size(cs->shapes);
+    if (2 * shape_count > cs->intersection_geometry_capacity)
     {
-        Shape* shp = vector_get(cs->shapes, i);
-        if (shape_is_defined_by(shp, shape))
+        size_t capacity = SDL_max(2 * shape_count, cs->intersection_geometry_capacity * 2);
+        Vector2* geometry = (Vector2*)realloc(cs->intersection_geometry, sizeof(Vector2) * capacity);
+        if (geometry == NULL)
         {
-            coordinate_system_destroy_shape(cs, shp);
-            i--;
+            printf("failed to allocate memory for the intersection geometry\n");
+            exit(1);
+        }
+        cs->intersection_geometry = geometry;
+        cs->intersection_geometry_capacity = capacity;
+    }
+    Vector2* geometry = cs->intersection_geometry;
+    for (size_t i = 0; i < shape_count; i++)
+    {
+        Shape* shape = vector_get(cs->shapes, i);
+        if (shape->type == ST_LINE)
+        {
+            Line* line = (Line*)shape;
+            geometry[2 * i] = line->p1->coordinates;
+            geometry[2 * i + 1] = vector2_subtract(line->p2->coordinates, line->p1->coordinates);
+        }
+        else if (shape->type == ST_CIRCLE)
+        {
+            Circle* circle = (Circle*)shape;
+            geometry[2 * i] = circle->center->coordinates;
+            geometry[2 * i + 1] = vector2_create(vector2_distance(circle->center->coordinates, circle->perimeter_point->coordinates), 0);
         }
     }
-}
 
-static double _x_screen_to_coordinate(CoordinateSystem* cs, double x)
+    //there are at most shape_count blocks (one row each)
+    if (shape_count > cs->intersection_block_capacity)
+    {
+        size_t capacity = SDL_max(shape_count, cs->intersection_block_capacity * 2);
+        IntersectionBlock* blocks = (IntersectionBlock*)realloc(cs->intersection_blocks, sizeof(IntersectionBlock) * capacity);
+        if (blocks == NULL)
+        {
+            printf("failed to allocate memory for the intersection blocks\n");
+            exit(1);
+        }
+        cs->intersection_blocks = blocks;
+        cs->intersection_block_capacity = capacity;
+    }
+
+    int worker_count = thread_pool_get_worker_count(pool);
+    if (worker_count > cs->intersection_worker_count)
+    {
+        IntersectionWorker* workers = (IntersectionWorker*)realloc(cs->intersection_workers, sizeof(IntersectionWorker) * worker_count);
+        if (workers == NULL)
+        {
+            printf("failed to allocate memory for the intersection workers\n");
+            exit(1);
+        }
+        for (int i = cs->intersection_worker_count; i < worker_count; i++)
+            workers[i] = (IntersectionWorker){ line_circle_batch_create(), circle_circle_batch_create(), NULL, 0, 0 };
+        cs->intersection_workers = workers;
+        cs->intersection_worker_count = worker_count;
+    }
+}
+static void _coordinate_system_run_intersections(CoordinateSystem* cs, size_t end_block)
+{
+    //the blocks are merged in order, so the points are in the same order with any number of workers
+    for (int i = 0; i < cs->intersection_worker_count; i++)
+        cs->intersection_workers[i].point_count = 0;
+    size_t first_block = cs->intersection_next_block;
+    thread_pool_run(_coordinate_system_intersection_pool(cs), end_block - first_block, _intersection_block_run, cs);
+    for (size_t i = first_block; i < end_block; i++)
+    {
+        IntersectionBlock* block = &cs->intersection_blocks[i];
+        Vector2* points = cs->intersection_workers[block->worker].points + block->first_point;
+        for (size_t j = 0; j < block->point_count; j++)
+            _intersection_point_create(cs, points[j]);
+    }
+    cs->intersection_next_block = end_block;
+}
+static void _intersection_block_run(void* data, size_t index, int worker)
 {
-    x -= cs->position.x + cs->origin.x * cs->size.x;
-    x /= cs->zoom;
-    return x;
+    //line x line pairs are intersected directly, line x circle and circle x circle pairs are gathered into the batches of the worker
+    //and intersected together, the points of the block are appended to the buffer of the worker
+    CoordinateSystem* cs = (CoordinateSystem*)data;
+    IntersectionBlock* block = &cs->intersection_blocks[cs->intersection_next_block + index];
+    IntersectionWorker* scratch = &cs->intersection_workers[worker];
+    Vector2* geometry = cs->intersection_geometry;
+    size_t shape_count = vector_size(cs->shapes);
+    LineCircleBatch* line_circle = scratch->line_circle_batch;
+    CircleCircleBatch* circle_circle = scratch->circle_circle_batch;
+    line_circle_batch_clear(line_circle);
+    circle_circle_batch_clear(circle_circle);
+    block->worker = worker;
+    block->first_point = scratch->point_count;
+
+    for (size_t i = block->first_row; i < block->end_row; i++)
+    {
+        Shape* shape1 = vector_get(cs->shapes, i);
+        if (shape1->type != ST_LINE && shape1->type != ST_CIRCLE)
+            continue;
+        for (size_t j = i + 1; j < shape_count; j++)
+        {
+            Shape* shape2 = vector_get(cs->shapes, j);
+            if (shape1->type == ST_LINE && shape2->type == ST_LINE)
+            {
+                Vector* intersections = intersection_get(shape1, shape2);
+                if (intersections == NULL)
+                    continue;
+                for (size_t k = 0; k < vector_size(intersections); k++)
+                {
+                    Vector2* intersection = vector_get(intersections, k);
+                    _intersection_worker_push(scratch, *intersection);
+                    free(intersection);
+                }
+                vector_destroy(intersections);
+            }
+            else if (shape1->type == ST_LINE && shape2->type == ST_CIRCLE)
+                line_circle_batch_add(line_circle, geometry[2 * i], geometry[2 * i + 1], geometry[2 * j], geometry[2 * j + 1].x);
+            else if (shape1->type == ST_CIRCLE && shape2->type == ST_LINE)
+                line_circle_batch_add(line_circle, geometry[2 * j], geometry[2 * j + 1], geometry[2 * i], geometry[2 * i + 1].x);
+            else if (shape1->type == ST_CIRCLE && shape2->type == ST_CIRCLE)
+                circle_circle_batch_add(circle_circle, geometry[2 * i], geometry[2 * i + 1].x, geometry[2 * j], geometry[2 * j + 1].x);
+        }
+    }
+
+    line_circle_batch_run(line_circle);
+    for (size_t i = 0; i < line_circle->count; i++)
+        if (line_circle->found[i])
+        {
+            _intersection_worker_push(scratch, line_circle->points[2 * i]);
+            _intersection_worker_push(scratch, line_circle->points[2 * i + 1]);
+        }
+    circle_circle_batch_run(circle_circle);
+    for (size_t i = 0; i < circle_circle->count; i++)
+        if (circle_circle->found[i])
+        {
+            _intersection_worker_push(scratch, circle_circle->points[2 * i]);
+            _intersection_worker_push(scratch, circle_circle->points[2 * i + 1]);
+        }
+    block->point_count = scratch->point_count - block->first_point;
 }
-static double _y_screen_to_coordinate(CoordinateSystem* cs, double y)
+static void _intersection_worker_push(IntersectionWorker* worker, Vector2 point)
 {
-    y -= cs->position.y + cs->origin.y * cs->size.y;
-    y /= -cs->zoom;
-    return y;
+    if (worker->point_count == worker->point_capacity)
+    {
+        size_t capacity = SDL_max(worker->point_capacity * 2, 256);
+        Vector2* points = (Vector2*)realloc(worker->points, sizeof(Vector2) * capacity);
+        if (points == NULL)
+        {
+            printf("failed to allocate memory for the intersection points\n");
+            exit(1);
+        }
+        worker->points = points;
+        worker->point_capacity = capacity;
+    }
+    worker->points[worker->point_count++] = point;
 }
-static double _x_coordinate_to_screen(CoordinateSystem* cs, double x)
+
+static bool _hover_filter(Shape* shape, void* data)
 {
-    x *= cs->zoom;
-    x += cs->origin.x * cs->size.x + cs->position.x;
-    return x;
+    _HoverQuery* query = (_HoverQuery*)data;
+    return shape_overlap_point(query->cs, shape, query->point);
 }
-static double _y_coordinate_to_screen(CoordinateSystem* cs, double y)
+
+static void _select_visit(Shape* shape, void* data)
 {
-    y *= -cs->zoom;
-    y += cs->origin.y * cs->size.y + cs->position.y;
-    return y;
+    coordinate_system_select_shape((CoordinateSystem*)data, shape);
 }
 
 static Point* _intersection_point_create(CoordinateSystem* cs, Vector2 coordinates)
@@ -413,14 +1005,18 @@ static Point* _intersection_point_create(CoordinateSystem* cs, Vector2 coordinat
     Point* point = malloc(sizeof(Point));
     point->base.type = ST_POINT;
     point->base.selected = false;
+    point->base.dragged = false;
+    point->base.spatial_slot = -1;
+    point->base.selected_slot = -1;
+    point->base.dragged_slot = -1;
+    point->base.save_index = -1;
     point->coordinates = coordinates;
     vector_push_back(cs->intersection_points, point);
     return point;
 }
-static void _intersection_point_draw(CoordinateSystem* cs, Point* self)
+static void _intersection_marker_draw(Vector2 position)
 {
-    Vector2 position = coordinates_to_screen(cs, self->coordinates);
-    renderer_draw_circle(position.x, position.y, 6, WHITE);
+    renderer_draw_circle(position.x, position.y, INTERSECTION_MARKER_RADIUS, WHITE);
     renderer_draw_circle(position.x, position.y, 5, DARK_GRAY);
     renderer_draw_circle(position.x, position.y, 4, DARK_GRAY);
     renderer_draw_filled_circle(position.x, position.y, 3, color_from_rgb(240, 240, 240));
@@ -1,11 +1,57 @@
 #pragma once
 
+#include <stdio.h>
+
+#include "../intersection/intersection.h"
 #include "../shape/shape.h"
+#include "../spatial_index/spatial_index.h"
+#include "../view_transform/view_transform.h"
 #include "../vector2/vector2.h"
 #include "../../texture/texture.h"
+#include "../../utils/thread_pool/thread_pool.h"
 #include "../../utils/vector/vector.h"
 
 #define INITIAL_ZOOM 20
+#define SAVE_STEP_SHAPES 32
+
+/**
+ * @brief The last hover result, valid while the point, the shapes (the version of the index) and the view are the same
+ */
+typedef struct HoverCache
+{
+    bool valid;
+    Vector2 point;
+    Uint64 version;
+    Vector2 position;
+    Vector2 size;
+    Vector2 origin;
+    double zoom;
+    Shape* shape;
+} HoverCache;
+
+/**
+ * @brief The scratch data of a worker of the intersection pass (its batches and the points of the blocks it has run)
+ */
+typedef struct IntersectionWorker
+{
+    LineCircleBatch* line_circle_batch;
+    CircleCircleBatch* circle_circle_batch;
+    Vector2* points;
+    size_t point_count;
+    size_t point_capacity;
+} IntersectionWorker;
+
+/**
+ * @brief A block of the pair space (the pairs (i, j) of the shapes with first_row <= i < end_row and i < j), and where its points are
+ */
+typedef struct IntersectionBlock
+{
+    size_t first_row;
+    size_t end_row;
+    int worker;
+    size_t first_point;
+    size_t point_count;
+} IntersectionBlock;
 
 typedef struct CoordinateSystem
 {
@@ -13,11 +59,50 @@ typedef struct CoordinateSystem
     Vector2 size;
     Vector2 origin;
     double zoom;
+    //the view as an affine transform, recalculated whenever the fields above change through the coordinate_system functions (and every update)
+    ViewTransform view;
 
     Vector* shapes;
     Vector* intersection_points;
+    SpatialIndex* index;
+    HoverCache hover_cache;
+    //the selected and the dragged shapes (every shape knows its slot in them, so adding and removing one is O(1))
+    Vector* selected_shapes;
+    Vector* dragged_shapes;
+    Vector* drag_points;
+    //the screen positions of the points of the last batch conversion
+    Vector2* screen_points;
+    size_t screen_point_capacity;
+    //two vectors per shape for the last update: a point and the direction of a line, or the center and (radius, 0) of a circle
+    Vector2* intersection_geometry;
+    size_t intersection_geometry_capacity;
+    //the pair space is split into blocks that run on the workers of the pool (created when the scene gets large enough)
+    IntersectionBlock* intersection_blocks;
+    size_t intersection_block_capacity;
+    IntersectionWorker* intersection_workers;
+    int intersection_worker_count;
+    ThreadPool* intersection_pool;
+    //the intersection points belong to this version of the index, an incremental rebuild runs the blocks
+    //from intersection_next_block a few at a time (see coordinate_system_step_intersections)
+    Uint64 intersection_version;
+    size_t intersection_block_count;
+    size_t intersection_next_block;
+    bool intersection_rebuilding;
 } CoordinateSystem;
 
+/**
+ * @brief A save of a coordinate system that is written a few shapes at a time into a temporary file (see coordinate_system_save_step)
+ */
+typedef struct CoordinateSystemSaver
+{
+    CoordinateSystem* cs;
+    FILE* file;
+    char* path;
+    char* temporary_path;
+    size_t next_shape;
+    Uint64 version;
+} CoordinateSystemSaver;
+
 /**
  * @brief Creates a coordinate system
  * 
@@ -47,6 +132,29 @@ void coordinate_system_destroy(CoordinateSystem* cs);
  * @param path The path to save the coordinate system to
  */
 void coordinate_system_save(CoordinateSystem* cs, const char* path);
+/**
+ * @brief Starts saving a coordinate system incrementally (the shapes are written into path.tmp, which replaces the file at the end)
+ * 
+ * @param cs The coordinate system to save (it must not be destroyed before the save is finished or cancelled)
+ * @param path The path to save the coordinate system to
+ * @return CoordinateSystemSaver* The saver (NULL if the file could not be created)
+ */
+CoordinateSystemSaver* coordinate_system_save_begin(CoordinateSystem* cs, const char* path);
+/**
+ * @brief Writes the next SAVE_STEP_SHAPES shapes of a save in O(SAVE_STEP_SHAPES) (if the shapes have changed since the last step, the save starts over)
+ * 
+ * @param saver The saver
+ * @param progress Receives the progress of the save (between 0 and 1)
+ * @return true If the save is finished (or failed), the saver is destroyed
+ * @return false If there are more shapes to write
+ */
+bool coordinate_system_save_step(CoordinateSystemSaver* saver, double* progress);
+/**
+ * @brief Stops a save, deletes its temporary file and destroys the saver (the previous file is kept)
+ * 
+ * @param saver The saver (NULL is ignored)
+ */
+void coordinate_system_save_cancel(CoordinateSystemSaver* saver);
 /**
  * @brief Loads a coordinate system from a file (loads the shapes from a .gae file)
  * 
@@ -54,6 +162,29 @@ void coordinate_system_save(CoordinateSystem* cs, const char* path);
  * @return CoordinateSystem* The loaded coordinate system
  */
 CoordinateSystem* coordinate_system_load(const char* path);
+/**
+ * @brief Renders the coordinate system offscreen with the software rasterizer and streams it into a PNG image band by band
+ * (works without a window, the memory use doesn't depend on the height of the image, the tiles of a band are rasterized on every core)
+ * 
+ * @param cs The coordinate system to export
+ * @param path The path of the PNG image
+ * @param width The width of the image (the view is the same as on the screen, it just covers a different area)
+ * @param height The height of the image
+ * @return true If the image was saved
+ * @return false If the image could not be saved
+ */
+bool coordinate_system_export(CoordinateSystem* cs, const char* path, int width, int height);
+/**
+ * @brief Writes the coordinate system into an SVG image as vector elements (streamed through a fixed buffer, linear in the number of shapes)
+ * 
+ * @param cs The coordinate system to export
+ * @param path The path of the SVG image
+ * @param width The width of the image (the view is the same as on the screen, it just covers a different area)
+ * @param height The height of the image
+ * @return true If the image was saved
+ * @return false If the image could not be saved
+ */
+bool coordinate_system_export_svg(CoordinateSystem* cs, const char* path, int width, int height);
 
 /**
  * @brief Translates a point from the screen to the coordinate system
@@ -99,6 +230,15 @@ void coordinate_system_deselect_shape(CoordinateSystem* cs, Shape* shape);
  * @param cs The coordinate system to select the shapes in
  */
 void coordinate_system_select_all_shapes(CoordinateSystem* cs);
+/**
+ * @brief Selects the shapes in a region of the screen (a range query of the spatial index, the other shapes are not tested)
+ * 
+ * @param cs The coordinate system to select the shapes in
+ * @param polygon The vertices of the region (in screen coordinates, a rectangle or a lasso)
+ * @param vertex_count The number of vertices
+ * @param crossing Whether the lines and circles crossing the region are selected too (otherwise only the ones completely inside it)
+ */
+void coordinate_system_select_region(CoordinateSystem* cs, const Vector2* polygon, size_t vertex_count, bool crossing);
 /**
  * @brief Sets the dragged shape
  * 
@@ -107,7 +247,14 @@ void coordinate_system_select_all_shapes(CoordinateSystem* cs);
  */
 void coordinate_system_drag_selected_shapes(CoordinateSystem* cs, bool drag);
 /**
- * @brief Returns the shape hovered by the point
+ * @brief Moves the dragged shapes (every free point of them is moved once by the same world-space delta)
+ * 
+ * @param cs The coordinate system
+ * @param motion The motion of the mouse in pixels
+ */
+void coordinate_system_drag(CoordinateSystem* cs, Vector2 motion);
+/**
+ * @brief Returns the shape hovered by the point (asking again for the same point is free until the shapes or the view change)
  * 
  * @param cs The coordinate system to check
  * @param point The point to check
@@ -118,7 +265,7 @@ Shape* coordinate_system_get_hovered_shape(CoordinateSystem* cs, Vector2 point);
  * @brief Returns the selected shapes
  * 
  * @param cs The coordinate system to retrieve to selected shapes from
- * @return Vector* A vector of the selected shapes
+ * @return Vector* A vector of the selected shapes (a copy of the selection, in no particular order)
  */
 Vector* coordinate_system_get_selected_shapes(CoordinateSystem* cs);
 /**
@@ -148,11 +295,35 @@ void coordinate_system_translate(CoordinateSystem* cs, Vector2 translation);
  */
 void coordinate_system_zoom(CoordinateSystem* cs, double zoom);
 /**
- * @brief Updates the coordinate system and calculates the intersections
+ * @brief Updates the coordinate system and recalculates the intersections if the shapes have changed
  * 
  * @param cs The coordinate system to update
  */
 void coordinate_system_update(CoordinateSystem* cs);
+/**
+ * @brief Recalculates the intersection points of the shapes at once (large scenes are split into blocks of pairs that run in parallel,
+ * the points are merged in the order of the blocks, so their order doesn't depend on the number of threads)
+ * 
+ * @param cs The coordinate system
+ */
+void coordinate_system_update_intersections(CoordinateSystem* cs);
+/**
+ * @brief Starts recalculating the intersection points incrementally, coordinate_system_update leaves them to
+ * coordinate_system_step_intersections until the shapes change
+ * 
+ * @param cs The coordinate system
+ */
+void coordinate_system_begin_intersections(CoordinateSystem* cs);
+/**
+ * @brief Runs the next blocks of an incremental recalculation (one per worker) and adds their intersection points
+ * (the recalculation starts over if the shapes have changed since it was started)
+ * 
+ * @param cs The coordinate system
+ * @param progress Receives the progress of the recalculation (between 0 and 1)
+ * @return true If there are no more blocks to run
+ * @return false If the recalculation is not finished yet
+ */
+bool coordinate_system_step_intersections(CoordinateSystem* cs, double* progress);
 /**
  * @brief Draws the coordinate system
  * 
@@ -173,4 +344,25 @@ void coordinate_system_update_dimensions(CoordinateSystem* cs, Vector2 position,
  * @param cs The coordinate system to remove the shape from
  * @param shape The shape to remove
  */
-void coordinate_system_destroy_shape(CoordinateSystem* cs, Shape* shape);
\ No newline at end of file
+void coordinate_system_destroy_shape(CoordinateSystem* cs, Shape* shape);
+/**
+ * @brief Tells the coordinate system that the definition of a shape has changed (e.g. a line being created got a different point)
+ * 
+ * @param cs The coordinate system of the shape
+ * @param shape The changed shape
+ */
+void coordinate_system_shape_changed(CoordinateSystem* cs, Shape* shape);
+/**
+ * @brief Returns the version of the shapes, it changes whenever a shape is created, moved, changed or destroyed
+ * 
+ * @param cs The coordinate system
+ * @return Uint64 The version of the shapes
+ */
+Uint64 coordinate_system_get_version(CoordinateSystem* cs);
+/**
+ * @brief Removes a shape from the selected and the dragged shapes before it is freed (called by shape_destroy, should not be called directly)
+ * 
+ * @param cs The coordinate system
+ * @param shape The shape that is being destroyed
+ */
+void _coordinate_system_release_shape(CoordinateSystem* cs, Shape* shape);
\ No newline at end of file
@@ -1,11 +1,26 @@
 #include "intersection.h"
 
+#include <math.h>
+#include <string.h>
+
+#ifdef __AVX__
+    #include <immintrin.h>
+#elif defined(__SSE2__)
+    #include <emmintrin.h>
+#endif
+
 #define EPSILON 0.0001
 
 static Vector* _line_line_intersection(Line* line1, Line* line2);
 static Vector* _line_circle_intersection(Line* line, Circle* circle);
 static Vector* _circle_circle_intersection(Circle* circle1, Circle* circle2);
 
+static bool _line_circle_points(double px, double py, double dx, double dy, double cx, double cy, double radius, Vector2* point1, Vector2* point2);
+static bool _circle_circle_points(double x1, double y1, double radius1, double x2, double y2, double radius2, Vector2* point1, Vector2* point2);
+static Vector* _intersection_pair(bool found, Vector2 point1, Vector2 point2);
+static void _sqrt_lanes(Doublex4* values);
+static void* _batch_reserve(void* array, size_t size, const char* name);
+
 static bool _equals(double a, double b);
 
 Vector* intersection_get(Shape* shape1, Shape* shape2)
@@ -103,56 +118,270 @@ static Vector* _line_line_intersection(Line* line1, Line* line2)
 static Vector* _line_circle_intersection(Line* line, Circle* circle)
 {
     Vector2 p1 = line->p1->coordinates;
-    Vector2 p2 = line->p2->coordinates;
+    Vector2 d = vector2_subtract(line->p2->coordinates, p1);
     Vector2 center = circle->center->coordinates;
-    float radius = vector2_distance(center, circle->perimeter_point->coordinates);
-
-    Vector2 d = vector2_subtract(p2, p1);
-    Vector2 f = vector2_subtract(p1, center);
-
-    float a = vector2_dot(d, d);
-    float b = 2 * vector2_dot(f, d);
-    float c = vector2_dot(f, f) - radius * radius;
-
-    float discriminant = b * b - 4 * a * c;
+    double radius = vector2_distance(center, circle->perimeter_point->coordinates);
+    Vector2 point1, point2;
+    bool found = _line_circle_points(p1.x, p1.y, d.x, d.y, center.x, center.y, radius, &point1, &point2);
+    return _intersection_pair(found, point1, point2);
+}
+static Vector* _circle_circle_intersection(Circle* circle1, Circle* circle2)
+{
+    Vector2 center1 = circle1->center->coordinates;
+    Vector2 center2 = circle2->center->coordinates;
+    double radius1 = vector2_distance(center1, circle1->perimeter_point->coordinates);
+    double radius2 = vector2_distance(center2, circle2->perimeter_point->coordinates);
+    Vector2 point1, point2;
+    bool found = _circle_circle_points(center1.x, center1.y, radius1, center2.x, center2.y, radius2, &point1, &point2);
+    return _intersection_pair(found, point1, point2);
+}
+static bool _line_circle_points(double px, double py, double dx, double dy, double cx, double cy, double radius, Vector2* point1, Vector2* point2)
+{
+    //the points p + t * d of the line on the circle: a * t^2 + b * t + c = 0
+    double fx = px - cx, fy = py - cy;
+    double a = dx * dx + dy * dy;
+    double b = 2 * (fx * dx + fy * dy);
+    double c = fx * fx + fy * fy - radius * radius;
+    double discriminant = b * b - 4 * a * c;
     if (discriminant < 0)
-        return NULL;
-
+        return false;
     discriminant = sqrt(discriminant);
-    float t1 = (-b - discriminant) / (2 * a);
-    float t2 = (-b + discriminant) / (2 * a);
-
+    double t1 = (-b - discriminant) / (2 * a);
+    double t2 = (-b + discriminant) / (2 * a);
+    *point1 = vector2_create(px + dx * t1, py + dy * t1);
+    *point2 = vector2_create(px + dx * t2, py + dy * t2);
+    return true;
+}
+static bool _circle_circle_points(double x1, double y1, double radius1, double x2, double y2, double radius2, Vector2* point1, Vector2* point2)
+{
+    //a is the distance of the chord from the first center, h is the half length of the chord
+    double ex = x2 - x1, ey = y2 - y1;
+    double d = sqrt(ex * ex + ey * ey);
+    if (d > radius1 + radius2 || d < radius1 - radius2 || d < radius2 - radius1)
+        return false;
+    double a = (radius1 * radius1 - radius2 * radius2 + d * d) / (2 * d);
+    double h = sqrt(radius1 * radius1 - a * a);
+    double mx = x1 + ex * (a / d), my = y1 + ey * (a / d);
+    double ox = -ey * (h / d), oy = ex * (h / d);
+    *point1 = vector2_create(mx + ox, my + oy);
+    *point2 = vector2_create(mx - ox, my - oy);
+    return true;
+}
+static Vector* _intersection_pair(bool found, Vector2 point1, Vector2 point2)
+{
+    if (!found)
+        return NULL;
     Vector* intersections = vector_create(2);
     Vector2* intersection_point1 = malloc(sizeof(Vector2));
-    *intersection_point1 = vector2_add(p1, vector2_multiply(d, vector2_create(t1, t1)));
+    *intersection_point1 = point1;
     Vector2* intersection_point2 = malloc(sizeof(Vector2));
-    *intersection_point2 = vector2_add(p1, vector2_multiply(d, vector2_create(t2, t2)));
+    *intersection_point2 = point2;
     vector_push_back(intersections, intersection_point1);
     vector_push_back(intersections, intersection_point2);
     return intersections;
 }
-static Vector* _circle_circle_intersection(Circle* circle1, Circle* circle2)
+
+LineCircleBatch* line_circle_batch_create(void)
+{
+    LineCircleBatch* batch = (LineCircleBatch*)calloc(1, sizeof(LineCircleBatch));
+    if (batch == NULL)
+    {
+        printf("failed to allocate memory for the intersection batch\n");
+        exit(1);
+    }
+    return batch;
+}
+void line_circle_batch_destroy(LineCircleBatch* batch)
+{
+    if (batch == NULL)
+        return;
+    free(batch->point_x);
+    free(batch->point_y);
+    free(batch->direction_x);
+    free(batch->direction_y);
+    free(batch->center_x);
+    free(batch->center_y);
+    free(batch->radius);
+    free(batch->points);
+    free(batch->found);
+    free(batch);
+}
+void line_circle_batch_clear(LineCircleBatch* batch)
 {
-    double r0 = vector2_distance(circle1->center->coordinates, circle1->perimeter_point->coordinates);
-    double r1 = vector2_distance(circle2->center->coordinates, circle2->perimeter_point->coordinates);
-    double d = vector2_distance(circle1->center->coordinates, circle2->center->coordinates);
+    batch->count = 0;
+}
+void line_circle_batch_add(LineCircleBatch* batch, Vector2 point, Vector2 direction, Vector2 center, double radius)
+{
+    if (batch->count == batch->capacity)
+    {
+        batch->capacity = batch->capacity == 0 ? 64 : batch->capacity * 2;
+        size_t size = sizeof(double) * batch->capacity;
+        batch->point_x = _batch_reserve(batch->point_x, size, "intersection batch");
+        batch->point_y = _batch_reserve(batch->point_y, size, "intersection batch");
+        batch->direction_x = _batch_reserve(batch->direction_x, size, "intersection batch");
+        batch->direction_y = _batch_reserve(batch->direction_y, size, "intersection batch");
+        batch->center_x = _batch_reserve(batch->center_x, size, "intersection batch");
+        batch->center_y = _batch_reserve(batch->center_y, size, "intersection batch");
+        batch->radius = _batch_reserve(batch->radius, size, "intersection batch");
+        batch->points = _batch_reserve(batch->points, sizeof(Vector2) * 2 * batch->capacity, "intersection batch");
+        batch->found = _batch_reserve(batch->found, sizeof(bool) * batch->capacity, "intersection batch");
+    }
+    size_t i = batch->count++;
+    batch->point_x[i] = point.x;
+    batch->point_y[i] = point.y;
+    batch->direction_x[i] = direction.x;
+    batch->direction_y[i] = direction.y;
+    batch->center_x[i] = center.x;
+    batch->center_y[i] = center.y;
+    batch->radius[i] = radius;
+}
+void line_circle_batch_run(LineCircleBatch* batch)
+{
+    //the same operations as _line_circle_points in the same order, on INTERSECTION_BATCH_LANES pairs at a time
+    size_t i = 0;
+    for (; i + INTERSECTION_BATCH_LANES <= batch->count; i += INTERSECTION_BATCH_LANES)
+    {
+        Doublex4 px, py, dx, dy, cx, cy, radius;
+        memcpy(&px, batch->point_x + i, sizeof(Doublex4));
+        memcpy(&py, batch->point_y + i, sizeof(Doublex4));
+        memcpy(&dx, batch->direction_x + i, sizeof(Doublex4));
+        memcpy(&dy, batch->direction_y + i, sizeof(Doublex4));
+        memcpy(&cx, batch->center_x + i, sizeof(Doublex4));
+        memcpy(&cy, batch->center_y + i, sizeof(Doublex4));
+        memcpy(&radius, batch->radius + i, sizeof(Doublex4));
 
-    if (d > r0 + r1 || d < fabs(r0 - r1))
-        return NULL;
-    
-    double a = (r0 * r0 - r1 * r1 + d * d) / (2 * d);
-    double h = sqrt(r0 * r0 - a * a);
-    Vector2 p2 = vector2_add(circle1->center->coordinates, vector2_multiply(vector2_subtract(circle2->center->coordinates, circle1->center->coordinates), vector2_create(a / d, a / d)));
-    Vector2 po = vector2_multiply(vector2_rotate90(vector2_subtract(circle2->center->coordinates, circle1->center->coordinates)), vector2_create(h / d, h / d));
+        Doublex4 fx = px - cx, fy = py - cy;
+        Doublex4 a = dx * dx + dy * dy;
+        Doublex4 b = 2 * (fx * dx + fy * dy);
+        Doublex4 c = fx * fx + fy * fy - radius * radius;
+        Doublex4 discriminant = b * b - 4 * a * c;
+        Doublex4 root = discriminant;
+        _sqrt_lanes(&root);
+        Doublex4 t1 = (-b - root) / (2 * a);
+        Doublex4 t2 = (-b + root) / (2 * a);
+        Doublex4 x1 = px + dx * t1, y1 = py + dy * t1;
+        Doublex4 x2 = px + dx * t2, y2 = py + dy * t2;
+        for (int k = 0; k < INTERSECTION_BATCH_LANES; k++)
+        {
+            batch->found[i + k] = !(discriminant[k] < 0);
+            batch->points[2 * (i + k)] = vector2_create(x1[k], y1[k]);
+            batch->points[2 * (i + k) + 1] = vector2_create(x2[k], y2[k]);
+        }
+    }
+    for (; i < batch->count; i++)
+        batch->found[i] = _line_circle_points(batch->point_x[i], batch->point_y[i], batch->direction_x[i], batch->direction_y[i],
+                                              batch->center_x[i], batch->center_y[i], batch->radius[i], &batch->points[2 * i], &batch->points[2 * i + 1]);
+}
 
-    Vector2* intersection_point1 = malloc(sizeof(Vector2));
-    *intersection_point1 = vector2_add(p2, po);
-    Vector2* intersection_point2 = malloc(sizeof(Vector2));
-    *intersection_point2 = vector2_subtract(p2, po);
-    Vector* intersections = vector_create(2);
-    vector_push_back(intersections, intersection_point1);
-    vector_push_back(intersections, intersection_point2);
-    return intersections;
+CircleCircleBatch* circle_circle_batch_create(void)
+{
+    CircleCircleBatch* batch = (CircleCircleBatch*)calloc(1, sizeof(CircleCircleBatch));
+    if (batch == NULL)
+    {
+        printf("failed to allocate memory for the intersection batch\n");
+        exit(1);
+    }
+    return batch;
+}
+void circle_circle_batch_destroy(CircleCircleBatch* batch)
+{
+    if (batch == NULL)
+        return;
+    free(batch->center1_x);
+    free(batch->center1_y);
+    free(batch->radius1);
+    free(batch->center2_x);
+    free(batch->center2_y);
+    free(batch->radius2);
+    free(batch->points);
+    free(batch->found);
+    free(batch);
+}
+void circle_circle_batch_clear(CircleCircleBatch* batch)
+{
+    batch->count = 0;
+}
+void circle_circle_batch_add(CircleCircleBatch* batch, Vector2 center1, double radius1, Vector2 center2, double radius2)
+{
+    if (batch->count == batch->capacity)
+    {
+        batch->capacity = batch->capacity == 0 ? 64 : batch->capacity * 2;
+        size_t size = sizeof(double) * batch->capacity;
+        batch->center1_x = _batch_reserve(batch->center1_x, size, "intersection batch");
+        batch->center1_y = _batch_reserve(batch->center1_y, size, "intersection batch");
+        batch->radius1 = _batch_reserve(batch->radius1, size, "intersection batch");
+        batch->center2_x = _batch_reserve(batch->center2_x, size, "intersection batch");
+        batch->center2_y = _batch_reserve(batch->center2_y, size, "intersection batch");
+        batch->radius2 = _batch_reserve(batch->radius2, size, "intersection batch");
+        batch->points = _batch_reserve(batch->points, sizeof(Vector2) * 2 * batch->capacity, "intersection batch");
+        batch->found = _batch_reserve(batch->found, sizeof(bool) * batch->capacity, "intersection batch");
+    }
+    size_t i = batch->count++;
+    batch->center1_x[i] = center1.x;
+    batch->center1_y[i] = center1.y;
+    batch->radius1[i] = radius1;
+    batch->center2_x[i] = center2.x;
+    batch->center2_y[i] = center2.y;
+    batch->radius2[i] = radius2;
+}
+void circle_circle_batch_run(CircleCircleBatch* batch)
+{
+    //the same operations as _circle_circle_points in the same order, on INTERSECTION_BATCH_LANES pairs at a time
+    size_t i = 0;
+    for (; i + INTERSECTION_BATCH_LANES <= batch->count; i += INTERSECTION_BATCH_LANES)
+    {
+        Doublex4 x1, y1, radius1, x2, y2, radius2;
+        memcpy(&x1, batch->center1_x + i, sizeof(Doublex4));
+        memcpy(&y1, batch->center1_y + i, sizeof(Doublex4));
+        memcpy(&radius1, batch->radius1 + i, sizeof(Doublex4));
+        memcpy(&x2, batch->center2_x + i, sizeof(Doublex4));
+        memcpy(&y2, batch->center2_y + i, sizeof(Doublex4));
+        memcpy(&radius2, batch->radius2 + i, sizeof(Doublex4));
+
+        Doublex4 ex = x2 - x1, ey = y2 - y1;
+        Doublex4 d = ex * ex + ey * ey;
+        _sqrt_lanes(&d);
+        Doublex4 a = (radius1 * radius1 - radius2 * radius2 + d * d) / (2 * d);
+        Doublex4 h = radius1 * radius1 - a * a;
+        _sqrt_lanes(&h);
+        Doublex4 mx = x1 + ex * (a / d), my = y1 + ey * (a / d);
+        Doublex4 ox = -ey * (h / d), oy = ex * (h / d);
+        for (int k = 0; k < INTERSECTION_BATCH_LANES; k++)
+        {
+            batch->found[i + k] = !(d[k] > radius1[k] + radius2[k] || d[k] < radius1[k] - radius2[k] || d[k] < radius2[k] - radius1[k]);
+            batch->points[2 * (i + k)] = vector2_create(mx[k] + ox[k], my[k] + oy[k]);
+            batch->points[2 * (i + k) + 1] = vector2_create(mx[k] - ox[k], my[k] - oy[k]);
+        }
+    }
+    for (; i < batch->count; i++)
+        batch->found[i] = _circle_circle_points(batch->center1_x[i], batch->center1_y[i], batch->radius1[i], batch->center2_x[i], batch->center2_y[i], batch->radius2[i],
+                                                &batch->points[2 * i], &batch->points[2 * i + 1]);
+}
+
+static void _sqrt_lanes(Doublex4* values)
+{
+#ifdef __AVX__
+    *values = (Doublex4)_mm256_sqrt_pd((__m256d)*values);
+#elif defined(__SSE2__)
+    Doublex2 low = { (*values)[0], (*values)[1] };
+    Doublex2 high = { (*values)[2], (*values)[3] };
+    low = (Doublex2)_mm_sqrt_pd((__m128d)low);
+    high = (Doublex2)_mm_sqrt_pd((__m128d)high);
+    *values = (Doublex4){ low[0], low[1], high[0], high[1] };
+#else
+    for (int k = 0; k < 4; k++)
+        (*values)[k] = sqrt((*values)[k]);
+#endif
+}
+static void* _batch_reserve(void* array, size_t size, const char* name)
+{
+    void* reserved = realloc(array, size);
+    if (reserved == NULL)
+    {
+        printf("failed to allocate memory for the %s\n", name);
+        exit(1);
+    }
+    return reserved;
 }
 
 static bool _equals(double a, double b)
@@ -1,8 +1,56 @@
 #pragma once
 
+#include <stdbool.h>
+#include <stddef.h>
+
 #include "../shape/shape.h"
 #include "../../utils/vector/vector.h"
 
+#define INTERSECTION_BATCH_LANES 4
+
+/*
+ * The batch kernels intersect many line x circle or circle x circle pairs at once: the pairs are gathered into a structure of arrays,
+ * then the quadratic (discriminant, square root, the two points) is evaluated for INTERSECTION_BATCH_LANES pairs at a time in SIMD registers.
+ * Everything is in double precision, and a pair gives the same points as intersection_get.
+ */
+
+/**
+ * @brief Line x circle pairs as a structure of arrays (a point and the direction of the line, the center and the radius of the circle)
+ */
+typedef struct LineCircleBatch
+{
+    double* point_x;
+    double* point_y;
+    double* direction_x;
+    double* direction_y;
+    double* center_x;
+    double* center_y;
+    double* radius;
+    size_t count;
+    size_t capacity;
+
+    Vector2* points;
+    bool* found;
+} LineCircleBatch;
+
+/**
+ * @brief Circle x circle pairs as a structure of arrays (the centers and the radii of the circles)
+ */
+typedef struct CircleCircleBatch
+{
+    double* center1_x;
+    double* center1_y;
+    double* radius1;
+    double* center2_x;
+    double* center2_y;
+    double* radius2;
+    size_t count;
+    size_t capacity;
+
+    Vector2* points;
+    bool* found;
+} CircleCircleBatch;
+
 /**
  * @brief Returns the intersection(s) of two shapes
  * 
@@ -10,4 +58,73 @@
  * @param shape2 The second shape
  * @return Vector* The intersection vector, containing the intersection point(s) (should be freed!)
  */
-Vector* intersection_get(Shape* shape1, Shape* shape2);
\ No newline at end of file
+Vector* intersection_get(Shape* shape1, Shape* shape2);
+
+/**
+ * @brief Creates an empty batch of line x circle pairs
+ * 
+ * @return LineCircleBatch* The created batch
+ */
+LineCircleBatch* line_circle_batch_create(void);
+/**
+ * @brief Destroys a batch of line x circle pairs
+ * 
+ * @param batch The batch to destroy
+ */
+void line_circle_batch_destroy(LineCircleBatch* batch);
+/**
+ * @brief Removes the pairs of a batch (the memory is kept for the next pairs)
+ * 
+ * @param batch The batch to clear
+ */
+void line_circle_batch_clear(LineCircleBatch* batch);
+/**
+ * @brief Adds a line x circle pair to a batch
+ * 
+ * @param batch The batch
+ * @param point A point of the line
+ * @param direction The direction of the line (the vector between its two points)
+ * @param center The center of the circle
+ * @param radius The radius of the circle
+ */
+void line_circle_batch_add(LineCircleBatch* batch, Vector2 point, Vector2 direction, Vector2 center, double radius);
+/**
+ * @brief Intersects every pair of a batch: found[i] tells if pair i intersects, points[2 * i] and points[2 * i + 1] are its intersections
+ * 
+ * @param batch The batch
+ */
+void line_circle_batch_run(LineCircleBatch* batch);
+/**
+ * @brief Creates an empty batch of circle x circle pairs
+ * 
+ * @return CircleCircleBatch* The created batch
+ */
+CircleCircleBatch* circle_circle_batch_create(void);
+/**
+ * @brief Destroys a batch of circle x circle pairs
+ * 
+ * @param batch The batch to destroy
+ */
+void circle_circle_batch_destroy(CircleCircleBatch* batch);
+/**
+ * @brief Removes the pairs of a batch (the memory is kept for the next pairs)
+ * 
+ * @param batch The batch to clear
+ */
+void circle_circle_batch_clear(CircleCircleBatch* batch);
+/**
+ * @brief Adds a circle x circle pair to a batch
+ * 
+ * @param batch The batch
+ * @param center1 The center of the first circle
+ * @param radius1 The radius of the first circle
+ * @param center2 The center of the second circle
+ * @param radius2 The radius of the second circle
+ */
+void circle_circle_batch_add(CircleCircleBatch* batch, Vector2 center1, double radius1, Vector2 center2, double radius2);
+/**
+ * @brief Intersects every pair of a batch: found[i] tells if pair i intersects, points[2 * i] and points[2 * i + 1] are its intersections
+ * 
+ * @param batch The batch
+ */
+void circle_circle_batch_run(CircleCircleBatch* batch);
@@ -1,12 +1,13 @@
 #include "shape.h"
 
 #include "../coordinate_system/coordinate_system.h"
+#include "../clip/clip.h"
 #include "../../renderer/renderer.h"
-#include "../../input/input.h"
 
 #include <math.h>
 
 #define EPSILON 0.0001
+#define OUTLINE_PARALLEL_SINE 1e-6
 
 static void _point_draw(CoordinateSystem* cs, Shape* self);
 static void _line_draw(CoordinateSystem* cs, Shape* self);
@@ -16,13 +17,13 @@ static void _perpendicular_draw(CoordinateSystem* cs, Shape* self);
 static void _angle_bisector_draw(CoordinateSystem* cs, Shape* self);
 static void _tangent_draw(CoordinateSystem* cs, Shape* self);
 
-static void _point_translate(CoordinateSystem* cs, Shape* self, Vector2 translation);
-static void _line_translate(CoordinateSystem* cs, Shape* self, Vector2 translation);
-static void _circle_translate(CoordinateSystem* cs, Shape* self, Vector2 translation);
-static void _parallel_translate(CoordinateSystem* cs, Shape* self, Vector2 translation);
-static void _perpendicular_translate(CoordinateSystem* cs, Shape* self, Vector2 translation);
-static void _angle_bisector_translate(CoordinateSystem* cs, Shape* self, Vector2 translation);
-static void _tangent_translate(CoordinateSystem* cs, Shape* self, Vector2 translation);
+static int _point_get_drag_points(Shape* self, Shape** points);
+static int _line_get_drag_points(Shape* self, Shape** points);
+static int _circle_get_drag_points(Shape* self, Shape** points);
+static int _parallel_get_drag_points(Shape* self, Shape** points);
+static int _perpendicular_get_drag_points(Shape* self, Shape** points);
+static int _angle_bisector_get_drag_points(Shape* self, Shape** points);
+static int _tangent_get_drag_points(Shape* self, Shape** points);
 
 static void _point_destroy(CoordinateSystem* cs, Shape* self);
 static void _line_destroy(CoordinateSystem* cs, Shape* self);
@@ -48,16 +49,28 @@ static bool _perpendicular_is_defined_by(Shape* self, Shape* shape);
 static bool _angle_bisector_is_defined_by(Shape* self, Shape* shape);
 static bool _tangent_is_defined_by(Shape* self, Shape* shape);
 
+static void _point_get_outline(Shape* self, ShapeOutline* outline);
+static void _line_get_outline(Shape* self, ShapeOutline* outline);
+static void _circle_get_outline(Shape* self, ShapeOutline* outline);
+static void _parallel_get_outline(Shape* self, ShapeOutline* outline);
+static void _perpendicular_get_outline(Shape* self, ShapeOutline* outline);
+static void _angle_bisector_get_outline(Shape* self, ShapeOutline* outline);
+static void _tangent_get_outline(Shape* self, ShapeOutline* outline);
+
+static void _outline_add_point(ShapeOutline* outline, Point* point);
 static bool _equals(double a, double b);
 static Vector2 _line_line_intersection(Vector2 p0, Vector2 p1, Vector2 p2, Vector2 p3);
 static Vector* _circle_circle_intersection(Vector2 center1, double radius1, Vector2 center2, double radius2);
+static bool _circle_circle_intersection_points(Vector2 center1, double radius1, Vector2 center2, double radius2, Vector2* point1, Vector2* point2);
 static void _draw_line_on_screen(CoordinateSystem* cs, Vector2 p1, Vector2 p2, bool fixed, bool selected);
+static bool _line_overlap_on_screen(CoordinateSystem* cs, Vector2 p1, Vector2 p2, Vector2 point);
 
 ShapeDraw shape_draw_funcs[ST_COUNT] = {_point_draw, _line_draw, _circle_draw, _parallel_draw, _perpendicular_draw, _angle_bisector_draw, _tangent_draw};
-ShapeTranslate shape_translate_funcs[ST_COUNT] = {_point_translate, _line_translate, _circle_translate, _parallel_translate, _perpendicular_translate, _angle_bisector_translate, _tangent_translate};
+ShapeGetDragPoints shape_get_drag_points_funcs[ST_COUNT] = {_point_get_drag_points, _line_get_drag_points, _circle_get_drag_points, _parallel_get_drag_points, _perpendicular_get_drag_points, _angle_bisector_get_drag_points, _tangent_get_drag_points};
 ShapeDestroy shape_destroy_funcs[ST_COUNT] = {_point_destroy, _line_destroy, _circle_destroy, _parallel_destroy, _perpendicular_destroy, _angle_bisector_destroy, _tangent_destroy};
 ShapeOverlapPoint shape_overlap_point_funcs[ST_COUNT] = {_point_overlap, _line_overlap, _circle_overlap, _parallel_overlap, _perpendicular_overlap, _angle_bisector_overlap, _tangent_overlap};
 ShapeIsDefinedBy shape_is_defined_by_funcs[ST_COUNT] = {_point_is_defined_by, _line_is_defined_by, _circle_is_defined_by, _parallel_is_defined_by, _perpendicular_is_defined_by, _angle_bisector_is_defined_by, _tangent_is_defined_by};
+ShapeGetOutline shape_get_outline_funcs[ST_COUNT] = {_point_get_outline, _line_get_outline, _circle_get_outline, _parallel_get_outline, _perpendicular_get_outline, _angle_bisector_get_outline, _tangent_get_outline};
 
 Point* point_create(CoordinateSystem* cs, Vector2 coordinates)
 {
@@ -65,8 +78,12 @@ Point* point_create(CoordinateSystem* cs, Vector2 coordinates)
     point->base.type = ST_POINT;
     point->base.selected = false;
     point->base.dragged = false;
+    point->base.selected_slot = -1;
+    point->base.dragged_slot = -1;
+    point->base.save_index = -1;
     point->coordinates = coordinates;
     vector_push_back(cs->shapes, point);
+    spatial_index_insert(cs->index, (Shape*)point);
     return point;
 }
 Line* line_create(CoordinateSystem* cs, Point* p1, Point* p2)
@@ -75,9 +92,13 @@ Line* line_create(CoordinateSystem* cs, Point* p1, Point* p2)
     line->base.type = ST_LINE;
     line->base.selected = false;
     line->base.dragged = false;
+    line->base.selected_slot = -1;
+    line->base.dragged_slot = -1;
+    line->base.save_index = -1;
     line->p1 = p1;
     line->p2 = p2;
     vector_push_back(cs->shapes, line);
+    spatial_index_insert(cs->index, (Shape*)line);
     return line;
 }
 Circle* circle_create(CoordinateSystem* cs, Point* center, Point* perimeter_point)
@@ -86,9 +107,13 @@ Circle* circle_create(CoordinateSystem* cs, Point* center, Point* perimeter_poin
     circle->base.type = ST_CIRCLE;
     circle->base.selected = false;
     circle->base.dragged = false;
+    circle->base.selected_slot = -1;
+    circle->base.dragged_slot = -1;
+    circle->base.save_index = -1;
     circle->center = center;
     circle->perimeter_point = perimeter_point;
     vector_push_back(cs->shapes, circle);
+    spatial_index_insert(cs->index, (Shape*)circle);
     return circle;
 }
 Parallel* parallel_create(CoordinateSystem* cs, Line* line, Point* point)
@@ -97,9 +122,13 @@ Parallel* parallel_create(CoordinateSystem* cs, Line* line, Point* point)
     parallel->base.type = ST_PARALLEL;
     parallel->base.selected = false;
     parallel->base.dragged = false;
+    parallel->base.selected_slot = -1;
+    parallel->base.dragged_slot = -1;
+    parallel->base.save_index = -1;
     parallel->line = line;
     parallel->point = point;
     vector_push_back(cs->shapes, parallel);
+    spatial_index_insert(cs->index, (Shape*)parallel);
     return parallel;
 }
 Perpendicular* perpendicular_create(CoordinateSystem* cs, Line* line, Point* point)
@@ -108,9 +137,13 @@ Perpendicular* perpendicular_create(CoordinateSystem* cs, Line* line, Point* poi
     perpendicular->base.type = ST_PERPENDICULAR;
     perpendicular->base.selected = false;
     perpendicular->base.dragged = false;
+    perpendicular->base.selected_slot = -1;
+    perpendicular->base.dragged_slot = -1;
+    perpendicular->base.save_index = -1;
     perpendicular->line = line;
     perpendicular->point = point;
     vector_push_back(cs->shapes, perpendicular);
+    spatial_index_insert(cs->index, (Shape*)perpendicular);
     return perpendicular;
 }
 AngleBisector* angle_bisector_create(CoordinateSystem* cs, Line* line1, Line* line2)
@@ -119,9 +152,13 @@ AngleBisector* angle_bisector_create(CoordinateSystem* cs, Line* line1, Line* li
     angle_bisector->base.type = ST_ANGLE_BISECTOR;
     angle_bisector->base.selected = false;
     angle_bisector->base.dragged = false;
+    angle_bisector->base.selected_slot = -1;
+    angle_bisector->base.dragged_slot = -1;
+    angle_bisector->base.save_index = -1;
     angle_bisector->line1 = line1;
     angle_bisector->line2 = line2;
     vector_push_back(cs->shapes, angle_bisector);
+    spatial_index_insert(cs->index, (Shape*)angle_bisector);
     return angle_bisector;
 }
 Tangent* tangent_create(CoordinateSystem* cs, Circle* circle, Point* point)
@@ -130,9 +167,13 @@ Tangent* tangent_create(CoordinateSystem* cs, Circle* circle, Point* point)
     tangent->base.type = ST_TANGENT;
     tangent->base.selected = false;
     tangent->base.dragged = false;
+    tangent->base.selected_slot = -1;
+    tangent->base.dragged_slot = -1;
+    tangent->base.save_index = -1;
     tangent->circle = circle;
     tangent->point = point;
     vector_push_back(cs->shapes, tangent);
+    spatial_index_insert(cs->index, (Shape*)tangent);
     return tangent;
 }
 
@@ -140,17 +181,14 @@ void shape_draw(CoordinateSystem* cs, Shape* self)
 {
     shape_draw_funcs[self->type](cs, self);
 }
-void shape_update(CoordinateSystem* cs, Shape* self)
-{
-    if (self->dragged)
-        shape_translate(cs, self, vector2_from_point(input_get_mouse_motion()));
-}
-void shape_translate(CoordinateSystem* cs, Shape* self, Vector2 translation)
+int shape_get_drag_points(Shape* self, Shape** points)
 {
-    shape_translate_funcs[self->type](cs, self, translation);
+    return shape_get_drag_points_funcs[self->type](self, points);
 }
 void shape_destroy(CoordinateSystem* cs, Shape* self)
 {
+    _coordinate_system_release_shape(cs, self);
+    spatial_index_remove(cs->index, self);
     shape_destroy_funcs[self->type](cs, self);
 }
 bool shape_overlap_point(CoordinateSystem* cs, Shape* self, Vector2 point)
@@ -161,6 +199,13 @@ bool shape_is_defined_by(Shape* self, Shape* shape)
 {
     return shape_is_defined_by_funcs[self->type](self, shape);
 }
+void shape_get_outline(Shape* self, ShapeOutline* outline)
+{
+    outline->point_count = 0;
+    outline->line_count = 0;
+    outline->has_circle = false;
+    shape_get_outline_funcs[self->type](self, outline);
+}
 
 static void _point_destroy(CoordinateSystem* cs __attribute__((unused)), Shape* self)
 {
@@ -193,8 +238,10 @@ static void _tangent_destroy(CoordinateSystem* cs __attribute__((unused)), Shape
 
 static void _point_draw(CoordinateSystem* cs, Shape* self)
 {
-    Point* point = (Point*)self;
-    Vector2 position = coordinates_to_screen(cs, point->coordinates);
+    point_draw_at(self, coordinates_to_screen(cs, ((Point*)self)->coordinates));
+}
+void point_draw_at(Shape* self, Vector2 position)
+{
     if (self->selected)
         renderer_draw_filled_circle(position.x, position.y, 9, color_fade(BLACK, 0.3));
     renderer_draw_filled_circle(position.x, position.y, 5, GRAY);
@@ -272,38 +319,40 @@ static void _tangent_draw(CoordinateSystem* cs, Shape* self)
     vector_destroy(intersections);
 }
 
-static void _point_translate(CoordinateSystem* cs, Shape* self, Vector2 translation)
+static int _point_get_drag_points(Shape* self, Shape** points)
 {
-    Point* point = (Point*)self;
-    point->coordinates = screen_to_coordinates(cs, vector2_add(coordinates_to_screen(cs, point->coordinates), translation));
+    points[0] = self;
+    return 1;
 }
-static void _line_translate(CoordinateSystem* cs, Shape* self, Vector2 translation)
-{       
+static int _line_get_drag_points(Shape* self, Shape** points)
+{
     Line* line = (Line*)self;
-    if (!((Shape*)line->p1)->dragged) _point_translate(cs, (Shape*)line->p1, translation);
-    if (!((Shape*)line->p2)->dragged) _point_translate(cs, (Shape*)line->p2, translation);
+    points[0] = (Shape*)line->p1;
+    points[1] = (Shape*)line->p2;
+    return 2;
 }
-static void _circle_translate(CoordinateSystem* cs, Shape* self, Vector2 translation)
+static int _circle_get_drag_points(Shape* self, Shape** points)
 {
     Circle* circle = (Circle*)self;
-    if (!((Shape*)circle->center)->dragged) _point_translate(cs, (Shape*)circle->center, translation);
-    if (!((Shape*)circle->perimeter_point)->dragged) _point_translate(cs, (Shape*)circle->perimeter_point, translation);
+    points[0] = (Shape*)circle->center;
+    points[1] = (Shape*)circle->perimeter_point;
+    return 2;
 }
-static void _parallel_translate(CoordinateSystem* cs __attribute__((unused)), Shape* self __attribute__((unused)), Vector2 translation __attribute__((unused)))
+static int _parallel_get_drag_points(Shape* self __attribute__((unused)), Shape** points __attribute__((unused)))
 {
-    return;
+    return 0;
 }
-static void _perpendicular_translate(CoordinateSystem* cs __attribute__((unused)), Shape* self __attribute__((unused)), Vector2 translation __attribute__((unused)))
+static int _perpendicular_get_drag_points(Shape* self __attribute__((unused)), Shape** points __attribute__((unused)))
 {
-    return;
+    return 0;
 }
-static void _angle_bisector_translate(CoordinateSystem* cs __attribute__((unused)), Shape* self __attribute__((unused)), Vector2 translation __attribute__((unused)))
+static int _angle_bisector_get_drag_points(Shape* self __attribute__((unused)), Shape** points __attribute__((unused)))
 {
-    return;
+    return 0;
 }
-static void _tangent_translate(CoordinateSystem* cs __attribute__((unused)), Shape* self __attribute__((unused)), Vector2 translation __attribute__((unused)))
+static int _tangent_get_drag_points(Shape* self __attribute__((unused)), Shape** points __attribute__((unused)))
 {
-    return;
+    return 0;
 }
 
 static bool _point_overlap(CoordinateSystem* cs, Shape* self, Vector2 point)
@@ -313,10 +362,7 @@ static bool _point_overlap(CoordinateSystem* cs, Shape* self, Vector2 point)
 static bool _line_overlap(CoordinateSystem* cs, Shape* self, Vector2 point)
 {
     Line* line = (Line*)self;
-    Vector2 screen_normal = vector2_normalize(vector2_rotate90(vector2_subtract(coordinates_to_screen(cs, line->p2->coordinates), coordinates_to_screen(cs, line->p1->coordinates))));
-    return fabs(vector2_dot(screen_normal, point) - 
-                vector2_dot(screen_normal, coordinates_to_screen(cs, line->p1->coordinates))) 
-                <= vector2_length(screen_normal) * OVERLAP_DISTANCE;
+    return _line_overlap_on_screen(cs, coordinates_to_screen(cs, line->p1->coordinates), coordinates_to_screen(cs, line->p2->coordinates), point);
 }
 static bool _circle_overlap(CoordinateSystem* cs, Shape* self, Vector2 point)
 {
@@ -331,10 +377,7 @@ static bool _parallel_overlap(CoordinateSystem* cs, Shape* self, Vector2 point)
     Vector2 p2 = coordinates_to_screen(cs, parallel->line->p2->coordinates);
     Vector2 pp1 = coordinates_to_screen(cs, parallel->point->coordinates);
     Vector2 pp2 = vector2_add(p2, vector2_subtract(pp1, p1));
-    Vector2 screen_normal = vector2_normalize(vector2_rotate90(vector2_subtract(pp1, pp2)));
-    return fabs(vector2_dot(screen_normal, point) - 
-                vector2_dot(screen_normal, pp1))
-                <= vector2_length(screen_normal) * OVERLAP_DISTANCE;
+    return _line_overlap_on_screen(cs, pp1, pp2, point);
 }
 static bool _perpendicular_overlap(CoordinateSystem* cs, Shape* self, Vector2 point)
 {
@@ -344,12 +387,9 @@ static bool _perpendicular_overlap(CoordinateSystem* cs, Shape* self, Vector2 po
     Vector2 pp1 = coordinates_to_screen(cs, perpendicular->point->coordinates);
     Vector2 normal = vector2_rotate90(vector2_subtract(p2, p1));
     Vector2 pp2 = vector2_add(pp1, normal);
-    Vector2 screen_normal = vector2_normalize(vector2_rotate90(vector2_subtract(pp1, pp2)));
-    return fabs(vector2_dot(screen_normal, point) - 
-                vector2_dot(screen_normal, pp1))
-                <= vector2_length(screen_normal) * OVERLAP_DISTANCE;
+    return _line_overlap_on_screen(cs, pp1, pp2, point);
 }
-static bool _angle_bisector_overlap(CoordinateSystem* cs, Shape* self, Vector2 point __attribute__((unused)))
+static bool _angle_bisector_overlap(CoordinateSystem* cs, Shape* self, Vector2 point)
 {
     AngleBisector* angle_bisector = (AngleBisector*)self;
     if (angle_bisector->line1 == NULL || angle_bisector->line2 == NULL)
@@ -366,15 +406,7 @@ static bool _angle_bisector_overlap(CoordinateSystem* cs, Shape* self, Vector2 p
     Vector2 normal2 = vector2_rotate90(normal1);
     Vector2 m2 = vector2_add(m1, normal1);
     Vector2 m3 = vector2_add(m1, normal2);
-    Vector2 screen_normal1 = vector2_normalize(vector2_rotate90(vector2_subtract(m1, m2)));
-    Vector2 screen_normal2 = vector2_normalize(vector2_rotate90(vector2_subtract(m1, m3)));
-
-    return  fabs(vector2_dot(screen_normal1, point) - 
-                vector2_dot(screen_normal1, m1))
-                <= vector2_length(screen_normal1) * OVERLAP_DISTANCE ||
-            fabs(vector2_dot(screen_normal2, point) - 
-                vector2_dot(screen_normal2, m1))
-                <= vector2_length(screen_normal2) * OVERLAP_DISTANCE;
+    return _line_overlap_on_screen(cs, m1, m2, point) || _line_overlap_on_screen(cs, m1, m3, point);
 }
 static bool _tangent_overlap(CoordinateSystem* cs, Shape* self, Vector2 point)
 {
@@ -387,15 +419,10 @@ static bool _tangent_overlap(CoordinateSystem* cs, Shape* self, Vector2 point)
     Vector* intersections = _circle_circle_intersection(center, radius, center2, radius2);
     if (intersections == NULL)
         return false;
-    Vector2 screen_normal1 = vector2_normalize(vector2_rotate90(vector2_subtract(*(Vector2*)vector_get(intersections, 0), from)));
-    Vector2 screen_normal2 = vector2_normalize(vector2_rotate90(vector2_subtract(*(Vector2*)vector_get(intersections, 1), from)));
+    bool overlap = _line_overlap_on_screen(cs, from, *(Vector2*)vector_get(intersections, 0), point) ||
+                   _line_overlap_on_screen(cs, from, *(Vector2*)vector_get(intersections, 1), point);
     vector_destroy(intersections);
-    return  fabs(vector2_dot(screen_normal1, point) - 
-                vector2_dot(screen_normal1, from))
-                <= vector2_length(screen_normal1) * OVERLAP_DISTANCE ||
-            fabs(vector2_dot(screen_normal2, point) - 
-                vector2_dot(screen_normal2, from))
-                <= vector2_length(screen_normal2) * OVERLAP_DISTANCE;
+    return overlap;
 }
 
 static bool _point_is_defined_by(Shape* self __attribute__((unused)), Shape* shape __attribute__((unused)))
@@ -432,6 +459,112 @@ static bool _tangent_is_defined_by(Shape* self, Shape* shape)
     return (Shape*)tangent->circle == shape || (Shape*)tangent->point == shape;
 }
 
+static void _point_get_outline(Shape* self __attribute__((unused)), ShapeOutline* outline __attribute__((unused)))
+{
+    return;
+}
+static void _line_get_outline(Shape* self, ShapeOutline* outline)
+{
+    Line* line = (Line*)self;
+    _outline_add_point(outline, line->p1);
+    _outline_add_point(outline, line->p2);
+    outline->lines[0][0] = line->p1->coordinates;
+    outline->lines[0][1] = line->p2->coordinates;
+    outline->line_count = 1;
+}
+static void _circle_get_outline(Shape* self, ShapeOutline* outline)
+{
+    Circle* circle = (Circle*)self;
+    _outline_add_point(outline, circle->center);
+    _outline_add_point(outline, circle->perimeter_point);
+    outline->has_circle = true;
+    outline->center = circle->center->coordinates;
+    outline->radius = vector2_distance(circle->center->coordinates, circle->perimeter_point->coordinates);
+}
+static void _parallel_get_outline(Shape* self, ShapeOutline* outline)
+{
+    Parallel* parallel = (Parallel*)self;
+    _outline_add_point(outline, parallel->line->p1);
+    _outline_add_point(outline, parallel->line->p2);
+    _outline_add_point(outline, parallel->point);
+    Vector2 direction = vector2_subtract(parallel->line->p2->coordinates, parallel->line->p1->coordinates);
+    outline->lines[0][0] = parallel->point->coordinates;
+    outline->lines[0][1] = vector2_add(parallel->point->coordinates, direction);
+    outline->line_count = 1;
+}
+static void _perpendicular_get_outline(Shape* self, ShapeOutline* outline)
+{
+    Perpendicular* perpendicular = (Perpendicular*)self;
+    _outline_add_point(outline, perpendicular->line->p1);
+    _outline_add_point(outline, perpendicular->line->p2);
+    _outline_add_point(outline, perpendicular->point);
+    Vector2 normal = vector2_rotate90(vector2_subtract(perpendicular->line->p2->coordinates, perpendicular->line->p1->coordinates));
+    outline->lines[0][0] = perpendicular->point->coordinates;
+    outline->lines[0][1] = vector2_add(perpendicular->point->coordinates, normal);
+    outline->line_count = 1;
+}
+static void _angle_bisector_get_outline(Shape* self, ShapeOutline* outline)
+{
+    //the bisectors are the same lines in world space as on the screen, the transform only scales and mirrors
+    AngleBisector* angle_bisector = (AngleBisector*)self;
+    if (angle_bisector->line1 == NULL || angle_bisector->line2 == NULL)
+        return;
+    _outline_add_point(outline, angle_bisector->line1->p1);
+    _outline_add_point(outline, angle_bisector->line1->p2);
+    _outline_add_point(outline, angle_bisector->line2->p1);
+    _outline_add_point(outline, angle_bisector->line2->p2);
+    Vector2 p1 = angle_bisector->line1->p1->coordinates;
+    Vector2 p2 = angle_bisector->line1->p2->coordinates;
+    Vector2 p3 = angle_bisector->line2->p1->coordinates;
+    Vector2 p4 = angle_bisector->line2->p2->coordinates;
+    Vector2 direction1 = vector2_subtract(p2, p1);
+    Vector2 direction2 = vector2_subtract(p4, p3);
+    double denominator = vector2_cross(direction1, direction2);
+    if (fabs(denominator) <= OUTLINE_PARALLEL_SINE * vector2_length(direction1) * vector2_length(direction2))
+    {
+        //the intersection of (nearly) parallel lines is only noise, a degenerate line makes the index always test the bisector
+        outline->lines[0][0] = outline->lines[0][1] = p1;
+        outline->line_count = 1;
+        return;
+    }
+    Vector2 m1 = vector2_add(p1, vector2_scale(direction1, vector2_cross(vector2_subtract(p3, p1), direction2) / denominator));
+    double angle = vector2_angle(direction1) - vector2_angle(direction2);
+    Vector2 normal1 = vector2_rotate(direction1, -angle / 2);
+    Vector2 normal2 = vector2_rotate90(normal1);
+    outline->lines[0][0] = m1;
+    outline->lines[0][1] = vector2_add(m1, normal1);
+    outline->lines[1][0] = m1;
+    outline->lines[1][1] = vector2_add(m1, normal2);
+    outline->line_count = 2;
+}
+static void _tangent_get_outline(Shape* self, ShapeOutline* outline)
+{
+    Tangent* tangent = (Tangent*)self;
+    _outline_add_point(outline, tangent->circle->center);
+    _outline_add_point(outline, tangent->circle->perimeter_point);
+    _outline_add_point(outline, tangent->point);
+    Vector2 center = tangent->circle->center->coordinates;
+    Vector2 from = tangent->point->coordinates;
+    Vector2 center2 = vector2_scale(vector2_add(center, from), 0.5);
+    double radius = vector2_distance(center, tangent->circle->perimeter_point->coordinates);
+    double distance = vector2_distance(center, from);
+    outline->lines[0][0] = from;
+    outline->lines[1][0] = from;
+    if (fabs(distance - radius) <= OUTLINE_PARALLEL_SINE * (distance + radius))
+    {
+        //from a point on the circle the direction of the tangents is only rounding noise
+        outline->lines[0][1] = from;
+        outline->line_count = 1;
+        return;
+    }
+    if (_circle_circle_intersection_points(center, radius, center2, distance / 2, &outline->lines[0][1], &outline->lines[1][1]))
+        outline->line_count = 2;
+}
+
+static void _outline_add_point(ShapeOutline* outline, Point* point)
+{
+    outline->points[outline->point_count++] = (Shape*)point;
+}
 static bool _equals(double a, double b)
 {
     return fabs(a - b) < EPSILON;
@@ -468,78 +601,53 @@ static Vector2 _line_line_intersection(Vector2 p0, Vector2 p1, Vector2 p2, Vecto
 }
 static Vector* _circle_circle_intersection(Vector2 center1, double radius1, Vector2 center2, double radius2)
 {
-    double d = vector2_distance(center1, center2);
-    if (d > radius1 + radius2 || d < fabs(radius1 - radius2))
+    Vector2 point1, point2;
+    if (!_circle_circle_intersection_points(center1, radius1, center2, radius2, &point1, &point2))
         return NULL;
-    
-    double a = (radius1 * radius1 - radius2 * radius2 + d * d) / (2 * d);
-    double h = sqrt(radius1 * radius1 - a * a);
-    Vector2 p2 = vector2_add(center1, vector2_multiply(vector2_subtract(center2, center1), vector2_create(a / d, a / d)));
-    Vector2 po = vector2_multiply(vector2_rotate90(vector2_subtract(center2, center1)), vector2_create(h / d, h / d));
 
     Vector2* intersection_point1 = malloc(sizeof(Vector2));
-    *intersection_point1 = vector2_add(p2, po);
+    *intersection_point1 = point1;
     Vector2* intersection_point2 = malloc(sizeof(Vector2));
-    *intersection_point2 = vector2_subtract(p2, po);
+    *intersection_point2 = point2;
     Vector* intersections = vector_create(2);
     vector_push_back(intersections, intersection_point1);
     vector_push_back(intersections, intersection_point2);
     return intersections;
 }
+static bool _circle_circle_intersection_points(Vector2 center1, double radius1, Vector2 center2, double radius2, Vector2* point1, Vector2* point2)
+{
+    double d = vector2_distance(center1, center2);
+    if (d > radius1 + radius2 || d < fabs(radius1 - radius2))
+        return false;
+    
+    double a = (radius1 * radius1 - radius2 * radius2 + d * d) / (2 * d);
+    double h = sqrt(radius1 * radius1 - a * a);
+    Vector2 p2 = vector2_add(center1, vector2_multiply(vector2_subtract(center2, center1), vector2_create(a / d, a / d)));
+    Vector2 po = vector2_multiply(vector2_rotate90(vector2_subtract(center2, center1)), vector2_create(h / d, h / d));
+    *point1 = vector2_add(p2, po);
+    *point2 = vector2_subtract(p2, po);
+    return true;
+}
 static void _draw_line_on_screen(CoordinateSystem* cs, Vector2 p1, Vector2 p2, bool fixed, bool selected)
 {
-    Color color = fixed ? color_shift(BLACK, 150) : BLACK;
-    Color selected_color = color_fade(color, 0.3);
-    Vector2 m1 = _line_line_intersection((Vector2){ cs->position.x, cs->position.y }, (Vector2){ cs->position.x, cs->position.y + cs->size.y }, p1, p2);
-    Vector2 m2 = _line_line_intersection((Vector2){ cs->position.x, cs->position.y }, (Vector2){ cs->position.x + cs->size.x, cs->position.y },p1, p2);
-    if (!isnan(m1.x) && cs->position.y <= m1.y && m1.y <= cs->position.y + cs->size.y &&
-        !isnan(m2.x) && cs->position.x <= m2.x && m2.x <= cs->position.x + cs->size.x)
-    {
-        if (selected)
-            renderer_draw_line(m1.x, m1.y, m2.x, m2.y, 6, selected_color);
-        renderer_draw_line(m1.x, m1.y, m2.x, m2.y, 2, color);
+    Vector2 a, b;
+    if (!clip_line_to_rect(p1, p2, cs->position, vector2_add(cs->position, cs->size), &a, &b))
         return;
-    }
-    Vector2 m3 = _line_line_intersection((Vector2){ cs->position.x + cs->size.x, cs->position.y }, (Vector2){ cs->position.x + cs->size.x, cs->position.y + cs->size.y }, p1, p2);
-    if (!isnan(m1.x) && cs->position.y <= m1.y && m1.y <= cs->position.y + cs->size.y && 
-        !isnan(m3.x) && cs->position.y <= m3.y && m3.y <= cs->position.y + cs->size.y)
-    {
-        if (selected)
-            renderer_draw_line(m1.x, m1.y, m3.x, m3.y, 6, selected_color);
-        renderer_draw_line(m1.x, m1.y, m3.x, m3.y, 2, color);
-        return;
-    }
-    else if (!isnan(m2.x) && cs->position.x <= m2.x && m2.x <= cs->position.x + cs->size.x &&
-             !isnan(m3.x) && cs->position.y <= m3.y && m3.y <= cs->position.y + cs->size.y)
-    {
-        if (selected)
-            renderer_draw_line(m2.x, m2.y, m3.x, m3.y, 6, selected_color);
-        renderer_draw_line(m2.x, m2.y, m3.x, m3.y, 2, color);
-        return;
-    }
-    Vector2 m4 = _line_line_intersection((Vector2){ cs->position.x, cs->position.y + cs->size.y }, (Vector2){ cs->position.x + cs->size.x, cs->position.y + cs->size.y }, p1, p2);
-    if (!isnan(m1.x) && cs->position.y <= m1.y && m1.y <= cs->position.y + cs->size.y &&
-        !isnan(m4.x) && cs->position.x <= m4.x && m4.x <= cs->position.x + cs->size.x)
-    {
-        if (selected)
-            renderer_draw_line(m1.x, m1.y, m4.x, m4.y, 6, selected_color);
-        renderer_draw_line(m1.x, m1.y, m4.x, m4.y, 2, color);
-        return;
-    }
-    else if (!isnan(m2.x) && cs->position.x <= m2.x && m2.x <= cs->position.x + cs->size.x &&
-             !isnan(m4.x) && cs->position.x <= m4.x && m4.x <= cs->position.x + cs->size.x)
-    {
-        if (selected)
-            renderer_draw_line(m2.x, m2.y, m4.x, m4.y, 6, selected_color);
-        renderer_draw_line(m2.x, m2.y, m4.x, m4.y, 2, color);
-        return;
-    }
-    else if (!isnan(m3.x) && cs->position.y <= m3.y && m3.y <= cs->position.y + cs->size.y &&
-             !isnan(m4.x) && cs->position.x <= m4.x && m4.x <= cs->position.x + cs->size.x)
-    {
-        if (selected)
-            renderer_draw_line(m3.x, m3.y, m4.x, m4.y, 6, selected_color);
-        renderer_draw_line(m3.x, m3.y, m4.x, m4.y, 2, color);
-        return;
-    }
+    Color color = fixed ? color_shift(BLACK, 150) : BLACK;
+    if (selected)
+        renderer_draw_line(a.x, a.y, b.x, b.y, 6, color_fade(color, 0.3));
+    renderer_draw_line(a.x, a.y, b.x, b.y, 2, color);
+}
+static bool _line_overlap_on_screen(CoordinateSystem* cs, Vector2 p1, Vector2 p2, Vector2 point)
+{
+    //most lines are far from the point, the distance from the infinite line rejects them without clipping
+    Vector2 direction = vector2_subtract(p2, p1);
+    double cross = vector2_cross(direction, vector2_subtract(point, p1));
+    if (cross * cross > vector2_dot(direction, direction) * OVERLAP_DISTANCE * OVERLAP_DISTANCE)
+        return false;
+    //only the visible part of the line can be picked, the same segment that is drawn
+    Vector2 a, b;
+    if (!clip_line_to_rect(p1, p2, cs->position, vector2_add(cs->position, cs->size), &a, &b))
+        return false;
+    return segment_distance(point, a, b) <= OVERLAP_DISTANCE;
 }
\ No newline at end of file
@@ -5,15 +5,19 @@
 #include "../vector2/vector2.h"
 
 #define OVERLAP_DISTANCE 5
+#define SHAPE_OUTLINE_MAX_POINTS 4
+#define SHAPE_DRAG_MAX_POINTS 2
 
 typedef struct CoordinateSystem CoordinateSystem;
 typedef struct Shape Shape;
+typedef struct ShapeOutline ShapeOutline;
 
 typedef void (*ShapeDraw)(struct CoordinateSystem* cs, struct Shape* self);
-typedef void (*ShapeTranslate)(struct CoordinateSystem* cs, struct Shape* self, Vector2 translation);
+typedef int (*ShapeGetDragPoints)(struct Shape* self, struct Shape** points);
 typedef void (*ShapeDestroy)(struct CoordinateSystem* cs, struct Shape* self);
 typedef bool (*ShapeOverlapPoint)(struct CoordinateSystem* cs, struct Shape* self, Vector2 point);
 typedef bool (*ShapeIsDefinedBy)(struct Shape* self, struct Shape* shape);
+typedef void (*ShapeGetOutline)(struct Shape* self, struct ShapeOutline* outline);
 
 /**
  * @brief The types of shapes that can be created
@@ -40,8 +44,27 @@ typedef struct Shape
     ShapeType type;
     bool selected;
     bool dragged;
+    int spatial_slot;
+    int selected_slot;
+    int dragged_slot;
+    //the position of the shape in the shape list, written when a save starts (so the references are written in O(1))
+    int save_index;
 } Shape;
 
+/**
+ * @brief The outline of a shape in world space (the infinite lines and the circle it consists of, and the points it is calculated from)
+ */
+typedef struct ShapeOutline
+{
+    int point_count;
+    Shape* points[SHAPE_OUTLINE_MAX_POINTS];
+    int line_count;
+    Vector2 lines[2][2];
+    bool has_circle;
+    Vector2 center;
+    double radius;
+} ShapeOutline;
+
 /**
  * @brief The point struct
  */
@@ -181,20 +204,20 @@ Tangent* tangent_create(CoordinateSystem* cs, Circle* circle, Point* point);
  */
 void shape_draw(CoordinateSystem* cs, Shape* self);
 /**
- * @brief Updates a shape (can be called on any shape)
+ * @brief Draws a point at a position on the screen (for drawing points whose screen positions were converted in a batch)
  * 
- * @param cs The coordinate system to update the shape in
- * @param self The shape to update
+ * @param self The point to draw
+ * @param position The position of the point on the screen
  */
-void shape_update(CoordinateSystem* cs, Shape* self);
+void point_draw_at(Shape* self, Vector2 position);
 /**
- * @brief Translates a shape if it is allowed (can be called on any shape)
+ * @brief Returns the free points that move when the shape is dragged (can be called on any shape, the calculated shapes can't be dragged)
  * 
- * @param cs The coordinate system to translate the shape in
- * @param self The shape to translate
- * @param translation The translation vector
+ * @param self The dragged shape
+ * @param points The array receiving the points (at least SHAPE_DRAG_MAX_POINTS long)
+ * @return int The number of points
  */
-void shape_translate(CoordinateSystem* cs, Shape* self, Vector2 translation);
+int shape_get_drag_points(Shape* self, Shape** points);
 /**
  * @brief Destroys a shape, but does not remove it from the coordinate systems shapes! (can be called on any shape)
  * 
@@ -220,4 +243,11 @@ bool shape_overlap_point(CoordinateSystem* cs, Shape* self, Vector2 point);
  * @return true If the shape is defined by the other shape
  * @return false If the shape is not defined by the other shape
  */
-bool shape_is_defined_by(Shape* self, Shape* shape);
\ No newline at end of file
+bool shape_is_defined_by(Shape* self, Shape* shape);
+/**
+ * @brief Calculates the outline of a shape in world space, without transforming it to the screen (can be called on any shape)
+ * 
+ * @param self The shape
+ * @param outline The outline (a point has no lines, no circle and no points)
+ */
+void shape_get_outline(Shape* self, ShapeOutline* outline);
\ No newline at end of file
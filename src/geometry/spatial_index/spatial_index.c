@@ -0,0 +1,873 @@
+#include "spatial_index.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define SPATIAL_INDEX_MIN_CELLS 64
+#define SPATIAL_INDEX_MAX_CELL 1e15
+#define SPATIAL_INDEX_NEVER 1e300
+#define SPATIAL_INDEX_LEAF_EDGES 8
+
+static void* _spatial_index_grow(void* data, size_t size)
+{
+    void* grown = realloc(data, size);
+    if (grown == NULL)
+    {
+        printf("failed to allocate memory for the spatial index\n");
+        exit(1);
+    }
+    return grown;
+}
+static Sint64 _spatial_index_cell_coordinate(double value, double size)
+{
+    //far away (or undefined) points are clamped to the border cells, they are still found by a linear scan
+    double cell = floor(value / size);
+    if (!(cell >= -SPATIAL_INDEX_MAX_CELL))
+        cell = -SPATIAL_INDEX_MAX_CELL;
+    if (cell > SPATIAL_INDEX_MAX_CELL)
+        cell = SPATIAL_INDEX_MAX_CELL;
+    return (Sint64)cell;
+}
+static int _spatial_index_hash(SpatialIndexGrid* grid, Sint64 x, Sint64 y, int level)
+{
+    Uint64 hash = (Uint64)x * 0x9E3779B97F4A7C15ull ^ (Uint64)y * 0xC2B2AE3D27D4EB4Full ^ (Uint64)level * 0x165667B19E3779F9ull;
+    hash ^= hash >> 32;
+    return (int)(hash & (Uint64)(grid->capacity - 1));
+}
+static int _spatial_index_find_cell(SpatialIndexGrid* grid, Sint64 x, Sint64 y, int level)
+{
+    int slot = _spatial_index_hash(grid, x, y, level);
+    while (grid->cells[slot].used)
+    {
+        if (grid->cells[slot].x == x && grid->cells[slot].y == y && grid->cells[slot].level == level)
+            return slot;
+        slot = (slot + 1) & (grid->capacity - 1);
+    }
+    return -1;
+}
+static void _spatial_index_rehash(SpatialIndexGrid* grid)
+{
+    //the cells that became empty are dropped here, they only cost a probe until then
+    int non_empty = 0;
+    for (int i = 0; i < grid->capacity; i++)
+        if (grid->cells[i].used && grid->cells[i].head != -1)
+            non_empty++;
+    int capacity = SPATIAL_INDEX_MIN_CELLS;
+    while (capacity < non_empty * 4)
+        capacity *= 2;
+
+    SpatialIndexCell* old_cells = grid->cells;
+    int old_capacity = grid->capacity;
+    grid->cells = (SpatialIndexCell*)calloc(capacity, sizeof(SpatialIndexCell));
+    if (grid->cells == NULL)
+    {
+        printf("failed to allocate memory for the spatial index\n");
+        exit(1);
+    }
+    grid->capacity = capacity;
+    grid->count = non_empty;
+    for (int i = 0; i < old_capacity; i++)
+    {
+        if (!old_cells[i].used || old_cells[i].head == -1)
+            continue;
+        int slot = _spatial_index_hash(grid, old_cells[i].x, old_cells[i].y, old_cells[i].level);
+        while (grid->cells[slot].used)
+            slot = (slot + 1) & (capacity - 1);
+        grid->cells[slot] = old_cells[i];
+    }
+    free(old_cells);
+}
+static int _spatial_index_get_cell(SpatialIndexGrid* grid, Sint64 x, Sint64 y, int level)
+{
+    int slot = _spatial_index_find_cell(grid, x, y, level);
+    if (slot != -1)
+        return slot;
+    if ((grid->count + 1) * 2 > grid->capacity)
+        _spatial_index_rehash(grid);
+    slot = _spatial_index_hash(grid, x, y, level);
+    while (grid->cells[slot].used)
+        slot = (slot + 1) & (grid->capacity - 1);
+    grid->cells[slot] = (SpatialIndexCell){ x, y, level, -1, true };
+    grid->count++;
+    return slot;
+}
+static double _spatial_index_level_size(int level)
+{
+    return ldexp(SPATIAL_INDEX_CELL_SIZE, level);
+}
+static int _spatial_index_circle_level(double x, double y, double radius)
+{
+    //the circles too large or too far away for the grid (and the other curves) get -1, they are scanned by every query
+    if (!(radius >= 0.0) || !isfinite(radius) || !isfinite(x) || !isfinite(y))
+        return -1;
+    int level;
+    frexp(2.0 * radius / SPATIAL_INDEX_CELL_SIZE, &level);
+    level = SDL_max(level, 0);
+    if (level >= SPATIAL_INDEX_LEVELS)
+        return -1;
+    double size = _spatial_index_level_size(level);
+    if (fabs(x) / size >= SPATIAL_INDEX_MAX_CELL || fabs(y) / size >= SPATIAL_INDEX_MAX_CELL)
+        return -1;
+    return level;
+}
+static double _spatial_index_cell_range(Vector2 min, Vector2 max, double size, Sint64 range[4])
+{
+    //the cells covering a box (min x, max x, min y, max y), the number of the cells is returned as a double, it can be huge
+    range[0] = _spatial_index_cell_coordinate(min.x, size);
+    range[1] = _spatial_index_cell_coordinate(max.x, size);
+    range[2] = _spatial_index_cell_coordinate(min.y, size);
+    range[3] = _spatial_index_cell_coordinate(max.y, size);
+    return ((double)range[1] - (double)range[0] + 1.0) * ((double)range[3] - (double)range[2] + 1.0);
+}
+static int* _spatial_index_point_head(SpatialIndex* index, Vector2 position, bool create)
+{
+    Sint64 x = _spatial_index_cell_coordinate(position.x, SPATIAL_INDEX_CELL_SIZE);
+    Sint64 y = _spatial_index_cell_coordinate(position.y, SPATIAL_INDEX_CELL_SIZE);
+    int cell = create ? _spatial_index_get_cell(&index->point_grid, x, y, 0) : _spatial_index_find_cell(&index->point_grid, x, y, 0);
+    return &index->point_grid.cells[cell].head;
+}
+static int* _spatial_index_circle_head(SpatialIndex* index, int i, bool create)
+{
+    int level = index->curve_levels[i];
+    double size = _spatial_index_level_size(level);
+    Sint64 x = _spatial_index_cell_coordinate(index->circle_x[i], size);
+    Sint64 y = _spatial_index_cell_coordinate(index->circle_y[i], size);
+    int cell = create ? _spatial_index_get_cell(&index->circle_grid, x, y, level) : _spatial_index_find_cell(&index->circle_grid, x, y, level);
+    return &index->circle_grid.cells[cell].head;
+}
+
+static void _spatial_index_link_point(SpatialIndex* index, int i)
+{
+    int* head = _spatial_index_point_head(index, index->point_positions[i], true);
+    index->point_previous[i] = -1;
+    index->point_next[i] = *head;
+    if (*head != -1)
+        index->point_previous[*head] = i;
+    *head = i;
+}
+static void _spatial_index_unlink_point(SpatialIndex* index, int i)
+{
+    int previous = index->point_previous[i], next = index->point_next[i];
+    if (previous != -1)
+        index->point_next[previous] = next;
+    else
+        *_spatial_index_point_head(index, index->point_positions[i], false) = next;
+    if (next != -1)
+        index->point_previous[next] = previous;
+}
+static void _spatial_index_forget_point(SpatialIndex* index, Shape* curve, Shape* point)
+{
+    Shape** points = &index->curve_points[curve->spatial_slot * SHAPE_OUTLINE_MAX_POINTS];
+    int count = 0;
+    for (int k = 0; k < SHAPE_OUTLINE_MAX_POINTS; k++)
+        if (points[k] != point)
+            points[count++] = points[k];
+    while (count < SHAPE_OUTLINE_MAX_POINTS)
+        points[count++] = NULL;
+}
+static void _spatial_index_insert_point(SpatialIndex* index, Shape* shape)
+{
+    if (index->point_count == index->point_capacity)
+    {
+        index->point_capacity = index->point_capacity == 0 ? 64 : index->point_capacity * 2;
+        size_t capacity = (size_t)index->point_capacity;
+        index->points = (Shape**)_spatial_index_grow(index->points, sizeof(Shape*) * capacity);
+        index->point_positions = (Vector2*)_spatial_index_grow(index->point_positions, sizeof(Vector2) * capacity);
+        index->point_orders = (int*)_spatial_index_grow(index->point_orders, sizeof(int) * capacity);
+        index->point_next = (int*)_spatial_index_grow(index->point_next, sizeof(int) * capacity);
+        index->point_previous = (int*)_spatial_index_grow(index->point_previous, sizeof(int) * capacity);
+        index->point_dependents = (int*)_spatial_index_grow(index->point_dependents, sizeof(int) * capacity);
+    }
+    int i = index->point_count++;
+    index->points[i] = shape;
+    index->point_positions[i] = ((Point*)shape)->coordinates;
+    index->point_orders[i] = index->next_order++;
+    index->point_dependents[i] = -1;
+    shape->spatial_slot = i;
+    _spatial_index_link_point(index, i);
+}
+static void _spatial_index_remove_point(SpatialIndex* index, int i)
+{
+    //the shapes calculated from the point are removed right after it (when it is already freed), so they forget it now
+    while (index->point_dependents[i] != -1)
+    {
+        int node = index->point_dependents[i];
+        _spatial_index_forget_point(index, index->dependents[node], index->points[i]);
+        index->point_dependents[i] = index->dependent_next[node];
+        index->dependent_next[node] = index->free_dependent;
+        index->free_dependent = node;
+    }
+    _spatial_index_unlink_point(index, i);
+    int last = --index->point_count;
+    if (i == last)
+        return;
+    //the last point fills the hole, the links pointing to it are redirected
+    index->points[i] = index->points[last];
+    index->point_positions[i] = index->point_positions[last];
+    index->point_orders[i] = index->point_orders[last];
+    index->point_next[i] = index->point_next[last];
+    index->point_previous[i] = index->point_previous[last];
+    index->point_dependents[i] = index->point_dependents[last];
+    if (index->point_previous[i] != -1)
+        index->point_next[index->point_previous[i]] = i;
+    else
+        *_spatial_index_point_head(index, index->point_positions[i], false) = i;
+    if (index->point_next[i] != -1)
+        index->point_previous[index->point_next[i]] = i;
+    index->points[i]->spatial_slot = i;
+}
+
+static void _spatial_index_add_dependent(SpatialIndex* index, Shape* point, Shape* curve)
+{
+    if (point->spatial_slot == -1)
+        return;
+    int node = index->free_dependent;
+    if (node != -1)
+        index->free_dependent = index->dependent_next[node];
+    else
+    {
+        if (index->dependent_count == index->dependent_capacity)
+        {
+            index->dependent_capacity = index->dependent_capacity == 0 ? 256 : index->dependent_capacity * 2;
+            index->dependents = (Shape**)_spatial_index_grow(index->dependents, sizeof(Shape*) * index->dependent_capacity);
+            index->dependent_next = (int*)_spatial_index_grow(index->dependent_next, sizeof(int) * index->dependent_capacity);
+        }
+        node = index->dependent_count++;
+    }
+    index->dependents[node] = curve;
+    index->dependent_next[node] = index->point_dependents[point->spatial_slot];
+    index->point_dependents[point->spatial_slot] = node;
+}
+static void _spatial_index_remove_dependent(SpatialIndex* index, Shape* point, Shape* curve)
+{
+    if (point->spatial_slot == -1)
+        return;
+    int* link = &index->point_dependents[point->spatial_slot];
+    while (*link != -1)
+    {
+        int node = *link;
+        if (index->dependents[node] == curve)
+        {
+            *link = index->dependent_next[node];
+            index->dependent_next[node] = index->free_dependent;
+            index->free_dependent = node;
+            return;
+        }
+        link = &index->dependent_next[node];
+    }
+}
+
+static void _spatial_index_update_curve(SpatialIndex* index, int i)
+{
+    ShapeOutline outline;
+    shape_get_outline(index->curves[i], &outline);
+    for (int k = 0; k < SHAPE_OUTLINE_MAX_POINTS; k++)
+        index->curve_points[i * SHAPE_OUTLINE_MAX_POINTS + k] = k < outline.point_count ? outline.points[k] : NULL;
+    for (int k = 0; k < 2; k++)
+    {
+        //an unused line never matches, a degenerate one always does (the exact test decides)
+        double normal_x = 0.0, normal_y = 0.0, offset = SPATIAL_INDEX_NEVER;
+        if (k < outline.line_count)
+        {
+            Vector2 a = outline.lines[k][0];
+            Vector2 direction = vector2_subtract(outline.lines[k][1], a);
+            double length = vector2_length(direction);
+            normal_x = -direction.y / length;
+            normal_y = direction.x / length;
+            offset = normal_x * a.x + normal_y * a.y;
+            if (!isfinite(offset) || !isfinite(normal_x) || !isfinite(normal_y))
+                normal_x = normal_y = offset = 0.0;
+        }
+        index->line_normal_x[k][i] = normal_x;
+        index->line_normal_y[k][i] = normal_y;
+        index->line_offset[k][i] = offset;
+    }
+    index->circle_x[i] = outline.has_circle ? outline.center.x : 0.0;
+    index->circle_y[i] = outline.has_circle ? outline.center.y : 0.0;
+    index->circle_radius[i] = outline.has_circle ? outline.radius : -SPATIAL_INDEX_NEVER;
+}
+static void _spatial_index_link_curve(SpatialIndex* index, int i)
+{
+    int level = _spatial_index_circle_level(index->circle_x[i], index->circle_y[i], index->circle_radius[i]);
+    index->curve_levels[i] = level;
+    if (level == -1)
+    {
+        index->curve_unbounded_slots[i] = index->unbounded_count;
+        index->unbounded_curves[index->unbounded_count++] = i;
+        return;
+    }
+    index->circle_level_counts[level]++;
+    index->circle_count++;
+    int* head = _spatial_index_circle_head(index, i, true);
+    index->curve_previous[i] = -1;
+    index->curve_next[i] = *head;
+    if (*head != -1)
+        index->curve_previous[*head] = i;
+    *head = i;
+}
+static void _spatial_index_unlink_curve(SpatialIndex* index, int i)
+{
+    if (index->curve_levels[i] == -1)
+    {
+        int slot = index->curve_unbounded_slots[i];
+        index->unbounded_curves[slot] = index->unbounded_curves[--index->unbounded_count];
+        index->curve_unbounded_slots[index->unbounded_curves[slot]] = slot;
+        return;
+    }
+    int previous = index->curve_previous[i], next = index->curve_next[i];
+    if (previous != -1)
+        index->curve_next[previous] = next;
+    else
+        *_spatial_index_circle_head(index, i, false) = next;
+    if (next != -1)
+        index->curve_previous[next] = previous;
+    index->circle_level_counts[index->curve_levels[i]]--;
+    index->circle_count--;
+}
+static void _spatial_index_refresh_curve(SpatialIndex* index, int i)
+{
+    //the cell of a circle is found from its stored outline, so it is unlinked before the outline changes
+    _spatial_index_unlink_curve(index, i);
+    _spatial_index_update_curve(index, i);
+    _spatial_index_link_curve(index, i);
+}
+static void _spatial_index_insert_curve(SpatialIndex* index, Shape* shape)
+{
+    if (index->curve_count == index->curve_capacity)
+    {
+        index->curve_capacity = index->curve_capacity == 0 ? 64 : index->curve_capacity * 2;
+        size_t capacity = (size_t)index->curve_capacity;
+        index->curves = (Shape**)_spatial_index_grow(index->curves, sizeof(Shape*) * capacity);
+        index->curve_orders = (int*)_spatial_index_grow(index->curve_orders, sizeof(int) * capacity);
+        index->curve_points = (Shape**)_spatial_index_grow(index->curve_points, sizeof(Shape*) * SHAPE_OUTLINE_MAX_POINTS * capacity);
+        index->curve_moved = (int*)_spatial_index_grow(index->curve_moved, sizeof(int) * capacity);
+        index->curve_levels = (int*)_spatial_index_grow(index->curve_levels, sizeof(int) * capacity);
+        index->curve_next = (int*)_spatial_index_grow(index->curve_next, sizeof(int) * capacity);
+        index->curve_previous = (int*)_spatial_index_grow(index->curve_previous, sizeof(int) * capacity);
+        index->curve_unbounded_slots = (int*)_spatial_index_grow(index->curve_unbounded_slots, sizeof(int) * capacity);
+        index->circle_candidates = (int*)_spatial_index_grow(index->circle_candidates, sizeof(int) * capacity);
+        index->unbounded_curves = (int*)_spatial_index_grow(index->unbounded_curves, sizeof(int) * capacity);
+        index->moved_curves = (int*)_spatial_index_grow(index->moved_curves, sizeof(int) * capacity);
+        for (int k = 0; k < 2; k++)
+        {
+            index->line_normal_x[k] = (double*)_spatial_index_grow(index->line_normal_x[k], sizeof(double) * capacity);
+            index->line_normal_y[k] = (double*)_spatial_index_grow(index->line_normal_y[k], sizeof(double) * capacity);
+            index->line_offset[k] = (double*)_spatial_index_grow(index->line_offset[k], sizeof(double) * capacity);
+        }
+        index->circle_x = (double*)_spatial_index_grow(index->circle_x, sizeof(double) * capacity);
+        index->circle_y = (double*)_spatial_index_grow(index->circle_y, sizeof(double) * capacity);
+        index->circle_radius = (double*)_spatial_index_grow(index->circle_radius, sizeof(double) * capacity);
+    }
+    int i = index->curve_count++;
+    index->curves[i] = shape;
+    index->curve_orders[i] = index->next_order++;
+    index->curve_moved[i] = -1;
+    shape->spatial_slot = i;
+    _spatial_index_update_curve(index, i);
+    _spatial_index_link_curve(index, i);
+    for (int k = 0; k < SHAPE_OUTLINE_MAX_POINTS && index->curve_points[i * SHAPE_OUTLINE_MAX_POINTS + k] != NULL; k++)
+        _spatial_index_add_dependent(index, index->curve_points[i * SHAPE_OUTLINE_MAX_POINTS + k], shape);
+}
+static void _spatial_index_remove_curve(SpatialIndex* index, int i)
+{
+    for (int k = 0; k < SHAPE_OUTLINE_MAX_POINTS && index->curve_points[i * SHAPE_OUTLINE_MAX_POINTS + k] != NULL; k++)
+        _spatial_index_remove_dependent(index, index->curve_points[i * SHAPE_OUTLINE_MAX_POINTS + k], index->curves[i]);
+    if (index->curve_moved[i] != -1)
+    {
+        int moved = index->curve_moved[i];
+        index->moved_curves[moved] = index->moved_curves[--index->moved_count];
+        index->curve_moved[index->moved_curves[moved]] = moved;
+    }
+    _spatial_index_unlink_curve(index, i);
+    int last = --index->curve_count;
+    if (i == last)
+        return;
+    //the last curve fills the hole, the links pointing to it are redirected
+    index->curves[i] = index->curves[last];
+    index->curve_orders[i] = index->curve_orders[last];
+    index->curve_moved[i] = index->curve_moved[last];
+    index->curve_levels[i] = index->curve_levels[last];
+    index->curve_next[i] = index->curve_next[last];
+    index->curve_previous[i] = index->curve_previous[last];
+    index->curve_unbounded_slots[i] = index->curve_unbounded_slots[last];
+    for (int k = 0; k < SHAPE_OUTLINE_MAX_POINTS; k++)
+        index->curve_points[i * SHAPE_OUTLINE_MAX_POINTS + k] = index->curve_points[last * SHAPE_OUTLINE_MAX_POINTS + k];
+    for (int k = 0; k < 2; k++)
+    {
+        index->line_normal_x[k][i] = index->line_normal_x[k][last];
+        index->line_normal_y[k][i] = index->line_normal_y[k][last];
+        index->line_offset[k][i] = index->line_offset[k][last];
+    }
+    index->circle_x[i] = index->circle_x[last];
+    index->circle_y[i] = index->circle_y[last];
+    index->circle_radius[i] = index->circle_radius[last];
+    if (index->curve_moved[i] != -1)
+        index->moved_curves[index->curve_moved[i]] = i;
+    if (index->curve_levels[i] == -1)
+        index->unbounded_curves[index->curve_unbounded_slots[i]] = i;
+    else
+    {
+        if (index->curve_previous[i] != -1)
+            index->curve_next[index->curve_previous[i]] = i;
+        else
+            *_spatial_index_circle_head(index, i, false) = i;
+        if (index->curve_next[i] != -1)
+            index->curve_previous[index->curve_next[i]] = i;
+    }
+    index->curves[i]->spatial_slot = i;
+}
+
+static void _spatial_index_move_point(SpatialIndex* index, Shape* shape)
+{
+    if (shape->spatial_slot == -1 || shape->type != ST_POINT)
+        return;
+    int i = shape->spatial_slot;
+    Vector2 position = ((Point*)shape)->coordinates;
+    Vector2 previous_position = index->point_positions[i];
+    if (_spatial_index_cell_coordinate(position.x, SPATIAL_INDEX_CELL_SIZE) != _spatial_index_cell_coordinate(previous_position.x, SPATIAL_INDEX_CELL_SIZE) ||
+        _spatial_index_cell_coordinate(position.y, SPATIAL_INDEX_CELL_SIZE) != _spatial_index_cell_coordinate(previous_position.y, SPATIAL_INDEX_CELL_SIZE))
+    {
+        _spatial_index_unlink_point(index, i);
+        index->point_positions[i] = position;
+        _spatial_index_link_point(index, i);
+    }
+    else
+        index->point_positions[i] = position;
+    for (int node = index->point_dependents[i]; node != -1; node = index->dependent_next[node])
+    {
+        int curve = index->dependents[node]->spatial_slot;
+        if (index->curve_moved[curve] != -1)
+            continue;
+        index->curve_moved[curve] = index->moved_count;
+        index->moved_curves[index->moved_count++] = curve;
+    }
+}
+static void _spatial_index_update_moved_curves(SpatialIndex* index)
+{
+    for (int k = 0; k < index->moved_count; k++)
+    {
+        int i = index->moved_curves[k];
+        _spatial_index_refresh_curve(index, i);
+        index->curve_moved[i] = -1;
+    }
+    index->moved_count = 0;
+}
+//the edges of a region polygon in a bounding box hierarchy (node i covers a range of consecutive edges, its children split it in half),
+//a lasso is drawn continuously, so consecutive edges are close to each other and most nodes can be accepted or rejected as a whole
+typedef struct _SpatialPolygon
+{
+    const Vector2* vertices;
+    int vertex_count;
+    Vector2* min;
+    Vector2* max;
+} _SpatialPolygon;
+
+static void _spatial_polygon_build(_SpatialPolygon* polygon, int node, int first, int last)
+{
+    //the node covers the edges first..last-1, i.e. the vertices first..last
+    Vector2 min = polygon->vertices[first], max = min;
+    for (int i = first + 1; i <= last; i++)
+    {
+        Vector2 vertex = polygon->vertices[i % polygon->vertex_count];
+        min = vector2_create(fmin(min.x, vertex.x), fmin(min.y, vertex.y));
+        max = vector2_create(fmax(max.x, vertex.x), fmax(max.y, vertex.y));
+    }
+    polygon->min[node] = min;
+    polygon->max[node] = max;
+    if (last - first > SPATIAL_INDEX_LEAF_EDGES)
+    {
+        int middle = (first + last) / 2;
+        _spatial_polygon_build(polygon, 2 * node + 1, first, middle);
+        _spatial_polygon_build(polygon, 2 * node + 2, middle, last);
+    }
+}
+static int _spatial_polygon_crossings(_SpatialPolygon* polygon, int node, int first, int last, Vector2 point)
+{
+    //the number of edges crossing the ray from the point to the right
+    if (point.y < polygon->min[node].y || point.y > polygon->max[node].y || point.x > polygon->max[node].x)
+        return 0;
+    if (last - first > SPATIAL_INDEX_LEAF_EDGES)
+    {
+        int middle = (first + last) / 2;
+        return _spatial_polygon_crossings(polygon, 2 * node + 1, first, middle, point) + _spatial_polygon_crossings(polygon, 2 * node + 2, middle, last, point);
+    }
+    int crossings = 0;
+    for (int e = first; e < last; e++)
+    {
+        Vector2 a = polygon->vertices[e], b = polygon->vertices[(e + 1) % polygon->vertex_count];
+        if ((a.y > point.y) != (b.y > point.y) && point.x < (b.x - a.x) * (point.y - a.y) / (b.y - a.y) + a.x)
+            crossings++;
+    }
+    return crossings;
+}
+static bool _spatial_polygon_contains(_SpatialPolygon* polygon, Vector2 point)
+{
+    return _spatial_polygon_crossings(polygon, 0, 0, polygon->vertex_count, point) % 2 == 1;
+}
+static int _spatial_polygon_line_sides(_SpatialPolygon* polygon, int node, int first, int last, double normal_x, double normal_y, double offset, int sides)
+{
+    //bit 1: a vertex is on the negative side of the line, bit 2: on the positive side
+    Vector2 min = polygon->min[node], max = polygon->max[node];
+    double near = fmin(normal_x * min.x, normal_x * max.x) + fmin(normal_y * min.y, normal_y * max.y) - offset;
+    double far = fmax(normal_x * min.x, normal_x * max.x) + fmax(normal_y * min.y, normal_y * max.y) - offset;
+    if (near > 0.0)
+        return sides | 2;
+    if (far < 0.0)
+        return sides | 1;
+    if (last - first > SPATIAL_INDEX_LEAF_EDGES)
+    {
+        int middle = (first + last) / 2;
+        sides = _spatial_polygon_line_sides(polygon, 2 * node + 1, first, middle, normal_x, normal_y, offset, sides);
+        if (sides == 3)
+            return sides;
+        return _spatial_polygon_line_sides(polygon, 2 * node + 2, middle, last, normal_x, normal_y, offset, sides);
+    }
+    for (int i = first; i <= last && sides != 3; i++)
+    {
+        Vector2 vertex = polygon->vertices[i % polygon->vertex_count];
+        double side = normal_x * vertex.x + normal_y * vertex.y - offset;
+        if (side <= 0.0)
+            sides |= 1;
+        if (side >= 0.0)
+            sides |= 2;
+    }
+    return sides;
+}
+static bool _spatial_polygon_crosses_circle(_SpatialPolygon* polygon, int node, int first, int last, Vector2 center, double radius_squared)
+{
+    //an edge crosses the circle if its closest point is inside and its farther end is outside (squared distances, no roots)
+    Vector2 min = polygon->min[node], max = polygon->max[node];
+    double near_x = fmax(fmax(min.x - center.x, center.x - max.x), 0.0), near_y = fmax(fmax(min.y - center.y, center.y - max.y), 0.0);
+    double far_x = fmax(center.x - min.x, max.x - center.x), far_y = fmax(center.y - min.y, max.y - center.y);
+    if (near_x * near_x + near_y * near_y > radius_squared || far_x * far_x + far_y * far_y < radius_squared)
+        return false;
+    if (last - first > SPATIAL_INDEX_LEAF_EDGES)
+    {
+        int middle = (first + last) / 2;
+        return _spatial_polygon_crosses_circle(polygon, 2 * node + 1, first, middle, center, radius_squared) ||
+               _spatial_polygon_crosses_circle(polygon, 2 * node + 2, middle, last, center, radius_squared);
+    }
+    for (int e = first; e < last; e++)
+    {
+        Vector2 a = vector2_subtract(polygon->vertices[e], center);
+        Vector2 b = vector2_subtract(polygon->vertices[(e + 1) % polygon->vertex_count], center);
+        if (fmax(vector2_dot(a, a), vector2_dot(b, b)) < radius_squared)
+            continue;
+        Vector2 edge = vector2_subtract(b, a);
+        double length_squared = vector2_dot(edge, edge);
+        double t = length_squared > 0.0 ? fmin(fmax(-vector2_dot(a, edge) / length_squared, 0.0), 1.0) : 0.0;
+        Vector2 closest = vector2_add(a, vector2_scale(edge, t));
+        if (vector2_dot(closest, closest) <= radius_squared)
+            return true;
+    }
+    return false;
+}
+
+static bool _spatial_index_pick_point(SpatialIndex* index, int i, Vector2 position, double tolerance, SpatialIndexFilter filter, void* data, int* best)
+{
+    if (index->point_orders[i] >= *best || vector2_distance(index->point_positions[i], position) > tolerance)
+        return false;
+    if (!filter(index->points[i], data))
+        return false;
+    *best = index->point_orders[i];
+    return true;
+}
+static int _spatial_index_find_circles(SpatialIndex* index, Vector2 min, Vector2 max)
+{
+    //collects the circles of the grid that can reach into a box (their centers are at most half a cell of their level outside it)
+    if (index->moved_count > 0)
+        _spatial_index_update_moved_curves(index);
+    if (index->circle_count == 0)
+        return 0;
+    Sint64 ranges[SPATIAL_INDEX_LEVELS][4];
+    double cells = 0.0;
+    for (int level = 0; level < SPATIAL_INDEX_LEVELS; level++)
+    {
+        if (index->circle_level_counts[level] == 0)
+            continue;
+        double size = _spatial_index_level_size(level);
+        Vector2 margin = vector2_create(size / 2.0, size / 2.0);
+        cells += _spatial_index_cell_range(vector2_subtract(min, margin), vector2_add(max, margin), size, ranges[level]);
+    }
+    int count = 0;
+    if (cells > index->circle_count)
+    {
+        //zoomed far out the box covers more cells than there are circles
+        for (int i = 0; i < index->curve_count; i++)
+            if (index->curve_levels[i] != -1)
+                index->circle_candidates[count++] = i;
+        return count;
+    }
+    for (int level = 0; level < SPATIAL_INDEX_LEVELS; level++)
+    {
+        if (index->circle_level_counts[level] == 0)
+            continue;
+        for (Sint64 y = ranges[level][2]; y <= ranges[level][3]; y++)
+        {
+            for (Sint64 x = ranges[level][0]; x <= ranges[level][1]; x++)
+            {
+                int cell = _spatial_index_find_cell(&index->circle_grid, x, y, level);
+                if (cell == -1)
+                    continue;
+                for (int i = index->circle_grid.cells[cell].head; i != -1; i = index->curve_next[i])
+                    index->circle_candidates[count++] = i;
+            }
+        }
+    }
+    return count;
+}
+static bool _spatial_index_pick_curve(SpatialIndex* index, int i, Vector2 position, double tolerance, SpatialIndexFilter filter, void* data, int* best)
+{
+    double line1 = fabs(index->line_normal_x[0][i] * position.x + index->line_normal_y[0][i] * position.y - index->line_offset[0][i]);
+    double line2 = fabs(index->line_normal_x[1][i] * position.x + index->line_normal_y[1][i] * position.y - index->line_offset[1][i]);
+    double dx = position.x - index->circle_x[i], dy = position.y - index->circle_y[i];
+    double circle = fabs(sqrt(dx * dx + dy * dy) - index->circle_radius[i]);
+    if (fmin(fmin(line1, line2), circle) > tolerance || index->curve_orders[i] >= *best)
+        return false;
+    if (!filter(index->curves[i], data))
+        return false;
+    *best = index->curve_orders[i];
+    return true;
+}
+static bool _spatial_index_pick_circle(SpatialIndex* index, int i, Vector2 position, double tolerance, SpatialIndexFilter filter, void* data, int* best)
+{
+    //the circles of the grid have no lines
+    double dx = position.x - index->circle_x[i], dy = position.y - index->circle_y[i];
+    if (fabs(sqrt(dx * dx + dy * dy) - index->circle_radius[i]) > tolerance || index->curve_orders[i] >= *best)
+        return false;
+    if (!filter(index->curves[i], data))
+        return false;
+    *best = index->curve_orders[i];
+    return true;
+}
+static void _spatial_index_query_curve(SpatialIndex* index, int i, _SpatialPolygon* polygon, bool crossing, SpatialIndexVisit visit, void* data)
+{
+    Vector2 min = polygon->min[0], max = polygon->max[0];
+    double radius = index->circle_radius[i];
+    if (radius >= 0.0)
+    {
+        //without an edge crossing it the circle is either completely inside or completely outside
+        Vector2 center = vector2_create(index->circle_x[i], index->circle_y[i]);
+        if (_spatial_polygon_crosses_circle(polygon, 0, 0, polygon->vertex_count, center, radius * radius))
+        {
+            if (crossing)
+                visit(index->curves[i], data);
+        }
+        else if (center.x - radius >= min.x && center.x + radius <= max.x && center.y - radius >= min.y && center.y + radius <= max.y &&
+                 _spatial_polygon_contains(polygon, vector2_create(center.x + radius, center.y)))
+            visit(index->curves[i], data);
+        return;
+    }
+    if (!crossing)
+        return;
+    for (int k = 0; k < 2; k++)
+    {
+        double normal_x = index->line_normal_x[k][i], normal_y = index->line_normal_y[k][i], offset = index->line_offset[k][i];
+        //unused and degenerate lines are not visible, they can't be selected either
+        if (offset == SPATIAL_INDEX_NEVER || (normal_x == 0.0 && normal_y == 0.0))
+            continue;
+        if (_spatial_polygon_line_sides(polygon, 0, 0, polygon->vertex_count, normal_x, normal_y, offset, 0) == 3)
+        {
+            visit(index->curves[i], data);
+            return;
+        }
+    }
+}
+
+SpatialIndex* spatial_index_create(void)
+{
+    SpatialIndex* index = (SpatialIndex*)calloc(1, sizeof(SpatialIndex));
+    if (index == NULL)
+    {
+        printf("failed to allocate memory for the spatial index\n");
+        exit(1);
+    }
+    _spatial_index_rehash(&index->point_grid);
+    _spatial_index_rehash(&index->circle_grid);
+    index->free_dependent = -1;
+    return index;
+}
+void spatial_index_destroy(SpatialIndex* index)
+{
+    if (index == NULL)
+        return;
+    free(index->point_grid.cells);
+    free(index->circle_grid.cells);
+    free(index->points);
+    free(index->point_positions);
+    free(index->point_orders);
+    free(index->point_next);
+    free(index->point_previous);
+    free(index->point_dependents);
+    free(index->curves);
+    free(index->curve_orders);
+    free(index->curve_points);
+    free(index->curve_moved);
+    free(index->curve_levels);
+    free(index->curve_next);
+    free(index->curve_previous);
+    free(index->moved_curves);
+    free(index->curve_unbounded_slots);
+    free(index->circle_candidates);
+    free(index->unbounded_curves);
+    free(index->dependents);
+    free(index->dependent_next);
+    for (int k = 0; k < 2; k++)
+    {
+        free(index->line_normal_x[k]);
+        free(index->line_normal_y[k]);
+        free(index->line_offset[k]);
+    }
+    free(index->circle_x);
+    free(index->circle_y);
+    free(index->circle_radius);
+    free(index);
+}
+void spatial_index_insert(SpatialIndex* index, Shape* shape)
+{
+    if (index == NULL || shape == NULL)
+        return;
+    if (shape->type == ST_POINT)
+        _spatial_index_insert_point(index, shape);
+    else
+        _spatial_index_insert_curve(index, shape);
+    index->version++;
+}
+void spatial_index_remove(SpatialIndex* index, Shape* shape)
+{
+    if (index == NULL || shape == NULL || shape->spatial_slot == -1)
+        return;
+    if (shape->type == ST_POINT)
+        _spatial_index_remove_point(index, shape->spatial_slot);
+    else
+        _spatial_index_remove_curve(index, shape->spatial_slot);
+    shape->spatial_slot = -1;
+    index->version++;
+}
+void spatial_index_move(SpatialIndex* index, Shape* shape)
+{
+    if (index == NULL || shape == NULL)
+        return;
+    _spatial_index_move_point(index, shape);
+    index->version++;
+}
+void spatial_index_move_points(SpatialIndex* index, Shape** points, int count)
+{
+    if (index == NULL || count <= 0)
+        return;
+    for (int i = 0; i < count; i++)
+        _spatial_index_move_point(index, points[i]);
+    index->version++;
+}
+void spatial_index_update(SpatialIndex* index, Shape* shape)
+{
+    if (index == NULL || shape == NULL || shape->spatial_slot == -1)
+        return;
+    if (shape->type == ST_POINT)
+    {
+        spatial_index_move(index, shape);
+        return;
+    }
+    //the shape may depend on other points now
+    int i = shape->spatial_slot;
+    for (int k = 0; k < SHAPE_OUTLINE_MAX_POINTS && index->curve_points[i * SHAPE_OUTLINE_MAX_POINTS + k] != NULL; k++)
+        _spatial_index_remove_dependent(index, index->curve_points[i * SHAPE_OUTLINE_MAX_POINTS + k], shape);
+    _spatial_index_refresh_curve(index, i);
+    for (int k = 0; k < SHAPE_OUTLINE_MAX_POINTS && index->curve_points[i * SHAPE_OUTLINE_MAX_POINTS + k] != NULL; k++)
+        _spatial_index_add_dependent(index, index->curve_points[i * SHAPE_OUTLINE_MAX_POINTS + k], shape);
+    index->version++;
+}
+void spatial_index_query_polygon(SpatialIndex* index, const Vector2* vertices, int vertex_count, bool crossing, SpatialIndexVisit visit, void* data)
+{
+    if (index == NULL || vertices == NULL || vertex_count < 3)
+        return;
+    int node_count = 4 * (vertex_count / SPATIAL_INDEX_LEAF_EDGES + 1);
+    _SpatialPolygon polygon = { vertices, vertex_count, malloc(sizeof(Vector2) * node_count), malloc(sizeof(Vector2) * node_count) };
+    if (polygon.min == NULL || polygon.max == NULL)
+    {
+        printf("failed to allocate memory for the spatial index\n");
+        exit(1);
+    }
+    _spatial_polygon_build(&polygon, 0, 0, vertex_count);
+    Vector2 min = polygon.min[0], max = polygon.max[0];
+
+    Sint64 range[4];
+    if (_spatial_index_cell_range(min, max, SPATIAL_INDEX_CELL_SIZE, range) > index->point_count)
+    {
+        for (int i = 0; i < index->point_count; i++)
+            if (_spatial_polygon_contains(&polygon, index->point_positions[i]))
+                visit(index->points[i], data);
+    }
+    else
+    {
+        for (Sint64 y = range[2]; y <= range[3]; y++)
+        {
+            for (Sint64 x = range[0]; x <= range[1]; x++)
+            {
+                int cell = _spatial_index_find_cell(&index->point_grid, x, y, 0);
+                if (cell == -1)
+                    continue;
+                for (int i = index->point_grid.cells[cell].head; i != -1; i = index->point_next[i])
+                    if (_spatial_polygon_contains(&polygon, index->point_positions[i]))
+                        visit(index->points[i], data);
+            }
+        }
+    }
+
+    int circle_count = _spatial_index_find_circles(index, min, max);
+    for (int k = 0; k < circle_count; k++)
+        _spatial_index_query_curve(index, index->circle_candidates[k], &polygon, crossing, visit, data);
+    for (int k = 0; k < index->unbounded_count; k++)
+        _spatial_index_query_curve(index, index->unbounded_curves[k], &polygon, crossing, visit, data);
+    free(polygon.min);
+    free(polygon.max);
+}
+Shape* spatial_index_pick(SpatialIndex* index, Vector2 position, double tolerance, SpatialIndexFilter filter, void* data)
+{
+    if (index == NULL)
+        return NULL;
+    //the candidates are found a little generously, the filter makes the exact decision on screen coordinates that are rounded
+    //(and near vertical lines intersected) a bit differently
+    tolerance = tolerance * 1.01 + 1e-9;
+
+    int best = INT32_MAX;
+    Shape* picked = NULL;
+    Vector2 min = vector2_create(position.x - tolerance, position.y - tolerance);
+    Vector2 max = vector2_create(position.x + tolerance, position.y + tolerance);
+    Sint64 range[4];
+    if (_spatial_index_cell_range(min, max, SPATIAL_INDEX_CELL_SIZE, range) > index->point_count)
+    {
+        //zoomed far out the cursor covers more cells than there are points
+        for (int i = 0; i < index->point_count; i++)
+            if (_spatial_index_pick_point(index, i, position, tolerance, filter, data, &best))
+                picked = index->points[i];
+    }
+    else
+    {
+        for (Sint64 y = range[2]; y <= range[3]; y++)
+        {
+            for (Sint64 x = range[0]; x <= range[1]; x++)
+            {
+                int cell = _spatial_index_find_cell(&index->point_grid, x, y, 0);
+                if (cell == -1)
+                    continue;
+                for (int i = index->point_grid.cells[cell].head; i != -1; i = index->point_next[i])
+                    if (_spatial_index_pick_point(index, i, position, tolerance, filter, data, &best))
+                        picked = index->points[i];
+            }
+        }
+    }
+    if (picked != NULL)
+        return picked;
+
+    //the lines can't be bucketed, they are scanned (mostly in insertion order, so later candidates are rejected before the filter)
+    int circle_count = _spatial_index_find_circles(index, min, max);
+    for (int k = 0; k < index->unbounded_count; k++)
+        if (_spatial_index_pick_curve(index, index->unbounded_curves[k], position, tolerance, filter, data, &best))
+            picked = index->curves[index->unbounded_curves[k]];
+    for (int k = 0; k < circle_count; k++)
+        if (_spatial_index_pick_circle(index, index->circle_candidates[k], position, tolerance, filter, data, &best))
+            picked = index->curves[index->circle_candidates[k]];
+    return picked;
+}
@@ -0,0 +1,182 @@
+#pragma once
+
+#ifdef _WIN32
+    #include <SDL.h>
+#elif defined(__unix__) || defined(__linux__)
+    #include <SDL2/SDL.h>
+#endif
+
+#include <stdbool.h>
+
+#include "../shape/shape.h"
+#include "../vector2/vector2.h"
+
+#define SPATIAL_INDEX_CELL_SIZE 1.0
+#define SPATIAL_INDEX_LEVELS 48
+
+/*
+ * Spatial index for picking shapes under the cursor, kept in world space so panning and zooming don't invalidate it.
+ * The points are bucketed into a hash grid of SPATIAL_INDEX_CELL_SIZE sized cells, a query only visits the cells around the cursor.
+ * The circles are bucketed by their centers into a hash grid of levels, a circle is kept at the first level whose cells
+ * (SPATIAL_INDEX_CELL_SIZE * 2^level sized) are at least as large as it, so a query only visits the cells around the cursor on the used levels.
+ * The other shapes are infinite lines that can't be bucketed (like the circles too large or too far away for the grid),
+ * they are kept in a list that every query scans, so the lines still cost O(lines) per query.
+ * The outlines are kept as packed line equations and circles, so a candidate is tested without calling the overlap function of its shape.
+ * Every point links the shapes calculated from it, moving it only marks them, the next pick recalculates their outlines.
+ * Every shape remembers its insertion order, so a pick returns the same shape as a scan of the shape list would.
+ * Every change increments the version of the index, so the results of a pick can be cached until the shapes change.
+ */
+
+/**
+ * @brief A cell of a grid (the shapes of the cell form a linked list)
+ */
+typedef struct SpatialIndexCell
+{
+    Sint64 x;
+    Sint64 y;
+    int level;
+    int head;
+    bool used;
+} SpatialIndexCell;
+/**
+ * @brief A hash grid of cells (open addressing, the empty cells are dropped when it grows)
+ */
+typedef struct SpatialIndexGrid
+{
+    SpatialIndexCell* cells;
+    int capacity;
+    int count;
+} SpatialIndexGrid;
+
+/**
+ * @brief The spatial index of the shapes of a coordinate system
+ */
+typedef struct SpatialIndex
+{
+    SpatialIndexGrid point_grid;
+
+    Shape** points;
+    Vector2* point_positions;
+    int* point_orders;
+    int* point_next;
+    int* point_previous;
+    int* point_dependents;
+    int point_count;
+    int point_capacity;
+
+    Shape** curves;
+    int* curve_orders;
+    Shape** curve_points;
+    int* curve_moved;
+    int* curve_levels;
+    int* curve_next;
+    int* curve_previous;
+    int* curve_unbounded_slots;
+    double* line_normal_x[2];
+    double* line_normal_y[2];
+    double* line_offset[2];
+    double* circle_x;
+    double* circle_y;
+    double* circle_radius;
+    int curve_count;
+    int curve_capacity;
+    int* moved_curves;
+    int moved_count;
+
+    SpatialIndexGrid circle_grid;
+    int circle_level_counts[SPATIAL_INDEX_LEVELS];
+    int circle_count;
+    int* circle_candidates;
+    int* unbounded_curves;
+    int unbounded_count;
+
+    Shape** dependents;
+    int* dependent_next;
+    int dependent_count;
+    int dependent_capacity;
+    int free_dependent;
+
+    int next_order;
+    Uint64 version;
+} SpatialIndex;
+
+/**
+ * @brief Decides whether a shape found by the index can be picked (the exact test, the index only finds the candidates)
+ */
+typedef bool (*SpatialIndexFilter)(Shape* shape, void* data);
+/**
+ * @brief Receives the shapes found by a range query
+ */
+typedef void (*SpatialIndexVisit)(Shape* shape, void* data);
+
+/**
+ * @brief Creates an empty spatial index
+ *
+ * @return SpatialIndex* The created index
+ */
+SpatialIndex* spatial_index_create(void);
+/**
+ * @brief Destroys a spatial index (the shapes are not destroyed)
+ *
+ * @param index The index to destroy
+ */
+void spatial_index_destroy(SpatialIndex* index);
+/**
+ * @brief Adds a shape to the index (after the shapes already in it)
+ *
+ * @param index The index
+ * @param shape The shape to add
+ */
+void spatial_index_insert(SpatialIndex* index, Shape* shape);
+/**
+ * @brief Removes a shape from the index
+ *
+ * @param index The index
+ * @param shape The shape to remove
+ */
+void spatial_index_remove(SpatialIndex* index, Shape* shape);
+/**
+ * @brief Updates the index after a point has moved (the shapes defined by it are updated lazily by the next pick)
+ *
+ * @param index The index
+ * @param shape The point that has moved
+ */
+void spatial_index_move(SpatialIndex* index, Shape* shape);
+/**
+ * @brief Updates the index after a batch of points has moved (every shape defined by them is only marked once, the version is incremented once)
+ *
+ * @param index The index
+ * @param points The points that have moved
+ * @param count The number of points
+ */
+void spatial_index_move_points(SpatialIndex* index, Shape** points, int count);
+/**
+ * @brief Updates the index after the definition of a shape has changed (e.g. a line got a different point)
+ *
+ * @param index The index
+ * @param shape The changed shape
+ */
+void spatial_index_update(SpatialIndex* index, Shape* shape);
+/**
+ * @brief Finds the first inserted point near a position, or the first inserted other shape if no point is near
+ *
+ * @param index The index
+ * @param position The position in world space
+ * @param tolerance The maximum distance of a candidate from the position (in world space)
+ * @param filter The exact test of the candidates
+ * @param data The data passed to the filter
+ * @return Shape* The picked shape (NULL if there is no shape at the position)
+ */
+Shape* spatial_index_pick(SpatialIndex* index, Vector2 position, double tolerance, SpatialIndexFilter filter, void* data);
+/**
+ * @brief Finds the shapes in a polygon (the points inside it and the circles completely inside it,
+ * or in crossing mode also the lines and circles that cross it)
+ *
+ * @param index The index
+ * @param vertices The vertices of the polygon in world space (it may be concave or self-intersecting, the even-odd rule decides what is inside)
+ * @param vertex_count The number of vertices
+ * @param crossing Whether the shapes crossing the polygon are found too (an infinite line is never completely inside)
+ * @param visit Called with every shape found
+ * @param data The data passed to visit
+ */
+void spatial_index_query_polygon(SpatialIndex* index, const Vector2* vertices, int vertex_count, bool crossing, SpatialIndexVisit visit, void* data);
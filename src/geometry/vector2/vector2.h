@@ -6,6 +6,15 @@
     #include <SDL2/SDL.h>
 #endif
 
+#include <math.h>
+
+/*
+ * The functions are defined inline in the header, so the geometry loops can inline and vectorize them without LTO
+ * (vector2.c provides the external definitions, for the calls that are not inlined and for taking their address).
+ * Vector2x2 and Vector2x4 are 2 and 4 vectors as structures of arrays for batch kernels, their coordinates are GCC vector types,
+ * so every operation is a single SIMD instruction (or a pair of SSE instructions for 4 lanes without AVX).
+ */
+
 /**
  * @brief A 2D vector, used for coordinate geometry
  */
@@ -21,7 +30,7 @@ typedef struct Vector2
  * @param y The y value
  * @return Vector2 The vector
  */
-Vector2 vector2_create(double x, double y);
+inline Vector2 vector2_create(double x, double y) { return (Vector2){x, y}; }
 /**
  * @brief Creates a vector from polar coordinates
  * 
@@ -29,51 +38,51 @@ Vector2 vector2_create(double x, double y);
  * @param length The length
  * @return Vector2 The vector
  */
-Vector2 vector2_from_polar(double angle, double length);
+inline Vector2 vector2_from_polar(double angle, double length) { return (Vector2){ cos(angle) * length, sin(angle) * length}; }
 /**
  * @brief Creates a vector from am SDL_Point
  * 
  * @param point The point
  * @return Vector2 The vector
  */
-Vector2 vector2_from_point(SDL_Point point);
+inline Vector2 vector2_from_point(SDL_Point point) { return (Vector2){point.x, point.y}; }
 
 /**
  * @brief Returns a vector with x and y values of 0
  * 
  * @return Vector2 The vector
  */
-Vector2 vector2_zero();
+inline Vector2 vector2_zero() { return (Vector2){0, 0}; }
 /**
  * @brief Returns a vector with x and y values of 1
  * 
  * @return Vector2 The vector
  */
-Vector2 vector2_one();
+inline Vector2 vector2_one() { return (Vector2){1, 1}; }
 /**
  * @brief Returns a vector with x value of 0 and y value of 1
  * 
  * @return Vector2 The vector
  */
-Vector2 vector2_up();
+inline Vector2 vector2_up() { return (Vector2){0, 1}; }
 /**
  * @brief Returns a vector with x value of 0 and y value of -1
  * 
  * @return Vector2 The vector
  */
-Vector2 vector2_down();
+inline Vector2 vector2_down() { return (Vector2){0, -1}; }
 /**
  * @brief Returns a vector with x value of -1 and y value of 0
  * 
  * @return Vector2 The vector
  */
-Vector2 vector2_left();
+inline Vector2 vector2_left() { return (Vector2){-1, 0}; }
 /**
  * @brief Returns a vector with x value of 1 and y value of 0
  * 
  * @return Vector2 The vector
  */
-Vector2 vector2_right();
+inline Vector2 vector2_right() { return (Vector2){1, 0}; }
 
 /**
  * @brief Adds two vectors
@@ -82,7 +91,7 @@ Vector2 vector2_right();
  * @param b The second vector
  * @return Vector2 The sum of the two vectors
  */
-Vector2 vector2_add(Vector2 a, Vector2 b);
+inline Vector2 vector2_add(Vector2 a, Vector2 b) { return (Vector2){a.x + b.x, a.y + b.y}; }
 /**
  * @brief Subtracts two vectors
  * 
@@ -90,7 +99,7 @@ Vector2 vector2_add(Vector2 a, Vector2 b);
  * @param b The second vector
  * @return Vector2 The difference of the two vectors
  */
-Vector2 vector2_subtract(Vector2 a, Vector2 b);
+inline Vector2 vector2_subtract(Vector2 a, Vector2 b) { return (Vector2){a.x - b.x, a.y - b.y}; }
 /**
  * @brief Scales a vector by a scalar
  * 
@@ -98,14 +107,14 @@ Vector2 vector2_subtract(Vector2 a, Vector2 b);
  * @param b The scale
  * @return Vector2 The scaled vector
  */
-Vector2 vector2_scale(Vector2 a, double b);
+inline Vector2 vector2_scale(Vector2 a, double b) { return (Vector2){a.x * b, a.y * b}; }
 /**
  * @brief Negates a vector
  * 
  * @param a The vector
  * @return Vector2 The negated vector
  */
-Vector2 vector2_negate(Vector2 a);
+inline Vector2 vector2_negate(Vector2 a) { return (Vector2){-a.x, -a.y}; }
 /**
  * @brief Multiplies two vectors component-wise
  * 
@@ -113,7 +122,7 @@ Vector2 vector2_negate(Vector2 a);
  * @param b The second vector
  * @return Vector2 The product of the two vectors
  */
-Vector2 vector2_multiply(Vector2 a, Vector2 b);
+inline Vector2 vector2_multiply(Vector2 a, Vector2 b) { return (Vector2){a.x * b.x, a.y * b.y}; }
 /**
  * @brief Divides two vectors component-wise
  * 
@@ -121,7 +130,7 @@ Vector2 vector2_multiply(Vector2 a, Vector2 b);
  * @param b The second vector
  * @return Vector2 The quotient of the two vectors
  */
-Vector2 vector2_divide(Vector2 a, Vector2 b);
+inline Vector2 vector2_divide(Vector2 a, Vector2 b) { return (Vector2){a.x / b.x, a.y / b.y}; }
 /**
  * @brief Calculates the dot product of two vectors
  * 
@@ -129,7 +138,7 @@ Vector2 vector2_divide(Vector2 a, Vector2 b);
  * @param b The second vector
  * @return double The dot product of the two vectors
  */
-double vector2_dot(Vector2 a, Vector2 b);
+inline double vector2_dot(Vector2 a, Vector2 b) { return a.x * b.x + a.y * b.y; }
 /**
  * @brief Calculates the cross product of two vectors
  * 
@@ -137,14 +146,14 @@ double vector2_dot(Vector2 a, Vector2 b);
  * @param b The second vector
  * @return double The cross product of the two vectors
  */
-double vector2_cross(Vector2 a, Vector2 b);
+inline double vector2_cross(Vector2 a, Vector2 b) { return a.x * b.y - a.y * b.x; }
 /**
  * @brief Calculates the length of a vector
  * 
  * @param a The vector
  * @return double The length of the vector
  */
-double vector2_length(Vector2 a);
+inline double vector2_length(Vector2 a) { return sqrt(vector2_dot(a, a)); }
 /**
  * @brief Calculates the distance between two vectors
  * 
@@ -152,28 +161,28 @@ double vector2_length(Vector2 a);
  * @param b The second vector
  * @return double The distance between the two vectors
  */
-double vector2_distance(Vector2 a, Vector2 b);
+inline double vector2_distance(Vector2 a, Vector2 b) { return vector2_length(vector2_subtract(a, b)); }
 /**
  * @brief Calculates the angle of a vector
  * 
  * @param a The vector
  * @return double The angle of the vector
  */
-double vector2_angle(Vector2 a);
+inline double vector2_angle(Vector2 a) { return atan2(a.y, a.x); }
 /**
  * @brief Normalizes a vector
  * 
  * @param a The vector
  * @return Vector2 The normalized vector
  */
-Vector2 vector2_normalize(Vector2 a);
+inline Vector2 vector2_normalize(Vector2 a) { return vector2_scale(a, 1.0 / vector2_length(a)); }
 /**
  * @brief Rotates a vector by 90 degrees
  * 
  * @param a The vector
  * @return Vector2 The rotated vector
  */
-Vector2 vector2_rotate90(Vector2 a);
+inline Vector2 vector2_rotate90(Vector2 a) { return (Vector2){-a.y, a.x}; }
 /**
  * @brief Rotates a vector by an angle
  * 
@@ -181,7 +190,7 @@ Vector2 vector2_rotate90(Vector2 a);
  * @param angle The angle
  * @return Vector2 The rotated vector
  */
-Vector2 vector2_rotate(Vector2 a, double angle);
+inline Vector2 vector2_rotate(Vector2 a, double angle) { return vector2_from_polar(vector2_angle(a) + angle, vector2_length(a)); }
 /**
  * @brief Reflects a vector over a normal
  * 
@@ -189,4 +198,182 @@ Vector2 vector2_rotate(Vector2 a, double angle);
  * @param normal The normal
  * @return Vector2 The reflected vector
  */
-Vector2 vector2_reflect(Vector2 a, Vector2 normal);
\ No newline at end of file
+inline Vector2 vector2_reflect(Vector2 a, Vector2 normal) { return vector2_subtract(a, vector2_scale(normal, 2 * vector2_dot(a, normal))); }
+
+/**
+ * @brief 2 and 4 doubles in a SIMD register (the alignment is lowered to the alignment of a double, so they can be stored anywhere)
+ */
+typedef double Doublex2 __attribute__((vector_size(16), aligned(8)));
+typedef double Doublex4 __attribute__((vector_size(32), aligned(8)));
+/**
+ * @brief 2 vectors as a structure of arrays (one SSE register per coordinate)
+ */
+typedef struct Vector2x2
+{
+    Doublex2 x;
+    Doublex2 y;
+} Vector2x2;
+/**
+ * @brief 4 vectors as a structure of arrays (one AVX register or two SSE registers per coordinate)
+ */
+typedef struct Vector2x4
+{
+    Doublex4 x;
+    Doublex4 y;
+} Vector2x4;
+
+/**
+ * @brief Loads 2 consecutive vectors into lanes
+ * 
+ * @param points The vectors (at least 2)
+ * @return Vector2x2 The lanes
+ */
+inline Vector2x2 vector2x2_load(const Vector2* points) { return (Vector2x2){ {points[0].x, points[1].x}, {points[0].y, points[1].y} }; }
+/**
+ * @brief Stores the lanes into 2 consecutive vectors
+ * 
+ * @param a The lanes
+ * @param points The array receiving the vectors (at least 2)
+ */
+inline void vector2x2_store(Vector2x2 a, Vector2* points)
+{
+    for (int i = 0; i < 2; i++)
+        points[i] = (Vector2){a.x[i], a.y[i]};
+}
+/**
+ * @brief Puts the same vector into every lane
+ * 
+ * @param a The vector
+ * @return Vector2x2 The lanes
+ */
+inline Vector2x2 vector2x2_splat(Vector2 a) { return (Vector2x2){ {a.x, a.x}, {a.y, a.y} }; }
+/**
+ * @brief Adds the lanes of two vectors
+ * 
+ * @param a The first lanes
+ * @param b The second lanes
+ * @return Vector2x2 The sums
+ */
+inline Vector2x2 vector2x2_add(Vector2x2 a, Vector2x2 b) { return (Vector2x2){a.x + b.x, a.y + b.y}; }
+/**
+ * @brief Subtracts the lanes of two vectors
+ * 
+ * @param a The first lanes
+ * @param b The second lanes
+ * @return Vector2x2 The differences
+ */
+inline Vector2x2 vector2x2_subtract(Vector2x2 a, Vector2x2 b) { return (Vector2x2){a.x - b.x, a.y - b.y}; }
+/**
+ * @brief Scales every lane by a scalar
+ * 
+ * @param a The lanes
+ * @param b The scalar
+ * @return Vector2x2 The scaled lanes
+ */
+inline Vector2x2 vector2x2_scale(Vector2x2 a, double b) { return (Vector2x2){a.x * b, a.y * b}; }
+/**
+ * @brief Calculates the dot products of the lanes
+ * 
+ * @param a The first lanes
+ * @param b The second lanes
+ * @param dot Receives the dot products
+ */
+inline void vector2x2_dot(Vector2x2 a, Vector2x2 b, Doublex2* dot) { *dot = a.x * b.x + a.y * b.y; }
+/**
+ * @brief Calculates the cross products (the z coordinates) of the lanes
+ * 
+ * @param a The first lanes
+ * @param b The second lanes
+ * @param cross Receives the cross products
+ */
+inline void vector2x2_cross(Vector2x2 a, Vector2x2 b, Doublex2* cross) { *cross = a.x * b.y - a.y * b.x; }
+/**
+ * @brief Calculates the squared distances of the lanes (without square roots, for comparing distances)
+ * 
+ * @param a The first lanes
+ * @param b The second lanes
+ * @param distance Receives the squared distances
+ */
+inline void vector2x2_distance_squared(Vector2x2 a, Vector2x2 b, Doublex2* distance)
+{
+    Doublex2 dx = a.x - b.x, dy = a.y - b.y;
+    *distance = dx * dx + dy * dy;
+}
+
+/**
+ * @brief Loads 4 consecutive vectors into lanes
+ * 
+ * @param points The vectors (at least 4)
+ * @return Vector2x4 The lanes
+ */
+inline Vector2x4 vector2x4_load(const Vector2* points) { return (Vector2x4){ {points[0].x, points[1].x, points[2].x, points[3].x}, {points[0].y, points[1].y, points[2].y, points[3].y} }; }
+/**
+ * @brief Stores the lanes into 4 consecutive vectors
+ * 
+ * @param a The lanes
+ * @param points The array receiving the vectors (at least 4)
+ */
+inline void vector2x4_store(Vector2x4 a, Vector2* points)
+{
+    for (int i = 0; i < 4; i++)
+        points[i] = (Vector2){a.x[i], a.y[i]};
+}
+/**
+ * @brief Puts the same vector into every lane
+ * 
+ * @param a The vector
+ * @return Vector2x4 The lanes
+ */
+inline Vector2x4 vector2x4_splat(Vector2 a) { return (Vector2x4){ {a.x, a.x, a.x, a.x}, {a.y, a.y, a.y, a.y} }; }
+/**
+ * @brief Adds the lanes of two vectors
+ * 
+ * @param a The first lanes
+ * @param b The second lanes
+ * @return Vector2x4 The sums
+ */
+inline Vector2x4 vector2x4_add(Vector2x4 a, Vector2x4 b) { return (Vector2x4){a.x + b.x, a.y + b.y}; }
+/**
+ * @brief Subtracts the lanes of two vectors
+ * 
+ * @param a The first lanes
+ * @param b The second lanes
+ * @return Vector2x4 The differences
+ */
+inline Vector2x4 vector2x4_subtract(Vector2x4 a, Vector2x4 b) { return (Vector2x4){a.x - b.x, a.y - b.y}; }
+/**
+ * @brief Scales every lane by a scalar
+ * 
+ * @param a The lanes
+ * @param b The scalar
+ * @return Vector2x4 The scaled lanes
+ */
+inline Vector2x4 vector2x4_scale(Vector2x4 a, double b) { return (Vector2x4){a.x * b, a.y * b}; }
+/**
+ * @brief Calculates the dot products of the lanes
+ * 
+ * @param a The first lanes
+ * @param b The second lanes
+ * @param dot Receives the dot products
+ */
+inline void vector2x4_dot(Vector2x4 a, Vector2x4 b, Doublex4* dot) { *dot = a.x * b.x + a.y * b.y; }
+/**
+ * @brief Calculates the cross products (the z coordinates) of the lanes
+ * 
+ * @param a The first lanes
+ * @param b The second lanes
+ * @param cross Receives the cross products
+ */
+inline void vector2x4_cross(Vector2x4 a, Vector2x4 b, Doublex4* cross) { *cross = a.x * b.y - a.y * b.x; }
+/**
+ * @brief Calculates the squared distances of the lanes (without square roots, for comparing distances)
+ * 
+ * @param a The first lanes
+ * @param b The second lanes
+ * @param distance Receives the squared distances
+ */
+inline void vector2x4_distance_squared(Vector2x4 a, Vector2x4 b, Doublex4* distance)
+{
+    Doublex4 dx = a.x - b.x, dy = a.y - b.y;
+    *distance = dx * dx + dy * dy;
+}
@@ -0,0 +1,56 @@
+#include "view_transform.h"
+
+#ifdef __AVX__
+    #include <immintrin.h>
+#elif defined(__SSE2__)
+    #include <emmintrin.h>
+#endif
+
+ViewTransform view_transform_create(Vector2 position, Vector2 size, Vector2 origin, double zoom)
+{
+    return (ViewTransform){ { zoom, -zoom }, { origin.x * size.x + position.x, origin.y * size.y + position.y } };
+}
+Vector2 view_transform_to_screen(const ViewTransform* view, Vector2 point)
+{
+    return (Vector2){ point.x * view->scale.x + view->offset.x, point.y * view->scale.y + view->offset.y };
+}
+Vector2 view_transform_to_world(const ViewTransform* view, Vector2 point)
+{
+    return (Vector2){ (point.x - view->offset.x) / view->scale.x, (point.y - view->offset.y) / view->scale.y };
+}
+void view_transform_to_screen_batch(const ViewTransform* view, const Vector2* points, Vector2* screen, size_t count)
+{
+    //a Vector2 is two packed doubles, so one register holds the x and y of a point (two points with AVX),
+    //and the same multiply-add (without fusing, to round like the scalar version) converts all of them
+    size_t i = 0;
+#ifdef __AVX__
+    __m256d scale = _mm256_setr_pd(view->scale.x, view->scale.y, view->scale.x, view->scale.y);
+    __m256d offset = _mm256_setr_pd(view->offset.x, view->offset.y, view->offset.x, view->offset.y);
+    for (; i + 2 <= count; i += 2)
+        _mm256_storeu_pd(&screen[i].x, _mm256_add_pd(_mm256_mul_pd(_mm256_loadu_pd(&points[i].x), scale), offset));
+#elif defined(__SSE2__)
+    __m128d scale = _mm_setr_pd(view->scale.x, view->scale.y);
+    __m128d offset = _mm_setr_pd(view->offset.x, view->offset.y);
+    for (; i < count; i++)
+        _mm_storeu_pd(&screen[i].x, _mm_add_pd(_mm_mul_pd(_mm_loadu_pd(&points[i].x), scale), offset));
+#endif
+    for (; i < count; i++)
+        screen[i] = view_transform_to_screen(view, points[i]);
+}
+void view_transform_to_world_batch(const ViewTransform* view, const Vector2* points, Vector2* world, size_t count)
+{
+    size_t i = 0;
+#ifdef __AVX__
+    __m256d scale = _mm256_setr_pd(view->scale.x, view->scale.y, view->scale.x, view->scale.y);
+    __m256d offset = _mm256_setr_pd(view->offset.x, view->offset.y, view->offset.x, view->offset.y);
+    for (; i + 2 <= count; i += 2)
+        _mm256_storeu_pd(&world[i].x, _mm256_div_pd(_mm256_sub_pd(_mm256_loadu_pd(&points[i].x), offset), scale));
+#elif defined(__SSE2__)
+    __m128d scale = _mm_setr_pd(view->scale.x, view->scale.y);
+    __m128d offset = _mm_setr_pd(view->offset.x, view->offset.y);
+    for (; i < count; i++)
+        _mm_storeu_pd(&world[i].x, _mm_div_pd(_mm_sub_pd(_mm_loadu_pd(&points[i].x), offset), scale));
+#endif
+    for (; i < count; i++)
+        world[i] = view_transform_to_world(view, points[i]);
+}
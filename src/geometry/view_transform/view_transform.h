@@ -0,0 +1,65 @@
+#pragma once
+
+#include <stddef.h>
+
+#include "../vector2/vector2.h"
+
+/*
+ * The view of a coordinate system as an affine transform: screen = world * scale + offset.
+ * The view only scales uniformly (with the y axis flipped) and translates, so two multiply-adds convert a point,
+ * and the batch functions convert whole arrays of points with SIMD (AVX if it is enabled, otherwise SSE2, otherwise scalar).
+ */
+
+/**
+ * @brief The affine transform from world space to the screen
+ */
+typedef struct ViewTransform
+{
+    Vector2 scale;
+    Vector2 offset;
+} ViewTransform;
+
+/**
+ * @brief Creates the transform of a view
+ * 
+ * @param position The position of the view on the screen
+ * @param size The size of the view (in pixels)
+ * @param origin The position of the world origin in the view (normalized)
+ * @param zoom The size of a world unit in pixels
+ * @return ViewTransform The transform
+ */
+ViewTransform view_transform_create(Vector2 position, Vector2 size, Vector2 origin, double zoom);
+/**
+ * @brief Converts a point from world space to the screen
+ * 
+ * @param view The transform
+ * @param point The point in world space
+ * @return Vector2 The point on the screen
+ */
+Vector2 view_transform_to_screen(const ViewTransform* view, Vector2 point);
+/**
+ * @brief Converts a point from the screen to world space
+ * 
+ * @param view The transform
+ * @param point The point on the screen
+ * @return Vector2 The point in world space
+ */
+Vector2 view_transform_to_world(const ViewTransform* view, Vector2 point);
+/**
+ * @brief Converts an array of points from world space to the screen (the results are the same as view_transform_to_screen)
+ * 
+ * @param view The transform
+ * @param points The points in world space
+ * @param screen The array receiving the points on the screen (may be the same array as points)
+ * @param count The number of points
+ */
+void view_transform_to_screen_batch(const ViewTransform* view, const Vector2* points, Vector2* screen, size_t count);
+/**
+ * @brief Converts an array of points from the screen to world space (the results are the same as view_transform_to_world)
+ * 
+ * @param view The transform
+ * @param points The points on the screen
+ * @param world The array receiving the points in world space (may be the same array as points)
+ * @param count The number of points
+ */
+void view_transform_to_world_batch(const ViewTransform* view, const Vector2* points, Vector2* world, size_t count);
@@ -15,17 +15,29 @@
 #include "geometry/shape/shape.h"
 #include "geometry/vector2/vector2.h"
 #include "input/input.h"
+#include "profiler/profiler.h"
 #include "renderer/renderer.h"
+#include "replay/replay.h"
 #include "texture/texture.h"
 #include "ui/ui.h"
 #include "ui/ui_constraint/ui_constraint.h"
 #include "ui/ui_element/ui_element.h"
 #include "utils/math/math.h"
+#include "utils/trace/trace.h"
 #include "utils/vector/vector.h"
 #include "window/window.h"
 
 #define FPS 60
 #define MOUSE_WHEEL_SENSITIVITY 5
+#define TRACE_FILE "gaegebra_trace.json"
+#define EXPORT_FILE "gaegebra_export.png"
+#define EXPORT_SVG_FILE "gaegebra_export.svg"
+#define EXPORT_WIDTH 1920
+#define EXPORT_HEIGHT 1080
+#define LASSO_MAX_POINTS 1024
+#define LASSO_POINT_DISTANCE 4
+#define AUTOSAVE_FILE "gaegebra_autosave.gae"
+#define AUTOSAVE_INTERVAL 60.0
 
 void on_pointer_clicked(UIButton* self);
 void on_point_clicked(UIButton* self);
@@ -44,10 +56,21 @@ void on_filemenu_clicked(UISplitButton* self, Sint32 index);
 void on_editmenu_clicked(UISplitButton* self, Sint32 index);
 void on_canvas_size_changed(UIContainer* self, SDL_Point size);
 
+void update_region_selection(void);
+void draw_region_selection(void);
+
+bool intersection_task_step(void* data, double* progress);
+bool autosave_task_step(void* data, double* progress);
+void update_autosave(void);
+void cancel_tasks(void);
+void draw_task_progress(void);
+
 typedef enum State
 {
     STATE_POINTER,
     STATE_CS_DRAGGED,
+    STATE_BOX_SELECTING,
+    STATE_LASSO_SELECTING,
 
     STATE_POINT,
     
@@ -75,11 +98,50 @@ typedef enum State
 
 CoordinateSystem* cs;
 State state = STATE_POINTER;
-
-int main(void)
+UIContainer* save_container;
+UIContainer* open_container;
+
+//the corners of the box (the first point and the mouse) or the vertices of the lasso
+Vector2 region_points[LASSO_MAX_POINTS];
+size_t region_point_count = 0;
+bool region_selection_valid = false;
+
+//the background work of the coordinate system, run by the scheduler of the app a few milliseconds per frame
+AppTask* intersection_task = NULL;
+AppTask* autosave_task = NULL;
+CoordinateSystemSaver* autosave = NULL;
+Uint64 autosave_version = 0;
+double autosave_time = 0.0;
+
+int main(int argc, char* argv[])
 {
+    //--export <file.gae> <file.png|file.svg> [width height] renders a saved construction into an image without opening a window
+    if (argc > 3 && strcmp(argv[1], "--export") == 0)
+    {
+        CoordinateSystem* exported = coordinate_system_load(argv[2]);
+        if (exported == NULL)
+        {
+            printf("couldn't load %s\n", argv[2]);
+            return 1;
+        }
+        int width = argc > 5 ? atoi(argv[4]) : EXPORT_WIDTH;
+        int height = argc > 5 ? atoi(argv[5]) : EXPORT_HEIGHT;
+        exported->origin = vector2_create(0.5, 0.5);
+        coordinate_system_update(exported);
+        size_t length = strlen(argv[3]);
+        bool svg = length > 4 && strcmp(argv[3] + length - 4, ".svg") == 0;
+        bool saved = svg ? coordinate_system_export_svg(exported, argv[3], width, height) : coordinate_system_export(exported, argv[3], width, height);
+        coordinate_system_destroy(exported);
+        return saved ? 0 : 1;
+    }
+
+    //--record <file> saves the input of the session, --replay <file> plays it back headless as fast as possible
+    bool recording = argc > 2 && strcmp(argv[1], "--record") == 0;
+    bool replaying = argc > 2 && strcmp(argv[1], "--replay") == 0;
+    app_set_headless(replaying);
     app_init();
-    app_set_target_fps(FPS);
+    app_set_target_fps(replaying ? 0 : FPS);
+    app_set_idle_mode(true);
 
     Window* window = window_create("GaeGebra", 800, 600, SDL_WINDOW_RESIZABLE);
     SDL_MaximizeWindow(window->window);
@@ -104,10 +166,10 @@ int main(void)
     
     UIContainer* menubar = ui_create_container(main_container, constraints_from_string("0p 0p 1r 30p"), NULL);
     ui_create_panel(menubar, constraints_from_string("0p 0p 1r 1r"), color_from_grayscale(200), WHITE, 0, 0);
-    UISplitButton* file_sb = ui_create_splitbutton(menubar, constraints_from_string("0p 0p 1r 1r"), "File;Open;Save", color_from_grayscale(180), BLACK, on_filemenu_clicked, true);
+    UISplitButton* file_sb = ui_create_splitbutton(menubar, constraints_from_string("0p 0p 1r 1r"), "File;Open;Save;Export;Export SVG", color_from_grayscale(180), BLACK, on_filemenu_clicked, true);
     ui_create_splitbutton(menubar, constraints_from_string("0o 0p 1r 1r"), "Edit;Clear;Close", color_from_grayscale(180), BLACK, on_editmenu_clicked, true);
 
-    UIContainer* save_container = ui_create_container(window_get_main_container(window), constraints_from_string("0p 0p 1r 1r"), NULL);
+    save_container = ui_create_container(window_get_main_container(window), constraints_from_string("0p 0p 1r 1r"), NULL);
     ui_create_panel(save_container, constraints_from_string("0p 0p 1r 1r"), color_fade(BLACK, 0.7), WHITE, 0, 0);
     UIContainer* save_menu = ui_create_container(save_container, constraints_from_string("c c 0.3r 200p"), NULL);
     ui_create_panel(save_menu, constraints_from_string("0p 0p 1r 1r"), color_from_grayscale(200), BLACK, 2, 0);
@@ -117,7 +179,7 @@ int main(void)
     ui_create_button(save_menu, constraints_from_string("0.51r -50o 0.44r 50p"), "Save", color_from_grayscale(80), WHITE, on_save_button_clicked);
     ui_hide_element((UIElement*)save_container);
 
-    UIContainer* open_container = ui_create_container(window_get_main_container(window), constraints_from_string("0p 0p 1r 1r"), NULL);
+    open_container = ui_create_container(window_get_main_container(window), constraints_from_string("0p 0p 1r 1r"), NULL);
     ui_create_panel(open_container, constraints_from_string("0p 0p 1r 1r"), color_fade(BLACK, 0.7), WHITE, 0, 0);
     UIContainer* open_menu = ui_create_container(open_container, constraints_from_string("c c 0.3r 200p"), NULL);
     ui_create_panel(open_menu, constraints_from_string("0p 0p 1r 1r"), color_from_grayscale(200), BLACK, 2, 0);
@@ -132,10 +194,21 @@ int main(void)
                                   vector2_create(canvas->base.size.x, canvas->base.size.y),
                                   vector2_create(0.5, 0.5));
 
+    if (recording)
+        replay_start_recording(argv[2]);
+    else if (replaying && !replay_start_playback(argv[2]))
+    {
+        coordinate_system_destroy(cs);
+        SDL_FreeCursor(cursor_hand);
+        app_close();
+        return 1;
+    }
     while (!window->close_requested)
     {
         //update
         app_update();
+        if (!replaying)
+            update_autosave();
 
         switch (state)
         {
@@ -160,7 +233,18 @@ int main(void)
                 {
                     coordinate_system_deselect_shapes(cs);
                     if (coordinate_system_is_hovered(cs, vector2_from_point(input_get_mouse_position())))
-                        state = STATE_CS_DRAGGED;
+                    {
+                        //Shift + drag selects with a box, Alt + drag with a lasso, a plain drag moves the view
+                        region_points[0] = vector2_from_point(input_get_mouse_position());
+                        region_point_count = 1;
+                        region_selection_valid = false;
+                        if (input_is_key_down(SDL_SCANCODE_LSHIFT) || input_is_key_down(SDL_SCANCODE_RSHIFT))
+                            state = STATE_BOX_SELECTING;
+                        else if (input_is_key_down(SDL_SCANCODE_LALT) || input_is_key_down(SDL_SCANCODE_RALT))
+                            state = STATE_LASSO_SELECTING;
+                        else
+                            state = STATE_CS_DRAGGED;
+                    }
                 }
             }
             else if (input_is_mouse_button_released(SDL_BUTTON_LEFT))
@@ -172,6 +256,12 @@ int main(void)
             else
                 coordinate_system_translate(cs, vector2_from_point(input_get_mouse_motion()));
             break;
+        case STATE_BOX_SELECTING:
+        case STATE_LASSO_SELECTING:
+            update_region_selection();
+            if (input_is_mouse_button_released(SDL_BUTTON_LEFT))
+                state = STATE_POINTER;
+            break;
 
         case STATE_POINT:
             if (input_is_mouse_button_pressed(SDL_BUTTON_LEFT) && coordinate_system_is_hovered(cs, vector2_from_point(input_get_mouse_position())))
@@ -230,6 +320,7 @@ int main(void)
                     coordinate_system_deselect_shapes(cs);
                     Line* line = (Line*)vector_get(cs->shapes, vector_size(cs->shapes) - 1);
                     line->p2 = (Point*)hovered_shape;
+                    coordinate_system_shape_changed(cs, (Shape*)line);
                     coordinate_system_destroy_shape(cs, vector_get(cs->shapes, vector_size(cs->shapes) - 2));
                 }
                 else
@@ -248,8 +339,8 @@ int main(void)
             }
             else if (input_is_key_released(SDL_SCANCODE_ESCAPE) || (input_is_mouse_button_pressed(SDL_BUTTON_LEFT) && !coordinate_system_is_hovered(cs, vector2_from_point(input_get_mouse_position()))))
             {
-                shape_destroy(cs, vector_pop_back(cs->shapes));
-                shape_destroy(cs, vector_pop_back(cs->shapes));
+                coordinate_system_destroy_shape(cs, vector_get(cs->shapes, vector_size(cs->shapes) - 1));
+                coordinate_system_destroy_shape(cs, vector_get(cs->shapes, vector_size(cs->shapes) - 1));
                 coordinate_system_deselect_shapes(cs);
                 state = STATE_LINE;
             }
@@ -297,6 +388,7 @@ int main(void)
                     coordinate_system_deselect_shapes(cs);
                     Circle* circle = (Circle*)vector_get(cs->shapes, vector_size(cs->shapes) - 1);
                     circle->perimeter_point = (Point*)hovered_shape;
+                    coordinate_system_shape_changed(cs, (Shape*)circle);
                     coordinate_system_destroy_shape(cs, vector_get(cs->shapes, vector_size(cs->shapes) - 2));
                 }
                 else
@@ -315,8 +407,8 @@ int main(void)
             }
             else if (input_is_key_released(SDL_SCANCODE_ESCAPE) || (input_is_mouse_button_pressed(SDL_BUTTON_LEFT) && !coordinate_system_is_hovered(cs, vector2_from_point(input_get_mouse_position()))))
             {
-                shape_destroy(cs, vector_pop_back(cs->shapes));
-                shape_destroy(cs, vector_pop_back(cs->shapes));
+                coordinate_system_destroy_shape(cs, vector_get(cs->shapes, vector_size(cs->shapes) - 1));
+                coordinate_system_destroy_shape(cs, vector_get(cs->shapes, vector_size(cs->shapes) - 1));
                 coordinate_system_deselect_shapes(cs);
                 state = STATE_CIRCLE;
             }
@@ -359,6 +451,7 @@ int main(void)
                     coordinate_system_deselect_shapes(cs);
                     Parallel* parallel = (Parallel*)vector_get(cs->shapes, vector_size(cs->shapes) - 1);
                     parallel->point = (Point*)hovered_shape;
+                    coordinate_system_shape_changed(cs, (Shape*)parallel);
                     coordinate_system_destroy_shape(cs, vector_get(cs->shapes, vector_size(cs->shapes) - 2));
                 }
                 else
@@ -377,8 +470,8 @@ int main(void)
             }
             else if (input_is_key_released(SDL_SCANCODE_ESCAPE) || (input_is_mouse_button_pressed(SDL_BUTTON_LEFT) && !coordinate_system_is_hovered(cs, vector2_from_point(input_get_mouse_position()))))
             {
-                shape_destroy(cs, vector_pop_back(cs->shapes));
-                shape_destroy(cs, vector_pop_back(cs->shapes));
+                coordinate_system_destroy_shape(cs, vector_get(cs->shapes, vector_size(cs->shapes) - 1));
+                coordinate_system_destroy_shape(cs, vector_get(cs->shapes, vector_size(cs->shapes) - 1));
                 coordinate_system_deselect_shapes(cs);
                 state = STATE_PARALLEL;
             }
@@ -421,6 +514,7 @@ int main(void)
                     coordinate_system_deselect_shapes(cs);
                     Perpendicular* perpendicular = (Perpendicular*)vector_get(cs->shapes, vector_size(cs->shapes) - 1);
                     perpendicular->point = (Point*)hovered_shape;
+                    coordinate_system_shape_changed(cs, (Shape*)perpendicular);
                     coordinate_system_destroy_shape(cs, vector_get(cs->shapes, vector_size(cs->shapes) - 2));
                 }
                 else
@@ -439,8 +533,8 @@ int main(void)
             }
             else if (input_is_key_released(SDL_SCANCODE_ESCAPE) || (input_is_mouse_button_pressed(SDL_BUTTON_LEFT) && !coordinate_system_is_hovered(cs, vector2_from_point(input_get_mouse_position()))))
             {
-                shape_destroy(cs, vector_pop_back(cs->shapes));
-                shape_destroy(cs, vector_pop_back(cs->shapes));
+                coordinate_system_destroy_shape(cs, vector_get(cs->shapes, vector_size(cs->shapes) - 1));
+                coordinate_system_destroy_shape(cs, vector_get(cs->shapes, vector_size(cs->shapes) - 1));
                 coordinate_system_deselect_shapes(cs);
                 state = STATE_PERPENDICULAR;
             }
@@ -480,6 +574,7 @@ int main(void)
                     coordinate_system_deselect_shapes(cs);
                     AngleBisector* angle_bisector = (AngleBisector*)vector_get(cs->shapes, vector_size(cs->shapes) - 1);
                     angle_bisector->line2 = (Line*)hovered_shape;
+                    coordinate_system_shape_changed(cs, (Shape*)angle_bisector);
                 }
             }
             else if (input_is_mouse_button_released(SDL_BUTTON_LEFT))
@@ -490,7 +585,7 @@ int main(void)
             }
             else if (input_is_key_released(SDL_SCANCODE_ESCAPE) || (input_is_mouse_button_pressed(SDL_BUTTON_LEFT) && !coordinate_system_is_hovered(cs, vector2_from_point(input_get_mouse_position()))))
             {
-                shape_destroy(cs, vector_pop_back(cs->shapes));
+                coordinate_system_destroy_shape(cs, vector_get(cs->shapes, vector_size(cs->shapes) - 1));
                 coordinate_system_deselect_shapes(cs);
                 state = STATE_ANGLE_BISECTOR;
             }
@@ -533,6 +628,7 @@ int main(void)
                     coordinate_system_deselect_shapes(cs);
                     Tangent* tangent = (Tangent*)vector_get(cs->shapes, vector_size(cs->shapes) - 1);
                     tangent->point = (Point*)hovered_shape;
+                    coordinate_system_shape_changed(cs, (Shape*)tangent);
                     coordinate_system_destroy_shape(cs, vector_get(cs->shapes, vector_size(cs->shapes) - 2));
                 }
                 else
@@ -551,8 +647,8 @@ int main(void)
             }
             else if (input_is_key_released(SDL_SCANCODE_ESCAPE) || (input_is_mouse_button_pressed(SDL_BUTTON_LEFT) && !coordinate_system_is_hovered(cs, vector2_from_point(input_get_mouse_position()))))
             {
-                shape_destroy(cs, vector_pop_back(cs->shapes));
-                shape_destroy(cs, vector_pop_back(cs->shapes));
+                coordinate_system_destroy_shape(cs, vector_get(cs->shapes, vector_size(cs->shapes) - 1));
+                coordinate_system_destroy_shape(cs, vector_get(cs->shapes, vector_size(cs->shapes) - 1));
                 coordinate_system_deselect_shapes(cs);
                 state = STATE_TANGENT;
             }
@@ -560,16 +656,18 @@ int main(void)
 
         case STATE_SAVEING:
             if (input_is_key_released(SDL_SCANCODE_ESCAPE))
+            {
+                ui_hide_element((UIElement*)save_container);
                 state = STATE_POINTER;
-            else
-                ui_show_element((UIElement*)save_container);
+            }
             break;
         
         case STATE_OPENING:
             if (input_is_key_released(SDL_SCANCODE_ESCAPE))
+            {
+                ui_hide_element((UIElement*)open_container);
                 state = STATE_POINTER;
-            else
-                ui_show_element((UIElement*)open_container);
+            }
             break;
         }
         
@@ -581,7 +679,20 @@ int main(void)
                 on_filemenu_clicked(file_sb, 0);
             else if (input_is_key_pressed(SDL_SCANCODE_S))
                 on_filemenu_clicked(file_sb, 1);
+            else if (input_is_key_pressed(SDL_SCANCODE_E))
+                on_filemenu_clicked(file_sb, input_is_key_down(SDL_SCANCODE_LSHIFT) || input_is_key_down(SDL_SCANCODE_RSHIFT) ? 3 : 2);
+        }
+        else if (input_is_key_pressed(SDL_SCANCODE_F3))
+            profiler_toggle();
+#ifdef GAEGEBRA_TRACE
+        else if (input_is_key_pressed(SDL_SCANCODE_F4))
+        {
+            if (trace_is_running())
+                trace_stop();
+            else
+                trace_start(TRACE_FILE);
         }
+#endif
         else if (input_is_key_pressed(SDL_SCANCODE_ESCAPE))
             coordinate_system_deselect_shapes(cs);
         else if (input_is_key_released(SDL_SCANCODE_DELETE))
@@ -596,20 +707,28 @@ int main(void)
         }
 
         coordinate_system_zoom(cs, 1.0 + input_get_mouse_wheel_delta() / 100.0 * MOUSE_WHEEL_SENSITIVITY);
-        coordinate_system_update(cs);       
-        
-        //draw
-        app_set_target(window);
-        renderer_clear(WHITE);
-        coordinate_system_draw(cs);
+        if (state == STATE_CS_DRAGGED || state == STATE_BOX_SELECTING || state == STATE_LASSO_SELECTING)
+            app_request_redraw();
+        if (app_needs_redraw())
+        {
+            //only the dragged shapes move, the others are not visited
+            coordinate_system_drag(cs, vector2_from_point(input_get_mouse_motion()));
+            coordinate_system_update(cs);
+
+            //draw
+            app_set_target(window);
+            renderer_clear(WHITE);
+            coordinate_system_draw(cs);
+            draw_region_selection();
+            draw_task_progress();
+            profiler_draw(10, 90);
+        }
         
-        //fps (temporary)
-        //static char buffer[10];
-        //sprintf(buffer, "Fps: %.0lf", 1.0 / app_get_delta_time());
-        //renderer_draw_text(buffer, 10, 90, BLACK);
-
         app_render();
     }
+    if (replaying)
+        replay_print_stats();
+    cancel_tasks();
     coordinate_system_destroy(cs);
     SDL_FreeCursor(cursor_hand);
 
@@ -666,11 +785,15 @@ void on_open_button_clicked(UIButton* self)
         free(new_path);
         return;
     }
-    new_cs->position = cs->position;
-    new_cs->size = cs->size;
     new_cs->origin = vector2_create(0.5, 0.5);
+    coordinate_system_update_dimensions(new_cs, cs->position, cs->size);
+    cancel_tasks();
     coordinate_system_destroy(cs);
     cs = new_cs;
+    //a large construction would block the first frame, so its intersections are calculated a few blocks per frame
+    coordinate_system_begin_intersections(cs);
+    intersection_task = app_add_task("intersection rebuild", intersection_task_step, cs);
+    autosave_version = coordinate_system_get_version(cs);
     ui_hide_element((UIElement*)self->base.parent->parent);
     state = STATE_POINTER;
 
@@ -700,10 +823,23 @@ void on_cancel_button_clicked(UIButton* self)
 
 void on_filemenu_clicked(UISplitButton* self __attribute__((unused)), Sint32 index __attribute__((unused)))
 {
+    //the dialogs are shown once, an open dialog that is not used lets the main loop idle
     if (index == 0)
+    {
+        ui_hide_element((UIElement*)save_container);
+        ui_show_element((UIElement*)open_container);
         state = STATE_OPENING;
+    }
     else if (index == 1)
+    {
+        ui_hide_element((UIElement*)open_container);
+        ui_show_element((UIElement*)save_container);
         state = STATE_SAVEING;
+    }
+    else if (index == 2)
+        coordinate_system_export(cs, EXPORT_FILE, cs->size.x, cs->size.y);
+    else if (index == 3)
+        coordinate_system_export_svg(cs, EXPORT_SVG_FILE, cs->size.x, cs->size.y);
 }
 void on_editmenu_clicked(UISplitButton* self __attribute__((unused)), Sint32 index __attribute__((unused)))
 {
@@ -716,4 +852,114 @@ void on_canvas_size_changed(UIContainer* self, SDL_Point size)
 {
     coordinate_system_update_dimensions(cs, vector2_create(self->base.position.x, self->base.position.y),
                                             vector2_create(size.x, size.y));
+}
+
+static size_t _region_polygon(Vector2* polygon)
+{
+    Vector2 mouse = vector2_from_point(input_get_mouse_position());
+    if (state == STATE_BOX_SELECTING)
+    {
+        polygon[0] = region_points[0];
+        polygon[1] = vector2_create(mouse.x, region_points[0].y);
+        polygon[2] = mouse;
+        polygon[3] = vector2_create(region_points[0].x, mouse.y);
+        return 4;
+    }
+    memcpy(polygon, region_points, sizeof(Vector2) * region_point_count);
+    polygon[region_point_count] = mouse;
+    return region_point_count + 1;
+}
+void update_region_selection(void)
+{
+    Vector2 mouse = vector2_from_point(input_get_mouse_position());
+    if (state == STATE_LASSO_SELECTING && region_point_count < LASSO_MAX_POINTS - 1 &&
+        vector2_distance(mouse, region_points[region_point_count - 1]) >= LASSO_POINT_DISTANCE)
+        region_points[region_point_count++] = mouse;
+
+    //the selection follows the region while it is dragged, Ctrl also selects the lines and circles crossing it
+    //(it is only queried again when the region or the mode has changed)
+    static Vector2 last_mouse;
+    static size_t last_point_count;
+    static bool last_crossing;
+    bool crossing = input_is_key_down(SDL_SCANCODE_LCTRL) || input_is_key_down(SDL_SCANCODE_RCTRL);
+    if (region_selection_valid && mouse.x == last_mouse.x && mouse.y == last_mouse.y && region_point_count == last_point_count && crossing == last_crossing)
+        return;
+    region_selection_valid = true;
+    last_mouse = mouse;
+    last_point_count = region_point_count;
+    last_crossing = crossing;
+
+    static Vector2 polygon[LASSO_MAX_POINTS];
+    size_t vertex_count = _region_polygon(polygon);
+    coordinate_system_deselect_shapes(cs);
+    coordinate_system_select_region(cs, polygon, vertex_count, crossing);
+}
+void draw_region_selection(void)
+{
+    if (state != STATE_BOX_SELECTING && state != STATE_LASSO_SELECTING)
+        return;
+    static Vector2 polygon[LASSO_MAX_POINTS];
+    static short vx[LASSO_MAX_POINTS], vy[LASSO_MAX_POINTS];
+    size_t vertex_count = _region_polygon(polygon);
+    for (size_t i = 0; i < vertex_count; i++)
+    {
+        vx[i] = (short)polygon[i].x;
+        vy[i] = (short)polygon[i].y;
+    }
+    bool crossing = input_is_key_down(SDL_SCANCODE_LCTRL) || input_is_key_down(SDL_SCANCODE_RCTRL);
+    Color color = crossing ? color_from_rgb(0, 160, 0) : color_from_rgb(0, 90, 220);
+    renderer_draw_filled_polygon(vx, vy, (int)vertex_count, color_fade(color, 0.15));
+    renderer_draw_polygon(vx, vy, (int)vertex_count, color);
+}
+
+bool intersection_task_step(void* data, double* progress)
+{
+    bool finished = coordinate_system_step_intersections((CoordinateSystem*)data, progress);
+    if (finished)
+        intersection_task = NULL;
+    return finished;
+}
+bool autosave_task_step(void* data, double* progress)
+{
+    bool finished = coordinate_system_save_step((CoordinateSystemSaver*)data, progress);
+    if (finished)
+    {
+        autosave = NULL;
+        autosave_task = NULL;
+    }
+    return finished;
+}
+void update_autosave(void)
+{
+    //the construction is saved every AUTOSAVE_INTERVAL seconds if it has changed, a few shapes per frame
+    double time = app_get_time();
+    if (autosave_task != NULL || time - autosave_time < AUTOSAVE_INTERVAL)
+        return;
+    autosave_time = time;
+    if (coordinate_system_get_version(cs) == autosave_version)
+        return;
+    autosave = coordinate_system_save_begin(cs, AUTOSAVE_FILE);
+    if (autosave == NULL)
+        return;
+    autosave_version = coordinate_system_get_version(cs);
+    autosave_task = app_add_task("autosave", autosave_task_step, autosave);
+}
+void cancel_tasks(void)
+{
+    //the tasks refer to the coordinate system, so they have to be stopped before it is destroyed
+    app_remove_task(intersection_task);
+    intersection_task = NULL;
+    app_remove_task(autosave_task);
+    autosave_task = NULL;
+    coordinate_system_save_cancel(autosave);
+    autosave = NULL;
+}
+void draw_task_progress(void)
+{
+    size_t task_count = app_get_pending_task_count();
+    if (task_count == 0)
+        return;
+    char text[64];
+    snprintf(text, sizeof(text), "Working... %d%% (%d %s)", (int)(app_get_task_progress() * 100.0), (int)task_count, task_count == 1 ? "task" : "tasks");
+    renderer_draw_text(text, (int)cs->position.x + 10, (int)(cs->position.y + cs->size.y) - 30, DARK_GRAY);
 }
\ No newline at end of file
@@ -0,0 +1,149 @@
+#include "profiler.h"
+#include "../app/app.h"
+#include "../color/color.h"
+#include "../renderer/renderer.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const char* stage_names[PS_COUNT] = {
+    "Input",
+    "Shape update",
+    "Intersections",
+    "Shape draw",
+    "UI update",
+    "Tasks",
+    "UI render",
+    "Present"
+};
+static const char* counter_names[PC_COUNT] = {
+    "Shapes",
+    "Intersections",
+    "Draw calls",
+    "Pending tasks"
+};
+
+static Uint64 stage_start[PS_COUNT];
+static Uint64 stage_ticks[PS_COUNT];
+static double samples[PS_COUNT][PROFILER_SAMPLE_COUNT];
+static size_t sample_count = 0;
+static size_t sample_index = 0;
+static Uint64 counters[PC_COUNT];
+static Uint64 last_counters[PC_COUNT];
+static bool shown = false;
+
+static int _profiler_compare_samples(const void* a, const void* b)
+{
+    double x = *(const double*)a;
+    double y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+void profiler_begin(ProfilerStage stage)
+{
+    stage_start[stage] = SDL_GetPerformanceCounter();
+}
+void profiler_end(ProfilerStage stage)
+{
+    stage_ticks[stage] += SDL_GetPerformanceCounter() - stage_start[stage];
+}
+void profiler_set_counter(ProfilerCounter counter, Uint64 value)
+{
+    counters[counter] = value;
+}
+void profiler_add_counter(ProfilerCounter counter, Uint64 amount)
+{
+    counters[counter] += amount;
+}
+ProfilerStageStats profiler_get_stage_stats(ProfilerStage stage)
+{
+    ProfilerStageStats stats = { 0.0, 0.0, 0.0, 0.0 };
+    if (sample_count == 0)
+        return stats;
+
+    double sorted[PROFILER_SAMPLE_COUNT];
+    memcpy(sorted, samples[stage], sizeof(double) * sample_count);
+    qsort(sorted, sample_count, sizeof(double), _profiler_compare_samples);
+
+    double sum = 0.0;
+    for (size_t i = 0; i < sample_count; i++)
+        sum += sorted[i];
+    stats.min = sorted[0];
+    stats.avg = sum / sample_count;
+    stats.p99 = sorted[(sample_count * 99 - 1) / 100];
+    stats.last = samples[stage][(sample_index + PROFILER_SAMPLE_COUNT - 1) % PROFILER_SAMPLE_COUNT];
+    return stats;
+}
+Uint64 profiler_get_counter(ProfilerCounter counter)
+{
+    return last_counters[counter];
+}
+void profiler_toggle()
+{
+    shown = !shown;
+}
+bool profiler_is_shown()
+{
+    return shown;
+}
+void profiler_draw(int x, int y)
+{
+    if (!shown)
+        return;
+
+    const int line_height = renderer_query_text_size("0").y;
+    const int column_width = 70;
+    const int name_width = 130;
+    const int width = name_width + 3 * column_width + 20;
+    const int height = (PS_COUNT + PC_COUNT + 3) * line_height + 20;
+    renderer_draw_filled_rounded_rect(x, y, width, height, 4, color_fade(BLACK, 0.75));
+
+    char buffer[64];
+    AppFrameStats frame_stats = app_get_frame_stats();
+    snprintf(buffer, sizeof(buffer), "Frame: %.2f ms (%.0f fps)", frame_stats.average_frame_time * 1000.0,
+             frame_stats.delta_time > 0.0 ? 1.0 / frame_stats.delta_time : 0.0);
+    renderer_draw_text(buffer, x + 10, y + 10, WHITE);
+
+    int line_y = y + 10 + line_height;
+    renderer_draw_text("Stage (ms)", x + 10, line_y, GRAY);
+    renderer_draw_text("min", x + 10 + name_width, line_y, GRAY);
+    renderer_draw_text("avg", x + 10 + name_width + column_width, line_y, GRAY);
+    renderer_draw_text("p99", x + 10 + name_width + 2 * column_width, line_y, GRAY);
+    for (int i = 0; i < PS_COUNT; i++)
+    {
+        line_y += line_height;
+        ProfilerStageStats stats = profiler_get_stage_stats((ProfilerStage)i);
+        renderer_draw_text(stage_names[i], x + 10, line_y, WHITE);
+        snprintf(buffer, sizeof(buffer), "%.2f", stats.min);
+        renderer_draw_text(buffer, x + 10 + name_width, line_y, WHITE);
+        snprintf(buffer, sizeof(buffer), "%.2f", stats.avg);
+        renderer_draw_text(buffer, x + 10 + name_width + column_width, line_y, WHITE);
+        snprintf(buffer, sizeof(buffer), "%.2f", stats.p99);
+        renderer_draw_text(buffer, x + 10 + name_width + 2 * column_width, line_y, WHITE);
+    }
+    line_y += line_height;
+    for (int i = 0; i < PC_COUNT; i++)
+    {
+        line_y += line_height;
+        renderer_draw_text(counter_names[i], x + 10, line_y, WHITE);
+        snprintf(buffer, sizeof(buffer), "%llu", (unsigned long long)last_counters[i]);
+        renderer_draw_text(buffer, x + 10 + name_width, line_y, WHITE);
+    }
+}
+
+void _profiler_end_frame()
+{
+    double frequency = (double)SDL_GetPerformanceFrequency();
+    for (int i = 0; i < PS_COUNT; i++)
+    {
+        samples[i][sample_index] = stage_ticks[i] * 1000.0 / frequency;
+        stage_ticks[i] = 0;
+    }
+    sample_index = (sample_index + 1) % PROFILER_SAMPLE_COUNT;
+    if (sample_count < PROFILER_SAMPLE_COUNT)
+        sample_count++;
+
+    memcpy(last_counters, counters, sizeof(counters));
+    counters[PC_DRAW_CALLS] = 0;
+}
@@ -0,0 +1,116 @@
+#pragma once
+
+#ifdef _WIN32
+    #include <SDL.h>
+#elif defined(__unix__) || defined(__linux__)
+    #include <SDL2/SDL.h>
+#endif
+
+#include <stdbool.h>
+
+#define PROFILER_SAMPLE_COUNT 120
+
+/**
+ * @brief The measured stages of a frame
+ */
+typedef enum ProfilerStage
+{
+    PS_INPUT,
+    PS_SHAPE_UPDATE,
+    PS_INTERSECTIONS,
+    PS_SHAPE_DRAW,
+    PS_UI_UPDATE,
+    PS_TASKS,
+    PS_UI_RENDER,
+    PS_PRESENT,
+
+    PS_COUNT
+} ProfilerStage;
+
+/**
+ * @brief The counters that are shown next to the stage timings
+ */
+typedef enum ProfilerCounter
+{
+    PC_SHAPES,
+    PC_INTERSECTIONS,
+    PC_DRAW_CALLS,
+    PC_PENDING_TASKS,
+
+    PC_COUNT
+} ProfilerCounter;
+
+/**
+ * @brief Rolling statistics of a stage (times are in milliseconds)
+ */
+typedef struct ProfilerStageStats
+{
+    double min;
+    double avg;
+    double p99;
+    double last;
+} ProfilerStageStats;
+
+/**
+ * @brief Starts measuring a stage (a stage can be measured multiple times per frame, the times are added up)
+ *
+ * @param stage The stage to measure
+ */
+void profiler_begin(ProfilerStage stage);
+/**
+ * @brief Stops measuring a stage
+ *
+ * @param stage The stage that was measured
+ */
+void profiler_end(ProfilerStage stage);
+/**
+ * @brief Sets the value of a counter for the current frame
+ *
+ * @param counter The counter to set
+ * @param value The value of the counter
+ */
+void profiler_set_counter(ProfilerCounter counter, Uint64 value);
+/**
+ * @brief Adds to the value of a counter for the current frame
+ *
+ * @param counter The counter to increase
+ * @param amount The amount to add
+ */
+void profiler_add_counter(ProfilerCounter counter, Uint64 amount);
+/**
+ * @brief Returns the rolling statistics of a stage over the last PROFILER_SAMPLE_COUNT frames
+ *
+ * @param stage The stage to get the statistics of
+ * @return ProfilerStageStats The statistics
+ */
+ProfilerStageStats profiler_get_stage_stats(ProfilerStage stage);
+/**
+ * @brief Returns the value of a counter in the last finished frame
+ *
+ * @param counter The counter to get
+ * @return Uint64 The value of the counter
+ */
+Uint64 profiler_get_counter(ProfilerCounter counter);
+/**
+ * @brief Shows or hides the profiler overlay
+ */
+void profiler_toggle();
+/**
+ * @brief Checks if the profiler overlay is shown
+ *
+ * @return true If the overlay is shown
+ * @return false If the overlay is hidden
+ */
+bool profiler_is_shown();
+/**
+ * @brief Draws the profiler overlay to the target renderer (does nothing if the overlay is hidden)
+ *
+ * @param x The x coordinate of the overlay
+ * @param y The y coordinate of the overlay
+ */
+void profiler_draw(int x, int y);
+
+/**
+ * @brief Stores the measurements of the current frame and starts a new one (should not be called manually)
+ */
+void _profiler_end_frame();
@@ -0,0 +1,251 @@
+#include "png_writer.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define PNG_MAX_MATCH 258
+#define PNG_ADLER_MOD 65521
+#define PNG_FILTER_UP 2
+
+static const Uint16 length_bases[] = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+static const Uint8 length_extra_bits[] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+
+static Uint32 crc_table[256];
+static bool crc_table_ready = false;
+
+static Uint32 _png_crc(Uint32 crc, const Uint8* data, size_t size)
+{
+    if (!crc_table_ready)
+    {
+        for (Uint32 i = 0; i < 256; i++)
+        {
+            Uint32 c = i;
+            for (int k = 0; k < 8; k++)
+                c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            crc_table[i] = c;
+        }
+        crc_table_ready = true;
+    }
+    for (size_t i = 0; i < size; i++)
+        crc = crc_table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    return crc;
+}
+static void _png_put_u32(Uint8* data, Uint32 value)
+{
+    data[0] = (Uint8)(value >> 24);
+    data[1] = (Uint8)(value >> 16);
+    data[2] = (Uint8)(value >> 8);
+    data[3] = (Uint8)value;
+}
+static void _png_write_chunk(PngWriter* writer, const char* type, const Uint8* data, size_t size)
+{
+    Uint8 header[8];
+    _png_put_u32(header, (Uint32)size);
+    memcpy(header + 4, type, 4);
+    Uint8 crc[4];
+    _png_put_u32(crc, _png_crc(_png_crc(0xFFFFFFFFu, header + 4, 4), data, size) ^ 0xFFFFFFFFu);
+    if (fwrite(header, 1, 8, writer->file) != 8 || (size > 0 && fwrite(data, 1, size, writer->file) != size) || fwrite(crc, 1, 4, writer->file) != 4)
+        writer->failed = true;
+}
+
+static void _png_put_byte(PngWriter* writer, Uint8 byte)
+{
+    writer->chunk[writer->chunk_size++] = byte;
+    if (writer->chunk_size == PNG_WRITER_CHUNK_SIZE)
+    {
+        _png_write_chunk(writer, "IDAT", writer->chunk, writer->chunk_size);
+        writer->chunk_size = 0;
+    }
+}
+static void _png_put_bits(PngWriter* writer, Uint32 value, int count)
+{
+    //deflate packs the bits starting from the least significant one
+    writer->bit_buffer |= (Uint64)value << writer->bit_count;
+    writer->bit_count += count;
+    while (writer->bit_count >= 8)
+    {
+        _png_put_byte(writer, (Uint8)writer->bit_buffer);
+        writer->bit_buffer >>= 8;
+        writer->bit_count -= 8;
+    }
+}
+static void _png_put_code(PngWriter* writer, Uint32 code, int length)
+{
+    //the Huffman codes are stored from the most significant bit
+    Uint32 reversed = 0;
+    for (int i = 0; i < length; i++)
+        reversed |= ((code >> i) & 1) << (length - 1 - i);
+    _png_put_bits(writer, reversed, length);
+}
+static void _png_put_symbol(PngWriter* writer, int symbol)
+{
+    //fixed Huffman codes of the literal/length alphabet
+    if (symbol < 144)
+        _png_put_code(writer, 0x30 + symbol, 8);
+    else if (symbol < 256)
+        _png_put_code(writer, 0x190 + symbol - 144, 9);
+    else if (symbol < 280)
+        _png_put_code(writer, symbol - 256, 7);
+    else
+        _png_put_code(writer, 0xC0 + symbol - 280, 8);
+}
+static void _png_put_match(PngWriter* writer, int length, int distance)
+{
+    int index = 28;
+    while (length_bases[index] > length)
+        index--;
+    _png_put_symbol(writer, 257 + index);
+    _png_put_bits(writer, length - length_bases[index], length_extra_bits[index]);
+    //the distances 1 to 4 are the distance codes 0 to 3 without extra bits
+    _png_put_code(writer, distance - 1, 5);
+}
+static void _png_compress(PngWriter* writer, const Uint8* data, size_t size)
+{
+    Uint32 a = writer->adler_a, b = writer->adler_b;
+    for (size_t i = 0; i < size; i++)
+    {
+        a += data[i];
+        b += a;
+        if ((i & 4095) == 4095)
+        {
+            a %= PNG_ADLER_MOD;
+            b %= PNG_ADLER_MOD;
+        }
+    }
+    writer->adler_a = a % PNG_ADLER_MOD;
+    writer->adler_b = b % PNG_ADLER_MOD;
+
+    static const int distances[] = { 1, 4 };
+    size_t i = 0;
+    while (i < size)
+    {
+        int best_length = 0, best_distance = 0;
+        for (int d = 0; d < 2; d++)
+        {
+            size_t distance = distances[d];
+            if (i < distance)
+                continue;
+            int length = 0;
+            while (length < PNG_MAX_MATCH && i + length < size && data[i + length] == data[i + length - distance])
+                length++;
+            if (length > best_length)
+            {
+                best_length = length;
+                best_distance = (int)distance;
+            }
+        }
+        if (best_length >= 3)
+        {
+            _png_put_match(writer, best_length, best_distance);
+            i += best_length;
+        }
+        else
+            _png_put_symbol(writer, data[i++]);
+    }
+}
+
+PngWriter* png_writer_open(const char* path, int width, int height)
+{
+    if (width <= 0 || height <= 0)
+        return NULL;
+    FILE* file = fopen(path, "wb");
+    if (file == NULL)
+    {
+        SDL_Log("couldn't create image: %s", path);
+        return NULL;
+    }
+    PngWriter* writer = (PngWriter*)malloc(sizeof(PngWriter));
+    size_t row_size = (size_t)width * 4;
+    if (writer != NULL)
+    {
+        writer->row = (Uint8*)malloc(row_size);
+        writer->previous_row = (Uint8*)calloc(row_size, 1);
+        writer->filtered_row = (Uint8*)malloc(row_size + 1);
+        writer->chunk = (Uint8*)malloc(PNG_WRITER_CHUNK_SIZE);
+    }
+    if (writer == NULL || writer->row == NULL || writer->previous_row == NULL || writer->filtered_row == NULL || writer->chunk == NULL)
+    {
+        printf("failed to allocate memory for the PNG writer\n");
+        exit(1);
+    }
+    writer->file = file;
+    writer->width = width;
+    writer->height = height;
+    writer->rows_written = 0;
+    writer->failed = false;
+    writer->chunk_size = 0;
+    writer->bit_buffer = 0;
+    writer->bit_count = 0;
+    writer->adler_a = 1;
+    writer->adler_b = 0;
+
+    static const Uint8 signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+    if (fwrite(signature, 1, 8, file) != 8)
+        writer->failed = true;
+    Uint8 header[13];
+    _png_put_u32(header, (Uint32)width);
+    _png_put_u32(header + 4, (Uint32)height);
+    header[8] = 8; //bits per channel
+    header[9] = 6; //RGBA
+    header[10] = 0;
+    header[11] = 0;
+    header[12] = 0;
+    _png_write_chunk(writer, "IHDR", header, sizeof(header));
+
+    //zlib header (deflate, 32K window, no dictionary), then one final block with the fixed Huffman codes for the whole image
+    _png_put_byte(writer, 0x78);
+    _png_put_byte(writer, 0x01);
+    _png_put_bits(writer, 1, 1);
+    _png_put_bits(writer, 1, 2);
+    return writer;
+}
+bool png_writer_write_rows(PngWriter* writer, const Uint32* pixels, int row_count, int pitch)
+{
+    size_t row_size = (size_t)writer->width * 4;
+    for (int y = 0; y < row_count && writer->rows_written < writer->height; y++)
+    {
+        const Uint32* src = pixels + (size_t)y * pitch;
+        for (int x = 0; x < writer->width; x++)
+        {
+            writer->row[4 * x] = (Uint8)src[x];
+            writer->row[4 * x + 1] = (Uint8)(src[x] >> 8);
+            writer->row[4 * x + 2] = (Uint8)(src[x] >> 16);
+            writer->row[4 * x + 3] = (Uint8)(src[x] >> 24);
+        }
+        writer->filtered_row[0] = PNG_FILTER_UP;
+        for (size_t i = 0; i < row_size; i++)
+            writer->filtered_row[i + 1] = (Uint8)(writer->row[i] - writer->previous_row[i]);
+        _png_compress(writer, writer->filtered_row, row_size + 1);
+
+        Uint8* swap = writer->previous_row;
+        writer->previous_row = writer->row;
+        writer->row = swap;
+        writer->rows_written++;
+    }
+    return !writer->failed;
+}
+bool png_writer_close(PngWriter* writer)
+{
+    if (writer == NULL)
+        return false;
+    _png_put_symbol(writer, 256);
+    if (writer->bit_count > 0)
+        _png_put_bits(writer, 0, 8 - writer->bit_count);
+    Uint8 adler[4];
+    _png_put_u32(adler, (writer->adler_b << 16) | writer->adler_a);
+    for (int i = 0; i < 4; i++)
+        _png_put_byte(writer, adler[i]);
+    if (writer->chunk_size > 0)
+        _png_write_chunk(writer, "IDAT", writer->chunk, writer->chunk_size);
+    _png_write_chunk(writer, "IEND", NULL, 0);
+
+    bool success = !writer->failed && writer->rows_written == writer->height;
+    if (fclose(writer->file) != 0)
+        success = false;
+    free(writer->row);
+    free(writer->previous_row);
+    free(writer->filtered_row);
+    free(writer->chunk);
+    free(writer);
+    return success;
+}
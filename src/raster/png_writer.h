@@ -0,0 +1,70 @@
+#pragma once
+
+#ifdef _WIN32
+    #include <SDL.h>
+#elif defined(__unix__) || defined(__linux__)
+    #include <SDL2/SDL.h>
+#endif
+
+#include <stdbool.h>
+#include <stdio.h>
+
+#define PNG_WRITER_CHUNK_SIZE (1 << 16)
+
+/*
+ * Streaming RGBA PNG encoder: the rows are filtered, compressed and written as they arrive, so only two rows and one IDAT chunk are kept in memory.
+ * The compressor is a single fixed Huffman deflate block with runs (distance 1 and 4) on "Up" filtered rows,
+ * which is cheap and works well for the flat colored, mostly empty images of the constructions.
+ */
+
+/**
+ * @brief A PNG file that is being written
+ */
+typedef struct PngWriter
+{
+    FILE* file;
+    int width;
+    int height;
+    int rows_written;
+    bool failed;
+
+    Uint8* row;
+    Uint8* previous_row;
+    Uint8* filtered_row;
+
+    Uint8* chunk;
+    size_t chunk_size;
+    Uint64 bit_buffer;
+    int bit_count;
+    Uint32 adler_a;
+    Uint32 adler_b;
+} PngWriter;
+
+/**
+ * @brief Creates a PNG file and writes its header
+ *
+ * @param path The path of the PNG file
+ * @param width The width of the image
+ * @param height The height of the image
+ * @return PngWriter* The writer (NULL if the file could not be created)
+ */
+PngWriter* png_writer_open(const char* path, int width, int height);
+/**
+ * @brief Writes the next rows of the image (from top to bottom)
+ *
+ * @param writer The writer
+ * @param pixels The pixels of the rows (packed in RASTER_PIXEL_FORMAT, i.e. r | g << 8 | b << 16 | a << 24)
+ * @param row_count The number of rows (the rows after the height of the image are ignored)
+ * @param pitch The distance of the rows in pixels
+ * @return true If the rows were written
+ * @return false If writing to the file failed
+ */
+bool png_writer_write_rows(PngWriter* writer, const Uint32* pixels, int row_count, int pitch);
+/**
+ * @brief Finishes the image, closes the file and destroys the writer
+ *
+ * @param writer The writer
+ * @return true If the whole image was written
+ * @return false If writing failed or not every row was written
+ */
+bool png_writer_close(PngWriter* writer);
@@ -0,0 +1,976 @@
+#include "raster.h"
+
+#ifdef __SSE2__
+    #include <emmintrin.h>
+#endif
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define RASTER_FULL_COVERAGE 0.999f
+#define RASTER_EMPTY_COVERAGE 0.001f
+
+typedef int (*_RasterIntervals)(RasterImage* image, const void* shape, double y);
+
+typedef enum _RasterCommandType
+{
+    RC_CLEAR,
+    RC_PIXEL,
+    RC_LINE,
+    RC_RECT,
+    RC_FILLED_RECT,
+    RC_ELLIPSE,
+    RC_FILLED_ELLIPSE,
+    RC_POLYGON,
+    RC_FILLED_POLYGON,
+    RC_ARC,
+    RC_SURFACE
+} _RasterCommandType;
+
+struct _RasterCommand
+{
+    _RasterCommandType type;
+    Color color;
+    SDL_Rect clip;
+    SDL_Rect bounds;
+    double values[6];
+    double* points;
+    int n;
+    SDL_Surface* surface;
+};
+
+typedef struct _RasterBatch
+{
+    RasterImage* image;
+    int tiles_x;
+    int* tile_offsets;
+    size_t* tile_commands;
+    RasterImage* workers;
+} _RasterBatch;
+
+typedef struct _RasterPolygon
+{
+    const double* x;
+    const double* y;
+    int n;
+    double offset_x;
+    double offset_y;
+} _RasterPolygon;
+
+typedef struct _RasterEllipse
+{
+    double x, y;
+    double outer_rx, outer_ry;
+    double inner_rx, inner_ry;
+} _RasterEllipse;
+
+typedef struct _RasterRect
+{
+    double outer[4];
+    double outer_radius;
+    double inner[4];
+    double inner_radius;
+    bool hollow;
+} _RasterRect;
+
+static inline Uint32 _raster_pack(Color color)
+{
+    return (Uint32)color.r | ((Uint32)color.g << 8) | ((Uint32)color.b << 16) | ((Uint32)color.a << 24);
+}
+static inline Uint32 _raster_blend(Uint32 dst, Uint32 src, Uint32 alpha)
+{
+    //(src * alpha + dst * (255 - alpha)) / 255 per channel, with the same rounding as the SIMD version
+    Uint32 result = 0;
+    for (int shift = 0; shift < 32; shift += 8)
+    {
+        Uint32 t = ((src >> shift) & 0xFF) * alpha + ((dst >> shift) & 0xFF) * (255 - alpha) + 128;
+        result |= ((t + (t >> 8)) >> 8) << shift;
+    }
+    return result;
+}
+static void _raster_fill_span(Uint32* dst, int count, Uint32 value)
+{
+    int i = 0;
+#ifdef __SSE2__
+    __m128i values = _mm_set1_epi32((int)value);
+    for (; i + 4 <= count; i += 4)
+        _mm_storeu_si128((__m128i*)(dst + i), values);
+#endif
+    for (; i < count; i++)
+        dst[i] = value;
+}
+static void _raster_blend_span(Uint32* dst, int count, Uint32 src, Uint32 alpha)
+{
+    //the source is opaque (its alpha is 255), so the destination alpha becomes alpha + dst_alpha * (1 - alpha)
+    src |= 0xFF000000u;
+    if (alpha == 0)
+        return;
+    if (alpha >= 255)
+    {
+        _raster_fill_span(dst, count, src);
+        return;
+    }
+    int i = 0;
+#ifdef __SSE2__
+    __m128i zero = _mm_setzero_si128();
+    __m128i source = _mm_mullo_epi16(_mm_unpacklo_epi8(_mm_set1_epi32((int)src), zero), _mm_set1_epi16((short)alpha));
+    __m128i inverse = _mm_set1_epi16((short)(255 - alpha));
+    __m128i bias = _mm_set1_epi16(128);
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128i pixels = _mm_loadu_si128((__m128i*)(dst + i));
+        __m128i low = _mm_unpacklo_epi8(pixels, zero);
+        __m128i high = _mm_unpackhi_epi8(pixels, zero);
+        low = _mm_add_epi16(_mm_add_epi16(_mm_mullo_epi16(low, inverse), source), bias);
+        high = _mm_add_epi16(_mm_add_epi16(_mm_mullo_epi16(high, inverse), source), bias);
+        low = _mm_srli_epi16(_mm_add_epi16(low, _mm_srli_epi16(low, 8)), 8);
+        high = _mm_srli_epi16(_mm_add_epi16(high, _mm_srli_epi16(high, 8)), 8);
+        _mm_storeu_si128((__m128i*)(dst + i), _mm_packus_epi16(low, high));
+    }
+#endif
+    for (; i < count; i++)
+        dst[i] = _raster_blend(dst[i], src, alpha);
+}
+static void _raster_reserve_crossings(RasterImage* image, int count)
+{
+    if (count <= image->crossing_capacity)
+        return;
+    while (image->crossing_capacity < count)
+        image->crossing_capacity *= 2;
+    image->crossings = (double*)realloc(image->crossings, sizeof(double) * image->crossing_capacity);
+    if (image->crossings == NULL)
+    {
+        printf("failed to allocate memory for the rasterizer\n");
+        exit(1);
+    }
+}
+
+static void _raster_create_scratch(RasterImage* image)
+{
+    image->coverage = (float*)calloc(image->width + 2, sizeof(float));
+    image->delta = (float*)calloc(image->width + 2, sizeof(float));
+    image->crossing_capacity = 16;
+    image->crossings = (double*)malloc(sizeof(double) * image->crossing_capacity);
+    image->span_capacity = 16;
+    image->spans = (int*)malloc(sizeof(int) * 2 * image->span_capacity);
+    if (image->coverage == NULL || image->delta == NULL || image->crossings == NULL || image->spans == NULL)
+    {
+        printf("failed to allocate memory for the rasterizer\n");
+        exit(1);
+    }
+}
+static void _raster_destroy_scratch(RasterImage* image)
+{
+    free(image->coverage);
+    free(image->delta);
+    free(image->crossings);
+    free(image->spans);
+}
+
+static _RasterCommand* _raster_record(RasterImage* image, _RasterCommandType type, Color color, double left, double top, double right, double bottom)
+{
+    //the bounds only decide which tiles get the command, so they are padded for the anti-aliased edges
+    left = SDL_max(left - 2.0, (double)image->clip.x);
+    top = SDL_max(top - 2.0, (double)image->clip.y);
+    right = SDL_min(right + 2.0, (double)(image->clip.x + image->clip.w));
+    bottom = SDL_min(bottom + 2.0, (double)(image->clip.y + image->clip.h));
+    if (!(right > left) || !(bottom > top))
+        return NULL;
+
+    if (image->command_count == image->command_capacity)
+    {
+        image->command_capacity = image->command_capacity == 0 ? 256 : image->command_capacity * 2;
+        image->commands = (_RasterCommand*)realloc(image->commands, sizeof(_RasterCommand) * image->command_capacity);
+        if (image->commands == NULL)
+        {
+            printf("failed to allocate memory for the raster commands\n");
+            exit(1);
+        }
+    }
+    _RasterCommand* command = &image->commands[image->command_count++];
+    memset(command, 0, sizeof(_RasterCommand));
+    command->type = type;
+    command->color = color;
+    command->clip = image->clip;
+    command->bounds.x = (int)floor(left);
+    command->bounds.y = (int)floor(top);
+    command->bounds.w = (int)ceil(right) - command->bounds.x;
+    command->bounds.h = (int)ceil(bottom) - command->bounds.y;
+    return command;
+}
+static void _raster_record_polygon(RasterImage* image, _RasterCommandType type, const double* vx, const double* vy, int n, Color color)
+{
+    if (n <= 0)
+        return;
+    double left = vx[0], top = vy[0], right = vx[0], bottom = vy[0];
+    for (int i = 1; i < n; i++)
+    {
+        left = SDL_min(left, vx[i]);
+        top = SDL_min(top, vy[i]);
+        right = SDL_max(right, vx[i]);
+        bottom = SDL_max(bottom, vy[i]);
+    }
+    double origin_x = image->origin.x, origin_y = image->origin.y;
+    _RasterCommand* command = _raster_record(image, type, color, left - origin_x, top - origin_y, right - origin_x + 1.0, bottom - origin_y + 1.0);
+    if (command == NULL)
+        return;
+    command->points = (double*)malloc(sizeof(double) * 2 * n);
+    if (command->points == NULL)
+    {
+        printf("failed to allocate memory for the raster commands\n");
+        exit(1);
+    }
+    for (int i = 0; i < n; i++)
+    {
+        command->points[i] = vx[i] - origin_x;
+        command->points[n + i] = vy[i] - origin_y;
+    }
+    command->n = n;
+}
+static void _raster_blend_surface(RasterImage* image, SDL_Surface* surface, int x, int y)
+{
+    SDL_Rect rect = { x, y, surface->w, surface->h };
+    SDL_Rect clipped;
+    if (!SDL_IntersectRect(&rect, &image->clip, &clipped))
+        return;
+    SDL_LockSurface(surface);
+    for (int row = clipped.y; row < clipped.y + clipped.h; row++)
+    {
+        const Uint32* src = (const Uint32*)((const Uint8*)surface->pixels + (size_t)(row - y) * surface->pitch) + (clipped.x - x);
+        Uint32* dst = image->pixels + (size_t)row * image->width + clipped.x;
+        for (int i = 0; i < clipped.w; i++)
+            dst[i] = _raster_blend(dst[i], src[i] | 0xFF000000u, src[i] >> 24);
+    }
+    SDL_UnlockSurface(surface);
+}
+static void _raster_reserve_spans(RasterImage* image, int count)
+{
+    if (count <= image->span_capacity)
+        return;
+    while (image->span_capacity < count)
+        image->span_capacity *= 2;
+    image->spans = (int*)realloc(image->spans, sizeof(int) * 2 * image->span_capacity);
+    if (image->spans == NULL)
+    {
+        printf("failed to allocate memory for the rasterizer\n");
+        exit(1);
+    }
+}
+
+static bool _raster_accumulate(RasterImage* image, double left, double right, int* span)
+{
+    double clip_left = image->clip.x;
+    double clip_right = image->clip.x + image->clip.w;
+    if (left < clip_left)
+        left = clip_left;
+    if (right > clip_right)
+        right = clip_right;
+    if (!(right > left))
+        return false;
+
+    //the partially covered end pixels get their exact coverage, the pixels between them are added with a delta (prefix sum)
+    const float weight = 1.0f / RASTER_SUBSAMPLES;
+    int il = (int)left;
+    int ir = (int)right;
+    if (il == ir)
+        image->coverage[il] += (float)(right - left) * weight;
+    else
+    {
+        image->coverage[il] += (float)(il + 1 - left) * weight;
+        image->delta[il + 1] += weight;
+        image->delta[ir] -= weight;
+        image->coverage[ir] += (float)(right - ir) * weight;
+    }
+    span[0] = il;
+    span[1] = ir;
+    return true;
+}
+static void _raster_resolve_row(RasterImage* image, int y, int x0, int x1, Color color)
+{
+    float* coverage = image->coverage;
+    float* delta = image->delta;
+    float run = 0.0f;
+    for (int x = x0; x <= x1; x++)
+    {
+        run += delta[x];
+        delta[x] = 0.0f;
+        coverage[x] += run;
+    }
+
+    Uint32* row = image->pixels + (size_t)y * image->width;
+    Uint32 src = _raster_pack(color);
+    int end = SDL_min(x1, image->clip.x + image->clip.w - 1);
+    int x = x0;
+    while (x <= end)
+    {
+        if (coverage[x] >= RASTER_FULL_COVERAGE)
+        {
+            int start = x;
+            while (x <= end && coverage[x] >= RASTER_FULL_COVERAGE)
+                coverage[x++] = 0.0f;
+            _raster_blend_span(row + start, x - start, src, color.a);
+            continue;
+        }
+        if (coverage[x] > RASTER_EMPTY_COVERAGE)
+        {
+            Uint32 alpha = (Uint32)(color.a * SDL_min(coverage[x], 1.0f) + 0.5f);
+            row[x] = _raster_blend(row[x], src | 0xFF000000u, alpha);
+        }
+        coverage[x++] = 0.0f;
+    }
+    for (; x <= x1; x++)
+        coverage[x] = 0.0f;
+}
+static void _raster_resolve_spans(RasterImage* image, int y, int count, Color color)
+{
+    //only the touched pixels are resolved (e.g. the inside of a large circle outline is skipped),
+    //the overlapping spans are merged, because their deltas cancel out only together
+    int* spans = image->spans;
+    for (int i = 1; i < count; i++)
+    {
+        int start = spans[2 * i], end = spans[2 * i + 1];
+        int k = i;
+        while (k > 0 && spans[2 * (k - 1)] > start)
+        {
+            spans[2 * k] = spans[2 * (k - 1)];
+            spans[2 * k + 1] = spans[2 * (k - 1) + 1];
+            k--;
+        }
+        spans[2 * k] = start;
+        spans[2 * k + 1] = end;
+    }
+    int i = 0;
+    while (i < count)
+    {
+        int start = spans[2 * i], end = spans[2 * i + 1];
+        for (i++; i < count && spans[2 * i] <= end; i++)
+            end = SDL_max(end, spans[2 * i + 1]);
+        _raster_resolve_row(image, y, start, end, color);
+    }
+}
+static void _raster_fill(RasterImage* image, double top, double bottom, _RasterIntervals intervals, const void* shape, Color color)
+{
+    if (color.a == 0 || !isfinite(top) || !isfinite(bottom))
+        return;
+    int y0 = (int)SDL_max(floor(top), (double)image->clip.y);
+    int y1 = (int)SDL_min(ceil(bottom), (double)(image->clip.y + image->clip.h));
+    for (int y = y0; y < y1; y++)
+    {
+        int span_count = 0;
+        for (int s = 0; s < RASTER_SUBSAMPLES; s++)
+        {
+            int count = intervals(image, shape, y + (s + 0.5) / RASTER_SUBSAMPLES);
+            _raster_reserve_spans(image, span_count + count / 2);
+            for (int i = 0; i + 1 < count; i += 2)
+                if (_raster_accumulate(image, image->crossings[i], image->crossings[i + 1], &image->spans[2 * span_count]))
+                    span_count++;
+        }
+        _raster_resolve_spans(image, y, span_count, color);
+    }
+}
+
+static int _raster_polygon_intervals(RasterImage* image, const void* shape, double y)
+{
+    const _RasterPolygon* polygon = (const _RasterPolygon*)shape;
+    double* crossings = image->crossings;
+    int count = 0;
+    y -= polygon->offset_y;
+    for (int i = 0, j = polygon->n - 1; i < polygon->n; j = i++)
+    {
+        double y0 = polygon->y[j];
+        double y1 = polygon->y[i];
+        if ((y0 <= y) == (y1 <= y))
+            continue;
+        double x = polygon->x[j] + (y - y0) / (y1 - y0) * (polygon->x[i] - polygon->x[j]);
+        int k = count++;
+        while (k > 0 && crossings[k - 1] > x)
+        {
+            crossings[k] = crossings[k - 1];
+            k--;
+        }
+        crossings[k] = x;
+    }
+    for (int i = 0; i < count; i++)
+        crossings[i] += polygon->offset_x;
+    return count;
+}
+static int _raster_ring_intervals(RasterImage* image, bool has_outer, double outer_left, double outer_right,
+                                  bool has_inner, double inner_left, double inner_right)
+{
+    if (!has_outer)
+        return 0;
+    double* crossings = image->crossings;
+    if (!has_inner || inner_right <= inner_left)
+    {
+        crossings[0] = outer_left;
+        crossings[1] = outer_right;
+        return 2;
+    }
+    crossings[0] = outer_left;
+    crossings[1] = SDL_max(outer_left, inner_left);
+    crossings[2] = SDL_min(outer_right, inner_right);
+    crossings[3] = outer_right;
+    return 4;
+}
+static bool _raster_ellipse_extent(double x, double y, double rx, double ry, double scanline, double* left, double* right)
+{
+    if (rx <= 0.0 || ry <= 0.0)
+        return false;
+    double dy = (scanline - y) / ry;
+    if (dy * dy >= 1.0)
+        return false;
+    double half = rx * sqrt(1.0 - dy * dy);
+    *left = x - half;
+    *right = x + half;
+    return true;
+}
+static int _raster_ellipse_intervals(RasterImage* image, const void* shape, double y)
+{
+    const _RasterEllipse* ellipse = (const _RasterEllipse*)shape;
+    double outer_left = 0.0, outer_right = 0.0, inner_left = 0.0, inner_right = 0.0;
+    bool has_outer = _raster_ellipse_extent(ellipse->x, ellipse->y, ellipse->outer_rx, ellipse->outer_ry, y, &outer_left, &outer_right);
+    bool has_inner = _raster_ellipse_extent(ellipse->x, ellipse->y, ellipse->inner_rx, ellipse->inner_ry, y, &inner_left, &inner_right);
+    return _raster_ring_intervals(image, has_outer, outer_left, outer_right, has_inner, inner_left, inner_right);
+}
+static bool _raster_rect_extent(const double* bounds, double radius, double y, double* left, double* right)
+{
+    if (y < bounds[1] || y >= bounds[3] || bounds[2] <= bounds[0])
+        return false;
+    radius = SDL_min(radius, SDL_min((bounds[2] - bounds[0]) * 0.5, (bounds[3] - bounds[1]) * 0.5));
+    double inset = 0.0;
+    double d = 0.0;
+    if (y < bounds[1] + radius)
+        d = bounds[1] + radius - y;
+    else if (y > bounds[3] - radius)
+        d = y - (bounds[3] - radius);
+    if (d > 0.0)
+        inset = radius - sqrt(SDL_max(0.0, radius * radius - d * d));
+    *left = bounds[0] + inset;
+    *right = bounds[2] - inset;
+    return *left < *right;
+}
+static int _raster_rect_intervals(RasterImage* image, const void* shape, double y)
+{
+    const _RasterRect* rect = (const _RasterRect*)shape;
+    double outer_left = 0.0, outer_right = 0.0, inner_left = 0.0, inner_right = 0.0;
+    bool has_outer = _raster_rect_extent(rect->outer, rect->outer_radius, y, &outer_left, &outer_right);
+    bool has_inner = rect->hollow && _raster_rect_extent(rect->inner, rect->inner_radius, y, &inner_left, &inner_right);
+    return _raster_ring_intervals(image, has_outer, outer_left, outer_right, has_inner, inner_left, inner_right);
+}
+static void _raster_fill_polygon(RasterImage* image, const double* vx, const double* vy, int n, double offset_x, double offset_y, Color color)
+{
+    if (n < 3)
+        return;
+    double top = vy[0], bottom = vy[0];
+    for (int i = 1; i < n; i++)
+    {
+        top = SDL_min(top, vy[i]);
+        bottom = SDL_max(bottom, vy[i]);
+    }
+    _raster_reserve_crossings(image, n + 1);
+    _RasterPolygon polygon = { vx, vy, n, offset_x, offset_y };
+    _raster_fill(image, top + offset_y, bottom + offset_y, _raster_polygon_intervals, &polygon, color);
+}
+
+static void _raster_draw_pixel(RasterImage* image, int x, int y, Color color)
+{
+    SDL_Point point = { x, y };
+    if (!SDL_PointInRect(&point, &image->clip))
+        return;
+    Uint32* pixel = &image->pixels[(size_t)y * image->width + x];
+    *pixel = _raster_blend(*pixel, _raster_pack(color) | 0xFF000000u, color.a);
+}
+static void _raster_draw_line(RasterImage* image, double x1, double y1, double x2, double y2, double thickness, Color color)
+{
+    double dx = x2 - x1;
+    double dy = y2 - y1;
+    double length = sqrt(dx * dx + dy * dy);
+    if (length > 0.0)
+    {
+        dx /= length;
+        dy /= length;
+    }
+    else
+    {
+        dx = 1.0;
+        dy = 0.0;
+    }
+    //thin lines cover their end pixels like aalineRGBA, thick lines end exactly at the points like the SDL2_gfx polygon
+    double extend = thickness <= 1.0 ? 0.5 : 0.0;
+    double half = SDL_max(thickness, 1.0) * 0.5;
+    x1 -= dx * extend;
+    y1 -= dy * extend;
+    x2 += dx * extend;
+    y2 += dy * extend;
+    double nx = -dy * half;
+    double ny = dx * half;
+    double vx[4] = { x1 + nx, x2 + nx, x2 - nx, x1 - nx };
+    double vy[4] = { y1 + ny, y2 + ny, y2 - ny, y1 - ny };
+    _raster_fill_polygon(image, vx, vy, 4, 0.5, 0.5, color);
+}
+static void _raster_draw_rect(RasterImage* image, int x, int y, int width, int height, int radius, Color color)
+{
+    _RasterRect rect = { { x, y, x + width + 1.0, y + height + 1.0 }, radius > 0 ? radius + 0.5 : 0.0,
+                         { x + 1.0, y + 1.0, x + width, y + height }, radius > 0 ? radius - 0.5 : 0.0, true };
+    _raster_reserve_crossings(image, 4);
+    _raster_fill(image, rect.outer[1], rect.outer[3], _raster_rect_intervals, &rect, color);
+}
+static void _raster_draw_filled_rect(RasterImage* image, int x, int y, int width, int height, int radius, Color color)
+{
+    if (radius > 0)
+    {
+        _RasterRect rect = { { x, y, x + width + 1.0, y + height + 1.0 }, radius + 0.5, { 0.0, 0.0, 0.0, 0.0 }, 0.0, false };
+        _raster_reserve_crossings(image, 4);
+        _raster_fill(image, rect.outer[1], rect.outer[3], _raster_rect_intervals, &rect, color);
+        return;
+    }
+
+    //pixel aligned, so no coverage is needed
+    SDL_Rect rect = { x, y, width + 1, height + 1 };
+    SDL_Rect clipped;
+    if (color.a == 0 || !SDL_IntersectRect(&rect, &image->clip, &clipped))
+        return;
+    Uint32 src = _raster_pack(color);
+    for (int row = clipped.y; row < clipped.y + clipped.h; row++)
+        _raster_blend_span(image->pixels + (size_t)row * image->width + clipped.x, clipped.w, src, color.a);
+}
+static void _raster_draw_ellipse(RasterImage* image, double x, double y, double rx, double ry, bool filled, Color color)
+{
+    _RasterEllipse ellipse = { x + 0.5, y + 0.5, rx + 0.5, ry + 0.5, filled ? 0.0 : rx - 0.5, filled ? 0.0 : ry - 0.5 };
+    _raster_reserve_crossings(image, 4);
+    _raster_fill(image, ellipse.y - ellipse.outer_ry, ellipse.y + ellipse.outer_ry, _raster_ellipse_intervals, &ellipse, color);
+}
+static void _raster_draw_polygon(RasterImage* image, const double* vx, const double* vy, int n, double offset_x, double offset_y, Color color)
+{
+    for (int i = 0, j = n - 1; i < n; j = i++)
+        _raster_draw_line(image, vx[j] + offset_x, vy[j] + offset_y, vx[i] + offset_x, vy[i] + offset_y, 1.0, color);
+}
+static void _raster_draw_arc(RasterImage* image, double x, double y, double radius, double start, double end, bool filled, Color color)
+{
+    while (end < start)
+        end += 360.0;
+    double sweep = (end - start) * M_PI / 180.0;
+    int segments = SDL_max(4, (int)ceil(sweep * radius / 2.0));
+    double* vx = (double*)malloc(sizeof(double) * (segments + 2));
+    double* vy = (double*)malloc(sizeof(double) * (segments + 2));
+    if (vx == NULL || vy == NULL)
+    {
+        printf("failed to allocate memory for the arc\n");
+        exit(1);
+    }
+    vx[0] = x;
+    vy[0] = y;
+    for (int i = 0; i <= segments; i++)
+    {
+        double angle = start * M_PI / 180.0 + sweep * i / segments;
+        vx[i + 1] = x + radius * cos(angle);
+        vy[i + 1] = y + radius * sin(angle);
+    }
+    if (filled)
+        _raster_fill_polygon(image, vx, vy, segments + 2, 0.5, 0.5, color);
+    else
+        for (int i = 1; i <= segments; i++)
+            _raster_draw_line(image, vx[i], vy[i], vx[i + 1], vy[i + 1], 1.0, color);
+    free(vx);
+    free(vy);
+}
+
+static void _raster_execute(RasterImage* image, const _RasterCommand* command)
+{
+    const double* values = command->values;
+    switch (command->type)
+    {
+        case RC_CLEAR:
+            for (int row = image->clip.y; row < image->clip.y + image->clip.h; row++)
+                _raster_fill_span(image->pixels + (size_t)row * image->width + image->clip.x, image->clip.w, _raster_pack(command->color));
+            break;
+        case RC_PIXEL:
+            _raster_draw_pixel(image, (int)values[0], (int)values[1], command->color);
+            break;
+        case RC_LINE:
+            _raster_draw_line(image, values[0], values[1], values[2], values[3], values[4], command->color);
+            break;
+        case RC_RECT:
+            _raster_draw_rect(image, (int)values[0], (int)values[1], (int)values[2], (int)values[3], (int)values[4], command->color);
+            break;
+        case RC_FILLED_RECT:
+            _raster_draw_filled_rect(image, (int)values[0], (int)values[1], (int)values[2], (int)values[3], (int)values[4], command->color);
+            break;
+        case RC_ELLIPSE:
+            _raster_draw_ellipse(image, values[0], values[1], values[2], values[3], false, command->color);
+            break;
+        case RC_FILLED_ELLIPSE:
+            _raster_draw_ellipse(image, values[0], values[1], values[2], values[3], true, command->color);
+            break;
+        case RC_POLYGON:
+            _raster_draw_polygon(image, command->points, command->points + command->n, command->n, 0.0, 0.0, command->color);
+            break;
+        case RC_FILLED_POLYGON:
+            _raster_fill_polygon(image, command->points, command->points + command->n, command->n, 0.5, 0.5, command->color);
+            break;
+        case RC_ARC:
+            _raster_draw_arc(image, values[0], values[1], values[2], values[3], values[4], values[5] != 0.0, command->color);
+            break;
+        case RC_SURFACE:
+            _raster_blend_surface(image, command->surface, (int)values[0], (int)values[1]);
+            break;
+    }
+}
+static bool _raster_touches_tile(const _RasterCommand* command, const SDL_Rect* tile)
+{
+    //the bounds of the long lines and large circles cover many tiles they don't actually touch
+    const double* values = command->values;
+    double left = tile->x, top = tile->y, right = tile->x + tile->w, bottom = tile->y + tile->h;
+    if (command->type == RC_LINE)
+    {
+        double dx = values[2] - values[0];
+        double dy = values[3] - values[1];
+        double length = sqrt(dx * dx + dy * dy);
+        if (length == 0.0)
+            return true;
+        double cx = (left + right) * 0.5 - 0.5 - values[0];
+        double cy = (top + bottom) * 0.5 - 0.5 - values[1];
+        double reach = sqrt((double)tile->w * tile->w + (double)tile->h * tile->h) * 0.5 + SDL_max(values[4], 1.0) * 0.5 + 2.0;
+        return fabs(cx * dy - cy * dx) <= reach * length;
+    }
+    if (command->type == RC_ELLIPSE || command->type == RC_FILLED_ELLIPSE)
+    {
+        double x = values[0] + 0.5, y = values[1] + 0.5;
+        double outer_rx = values[2] + 2.0, outer_ry = values[3] + 2.0;
+        double nx = (SDL_max(left, SDL_min(x, right)) - x) / outer_rx;
+        double ny = (SDL_max(top, SDL_min(y, bottom)) - y) / outer_ry;
+        if (nx * nx + ny * ny > 1.0)
+            return false;
+        double inner_rx = values[2] - 2.0, inner_ry = values[3] - 2.0;
+        if (command->type == RC_FILLED_ELLIPSE || inner_rx <= 0.0 || inner_ry <= 0.0)
+            return true;
+        //an ellipse is convex, so the tile is inside the hole if its corners are
+        double fx = SDL_max(fabs(left - x), fabs(right - x)) / inner_rx;
+        double fy = SDL_max(fabs(top - y), fabs(bottom - y)) / inner_ry;
+        return fx * fx + fy * fy >= 1.0;
+    }
+    return true;
+}
+static void _raster_run_tile(void* data, size_t index, int worker)
+{
+    _RasterBatch* batch = (_RasterBatch*)data;
+    RasterImage* view = &batch->workers[worker];
+    SDL_Rect tile = { (int)(index % batch->tiles_x) * RASTER_TILE_SIZE, (int)(index / batch->tiles_x) * RASTER_TILE_SIZE,
+                      RASTER_TILE_SIZE, RASTER_TILE_SIZE };
+    for (int i = batch->tile_offsets[index]; i < batch->tile_offsets[index + 1]; i++)
+    {
+        const _RasterCommand* command = &batch->image->commands[batch->tile_commands[i]];
+        if (!SDL_IntersectRect(&command->clip, &tile, &view->clip))
+            continue;
+        _raster_execute(view, command);
+    }
+}
+
+RasterImage* raster_create(int width, int height)
+{
+    RasterImage* image = (RasterImage*)malloc(sizeof(RasterImage));
+    if (image == NULL)
+    {
+        printf("failed to allocate memory for raster image\n");
+        exit(1);
+    }
+    image->width = SDL_max(width, 1);
+    image->height = SDL_max(height, 1);
+    image->pixels = (Uint32*)calloc((size_t)image->width * image->height, sizeof(Uint32));
+    if (image->pixels == NULL)
+    {
+        printf("failed to allocate memory for raster image\n");
+        exit(1);
+    }
+    _raster_create_scratch(image);
+    image->origin = (SDL_Point){ 0, 0 };
+    image->batching = false;
+    image->commands = NULL;
+    image->command_count = 0;
+    image->command_capacity = 0;
+    raster_reset_clip_rect(image);
+    return image;
+}
+void raster_destroy(RasterImage* image)
+{
+    if (image == NULL)
+        return;
+    if (image->batching)
+        raster_end_batch(image, NULL);
+    free(image->pixels);
+    _raster_destroy_scratch(image);
+    free(image->commands);
+    free(image);
+}
+Uint32 raster_get_pixel(RasterImage* image, int x, int y)
+{
+    if (x < 0 || y < 0 || x >= image->width || y >= image->height)
+        return 0;
+    return image->pixels[(size_t)y * image->width + x];
+}
+void raster_begin_batch(RasterImage* image)
+{
+    image->batching = true;
+    image->command_count = 0;
+}
+void raster_end_batch(RasterImage* image, ThreadPool* pool)
+{
+    if (!image->batching)
+        return;
+    image->batching = false;
+
+    //counting sort of the commands into the tiles they touch, so every tile keeps the recorded order
+    _RasterBatch batch;
+    batch.image = image;
+    batch.tiles_x = (image->width + RASTER_TILE_SIZE - 1) / RASTER_TILE_SIZE;
+    int tiles_y = (image->height + RASTER_TILE_SIZE - 1) / RASTER_TILE_SIZE;
+    size_t tile_count = (size_t)batch.tiles_x * tiles_y;
+    batch.tile_offsets = (int*)calloc(tile_count + 1, sizeof(int));
+    if (batch.tile_offsets == NULL)
+    {
+        printf("failed to allocate memory for the raster tiles\n");
+        exit(1);
+    }
+    for (int pass = 0; pass < 2; pass++)
+    {
+        for (size_t i = 0; i < image->command_count; i++)
+        {
+            SDL_Rect* bounds = &image->commands[i].bounds;
+            int tx0 = bounds->x / RASTER_TILE_SIZE;
+            int ty0 = bounds->y / RASTER_TILE_SIZE;
+            int tx1 = (bounds->x + bounds->w - 1) / RASTER_TILE_SIZE;
+            int ty1 = (bounds->y + bounds->h - 1) / RASTER_TILE_SIZE;
+            for (int ty = ty0; ty <= ty1; ty++)
+                for (int tx = tx0; tx <= tx1; tx++)
+                {
+                    SDL_Rect tile_rect = { tx * RASTER_TILE_SIZE, ty * RASTER_TILE_SIZE, RASTER_TILE_SIZE, RASTER_TILE_SIZE };
+                    if (!_raster_touches_tile(&image->commands[i], &tile_rect))
+                        continue;
+                    size_t tile = (size_t)ty * batch.tiles_x + tx;
+                    if (pass == 0)
+                        batch.tile_offsets[tile + 1]++;
+                    else
+                        batch.tile_commands[batch.tile_offsets[tile]++] = i;
+                }
+        }
+        if (pass == 0)
+        {
+            for (size_t i = 0; i < tile_count; i++)
+                batch.tile_offsets[i + 1] += batch.tile_offsets[i];
+            batch.tile_commands = (size_t*)malloc(sizeof(size_t) * (batch.tile_offsets[tile_count] + 1));
+            if (batch.tile_commands == NULL)
+            {
+                printf("failed to allocate memory for the raster tiles\n");
+                exit(1);
+            }
+        }
+    }
+    //the fill pass moved every offset to the end of its tile
+    for (size_t i = tile_count; i > 0; i--)
+        batch.tile_offsets[i] = batch.tile_offsets[i - 1];
+    batch.tile_offsets[0] = 0;
+
+    //every worker draws into the shared pixels with its own scratch buffers, the tiles don't overlap
+    int worker_count = thread_pool_get_worker_count(pool);
+    batch.workers = (RasterImage*)malloc(sizeof(RasterImage) * worker_count);
+    if (batch.workers == NULL)
+    {
+        printf("failed to allocate memory for the raster workers\n");
+        exit(1);
+    }
+    for (int i = 0; i < worker_count; i++)
+    {
+        batch.workers[i] = *image;
+        batch.workers[i].commands = NULL;
+        batch.workers[i].command_count = 0;
+        batch.workers[i].command_capacity = 0;
+        _raster_create_scratch(&batch.workers[i]);
+    }
+    thread_pool_run(pool, tile_count, _raster_run_tile, &batch);
+
+    for (int i = 0; i < worker_count; i++)
+        _raster_destroy_scratch(&batch.workers[i]);
+    free(batch.workers);
+    free(batch.tile_offsets);
+    free(batch.tile_commands);
+    for (size_t i = 0; i < image->command_count; i++)
+    {
+        free(image->commands[i].points);
+        if (image->commands[i].surface != NULL)
+            SDL_FreeSurface(image->commands[i].surface);
+    }
+    image->command_count = 0;
+}
+
+void raster_set_origin(RasterImage* image, int x, int y)
+{
+    image->origin.x = x;
+    image->origin.y = y;
+}
+void raster_set_clip_rect(RasterImage* image, int x, int y, int width, int height)
+{
+    x -= image->origin.x;
+    y -= image->origin.y;
+    int right = SDL_min(x + width, image->width);
+    int bottom = SDL_min(y + height, image->height);
+    image->clip.x = SDL_max(x, 0);
+    image->clip.y = SDL_max(y, 0);
+    image->clip.w = SDL_max(right - image->clip.x, 0);
+    image->clip.h = SDL_max(bottom - image->clip.y, 0);
+}
+void raster_reset_clip_rect(RasterImage* image)
+{
+    image->clip = (SDL_Rect){ 0, 0, image->width, image->height };
+}
+
+void raster_clear(RasterImage* image, Color color)
+{
+    if (image->batching)
+    {
+        SDL_Rect clip = image->clip;
+        raster_reset_clip_rect(image);
+        _raster_record(image, RC_CLEAR, color, 0.0, 0.0, image->width, image->height);
+        image->clip = clip;
+        return;
+    }
+    _raster_fill_span(image->pixels, image->width * image->height, _raster_pack(color));
+}
+void raster_draw_pixel(RasterImage* image, int x, int y, Color color)
+{
+    x -= image->origin.x;
+    y -= image->origin.y;
+    if (image->batching)
+    {
+        _RasterCommand* command = _raster_record(image, RC_PIXEL, color, x, y, x + 1.0, y + 1.0);
+        if (command != NULL)
+            memcpy(command->values, (double[]){ x, y }, sizeof(double) * 2);
+        return;
+    }
+    _raster_draw_pixel(image, x, y, color);
+}
+void raster_draw_line(RasterImage* image, double x1, double y1, double x2, double y2, double thickness, Color color)
+{
+    x1 -= image->origin.x;
+    y1 -= image->origin.y;
+    x2 -= image->origin.x;
+    y2 -= image->origin.y;
+    if (image->batching)
+    {
+        double half = SDL_max(thickness, 1.0) * 0.5;
+        _RasterCommand* command = _raster_record(image, RC_LINE, color, SDL_min(x1, x2) - half, SDL_min(y1, y2) - half,
+                                                 SDL_max(x1, x2) + half + 1.0, SDL_max(y1, y2) + half + 1.0);
+        if (command != NULL)
+            memcpy(command->values, (double[]){ x1, y1, x2, y2, thickness }, sizeof(double) * 5);
+        return;
+    }
+    _raster_draw_line(image, x1, y1, x2, y2, thickness, color);
+}
+void raster_draw_rect(RasterImage* image, int x, int y, int width, int height, int radius, Color color)
+{
+    x -= image->origin.x;
+    y -= image->origin.y;
+    if (image->batching)
+    {
+        _RasterCommand* command = _raster_record(image, RC_RECT, color, x, y, x + width + 1.0, y + height + 1.0);
+        if (command != NULL)
+            memcpy(command->values, (double[]){ x, y, width, height, radius }, sizeof(double) * 5);
+        return;
+    }
+    _raster_draw_rect(image, x, y, width, height, radius, color);
+}
+void raster_draw_filled_rect(RasterImage* image, int x, int y, int width, int height, int radius, Color color)
+{
+    x -= image->origin.x;
+    y -= image->origin.y;
+    if (image->batching)
+    {
+        _RasterCommand* command = _raster_record(image, RC_FILLED_RECT, color, x, y, x + width + 1.0, y + height + 1.0);
+        if (command != NULL)
+            memcpy(command->values, (double[]){ x, y, width, height, radius }, sizeof(double) * 5);
+        return;
+    }
+    _raster_draw_filled_rect(image, x, y, width, height, radius, color);
+}
+void raster_draw_ellipse(RasterImage* image, double x, double y, double rx, double ry, Color color)
+{
+    x -= image->origin.x;
+    y -= image->origin.y;
+    if (image->batching)
+    {
+        _RasterCommand* command = _raster_record(image, RC_ELLIPSE, color, x - rx, y - ry, x + rx + 1.0, y + ry + 1.0);
+        if (command != NULL)
+            memcpy(command->values, (double[]){ x, y, rx, ry }, sizeof(double) * 4);
+        return;
+    }
+    _raster_draw_ellipse(image, x, y, rx, ry, false, color);
+}
+void raster_draw_filled_ellipse(RasterImage* image, double x, double y, double rx, double ry, Color color)
+{
+    x -= image->origin.x;
+    y -= image->origin.y;
+    if (image->batching)
+    {
+        _RasterCommand* command = _raster_record(image, RC_FILLED_ELLIPSE, color, x - rx, y - ry, x + rx + 1.0, y + ry + 1.0);
+        if (command != NULL)
+            memcpy(command->values, (double[]){ x, y, rx, ry }, sizeof(double) * 4);
+        return;
+    }
+    _raster_draw_ellipse(image, x, y, rx, ry, true, color);
+}
+void raster_draw_polygon(RasterImage* image, const double* vx, const double* vy, int n, Color color)
+{
+    if (image->batching)
+    {
+        _raster_record_polygon(image, RC_POLYGON, vx, vy, n, color);
+        return;
+    }
+    _raster_draw_polygon(image, vx, vy, n, -image->origin.x, -image->origin.y, color);
+}
+void raster_draw_filled_polygon(RasterImage* image, const double* vx, const double* vy, int n, Color color)
+{
+    if (image->batching)
+    {
+        _raster_record_polygon(image, RC_FILLED_POLYGON, vx, vy, n, color);
+        return;
+    }
+    _raster_fill_polygon(image, vx, vy, n, 0.5 - image->origin.x, 0.5 - image->origin.y, color);
+}
+void raster_draw_arc(RasterImage* image, double x, double y, double radius, double start, double end, bool filled, Color color)
+{
+    x -= image->origin.x;
+    y -= image->origin.y;
+    if (image->batching)
+    {
+        _RasterCommand* command = _raster_record(image, RC_ARC, color, x - radius, y - radius, x + radius + 1.0, y + radius + 1.0);
+        if (command != NULL)
+            memcpy(command->values, (double[]){ x, y, radius, start, end, filled }, sizeof(double) * 6);
+        return;
+    }
+    _raster_draw_arc(image, x, y, radius, start, end, filled, color);
+}
+void raster_draw_surface(RasterImage* image, SDL_Surface* surface, int x, int y)
+{
+    x -= image->origin.x;
+    y -= image->origin.y;
+    SDL_Surface* converted = SDL_ConvertSurfaceFormat(surface, RASTER_PIXEL_FORMAT, 0);
+    if (converted == NULL)
+        return;
+    if (image->batching)
+    {
+        //the batch keeps the converted copy, the caller can free the surface
+        _RasterCommand* command = _raster_record(image, RC_SURFACE, WHITE, x + 2.0, y + 2.0, x + converted->w - 2.0, y + converted->h - 2.0);
+        if (command == NULL)
+        {
+            SDL_FreeSurface(converted);
+            return;
+        }
+        command->values[0] = x;
+        command->values[1] = y;
+        command->surface = converted;
+        return;
+    }
+    _raster_blend_surface(image, converted, x, y);
+    SDL_FreeSurface(converted);
+}
@@ -0,0 +1,233 @@
+#pragma once
+
+#ifdef _WIN32
+    #include <SDL.h>
+#elif defined(__unix__) || defined(__linux__)
+    #include <SDL2/SDL.h>
+#endif
+
+#include <stdbool.h>
+
+#include "../color/color.h"
+#include "../utils/thread_pool/thread_pool.h"
+
+#define RASTER_SUBSAMPLES 4
+#define RASTER_PIXEL_FORMAT SDL_PIXELFORMAT_ABGR8888
+#define RASTER_TILE_SIZE 256
+
+/*
+ * Software rasterizer into a CPU RGBA buffer, used by the renderer when a raster image is bound (headless rendering, image export).
+ * Every shape is converted to horizontal coverage intervals on RASTER_SUBSAMPLES sub-scanlines per row (exact coverage horizontally),
+ * so the edges are anti-aliased and the fully covered runs of a row are filled as SIMD spans.
+ * The coordinates follow the SDL renderer: integer coordinates are pixel centers, and the shapes have the same extents as the SDL2_gfx ones.
+ * Between raster_begin_batch and raster_end_batch the draw calls are only recorded, then they are binned into RASTER_TILE_SIZE tiles by their bounds
+ * and the tiles are rasterized in parallel (every tile runs its commands in the recorded order, so the result is the same as drawing them directly).
+ */
+
+typedef struct _RasterCommand _RasterCommand;
+
+/**
+ * @brief An RGBA image in CPU memory that can be rendered into
+ */
+typedef struct RasterImage
+{
+    int width;
+    int height;
+    Uint32* pixels;
+    SDL_Point origin;
+    SDL_Rect clip;
+
+    //scratch buffers of the rasterizer (per image, so different images can be rasterized in parallel)
+    float* coverage;
+    float* delta;
+    double* crossings;
+    int crossing_capacity;
+    int* spans;
+    int span_capacity;
+
+    //recorded draw calls of the current batch
+    bool batching;
+    _RasterCommand* commands;
+    size_t command_count;
+    size_t command_capacity;
+} RasterImage;
+
+/**
+ * @brief Creates a raster image (the pixels are transparent black)
+ *
+ * @param width The width of the image
+ * @param height The height of the image
+ * @return RasterImage* The created image
+ */
+RasterImage* raster_create(int width, int height);
+/**
+ * @brief Destroys a raster image
+ *
+ * @param image The image to destroy
+ */
+void raster_destroy(RasterImage* image);
+/**
+ * @brief Returns a pixel of the image (packed in RASTER_PIXEL_FORMAT)
+ *
+ * @param image The image
+ * @param x The x coordinate of the pixel
+ * @param y The y coordinate of the pixel
+ * @return Uint32 The pixel (0 if it is outside of the image)
+ */
+Uint32 raster_get_pixel(RasterImage* image, int x, int y);
+/**
+ * @brief Starts recording the draw calls of the image instead of drawing them
+ *
+ * @param image The image
+ */
+void raster_begin_batch(RasterImage* image);
+/**
+ * @brief Rasterizes the draw calls recorded since raster_begin_batch tile by tile on a thread pool
+ *
+ * @param image The image
+ * @param pool The thread pool to use (NULL to rasterize the tiles on the calling thread)
+ */
+void raster_end_batch(RasterImage* image, ThreadPool* pool);
+
+/**
+ * @brief Moves the image over the drawing: the top left pixel of the image shows the point (x, y) of the drawing
+ * (e.g. to render a large drawing band by band, the coordinates stay the same as in the whole image, so the result is the same too)
+ *
+ * @param image The image
+ * @param x The x coordinate of the top left pixel in the drawing
+ * @param y The y coordinate of the top left pixel in the drawing
+ */
+void raster_set_origin(RasterImage* image, int x, int y);
+/**
+ * @brief Sets the clip rect of the image (drawing outside of it has no effect)
+ *
+ * @param image The image
+ * @param x The x coordinate of the clip rect
+ * @param y The y coordinate of the clip rect
+ * @param width The width of the clip rect
+ * @param height The height of the clip rect
+ */
+void raster_set_clip_rect(RasterImage* image, int x, int y, int width, int height);
+/**
+ * @brief Resets the clip rect to the whole image
+ *
+ * @param image The image
+ */
+void raster_reset_clip_rect(RasterImage* image);
+
+/**
+ * @brief Fills the whole image with a color (ignores the clip rect, like SDL_RenderClear)
+ *
+ * @param image The image to clear
+ * @param color The color to clear with
+ */
+void raster_clear(RasterImage* image, Color color);
+/**
+ * @brief Blends a pixel
+ *
+ * @param image The image to draw into
+ * @param x The x coordinate of the pixel
+ * @param y The y coordinate of the pixel
+ * @param color The color of the pixel
+ */
+void raster_draw_pixel(RasterImage* image, int x, int y, Color color);
+/**
+ * @brief Draws an anti-aliased line
+ *
+ * @param image The image to draw into
+ * @param x1 The x coordinate of the first point
+ * @param y1 The y coordinate of the first point
+ * @param x2 The x coordinate of the second point
+ * @param y2 The y coordinate of the second point
+ * @param thickness The thickness of the line
+ * @param color The color of the line
+ */
+void raster_draw_line(RasterImage* image, double x1, double y1, double x2, double y2, double thickness, Color color);
+/**
+ * @brief Draws a rectangle (not filled, the right and bottom edges are at x + width and y + height)
+ *
+ * @param image The image to draw into
+ * @param x The x coordinate of the rectangle
+ * @param y The y coordinate of the rectangle
+ * @param width The width of the rectangle
+ * @param height The height of the rectangle
+ * @param radius The radius of the corners (0 for sharp corners)
+ * @param color The color of the rectangle
+ */
+void raster_draw_rect(RasterImage* image, int x, int y, int width, int height, int radius, Color color);
+/**
+ * @brief Draws a filled rectangle (the right and bottom edges are at x + width and y + height)
+ *
+ * @param image The image to draw into
+ * @param x The x coordinate of the rectangle
+ * @param y The y coordinate of the rectangle
+ * @param width The width of the rectangle
+ * @param height The height of the rectangle
+ * @param radius The radius of the corners (0 for sharp corners)
+ * @param color The color of the rectangle
+ */
+void raster_draw_filled_rect(RasterImage* image, int x, int y, int width, int height, int radius, Color color);
+/**
+ * @brief Draws an anti-aliased axis aligned ellipse (not filled, one pixel wide)
+ *
+ * @param image The image to draw into
+ * @param x The x coordinate of the center
+ * @param y The y coordinate of the center
+ * @param rx The x radius of the ellipse
+ * @param ry The y radius of the ellipse
+ * @param color The color of the ellipse
+ */
+void raster_draw_ellipse(RasterImage* image, double x, double y, double rx, double ry, Color color);
+/**
+ * @brief Draws an anti-aliased filled axis aligned ellipse
+ *
+ * @param image The image to draw into
+ * @param x The x coordinate of the center
+ * @param y The y coordinate of the center
+ * @param rx The x radius of the ellipse
+ * @param ry The y radius of the ellipse
+ * @param color The color of the ellipse
+ */
+void raster_draw_filled_ellipse(RasterImage* image, double x, double y, double rx, double ry, Color color);
+/**
+ * @brief Draws an anti-aliased polygon (not filled, the last point is connected to the first one)
+ *
+ * @param image The image to draw into
+ * @param vx The x coordinates of the points
+ * @param vy The y coordinates of the points
+ * @param n The number of points
+ * @param color The color of the polygon
+ */
+void raster_draw_polygon(RasterImage* image, const double* vx, const double* vy, int n, Color color);
+/**
+ * @brief Draws an anti-aliased filled polygon (even-odd rule)
+ *
+ * @param image The image to draw into
+ * @param vx The x coordinates of the points
+ * @param vy The y coordinates of the points
+ * @param n The number of points
+ * @param color The color of the polygon
+ */
+void raster_draw_filled_polygon(RasterImage* image, const double* vx, const double* vy, int n, Color color);
+/**
+ * @brief Draws an arc or a pie (the angles are in degrees, clockwise from the positive x axis like in SDL2_gfx)
+ *
+ * @param image The image to draw into
+ * @param x The x coordinate of the center
+ * @param y The y coordinate of the center
+ * @param radius The radius of the arc
+ * @param start The start angle
+ * @param end The end angle
+ * @param filled Whether the pie is drawn instead of the arc
+ * @param color The color of the arc
+ */
+void raster_draw_arc(RasterImage* image, double x, double y, double radius, double start, double end, bool filled, Color color);
+/**
+ * @brief Blends a surface (e.g. a rendered text) into the image using its alpha channel
+ *
+ * @param image The image to draw into
+ * @param surface The surface to draw (any pixel format)
+ * @param x The x coordinate of the top left corner
+ * @param y The y coordinate of the top left corner
+ */
+void raster_draw_surface(RasterImage* image, SDL_Surface* surface, int x, int y);
@@ -1,21 +1,96 @@
 #include "renderer.h"
 #include "../texture/texture.h"
 #include "../font/font.h"
+#include "../profiler/profiler.h"
 
 static SDL_Renderer* target_renderer;
+static RasterImage* target_raster;
+static SvgWriter* target_svg;
 static Font* default_font;
 
+static void _renderer_raster_bezier(const short* vx, const short* vy, int n, int s, Color color)
+{
+	if (n < 2 || s < 2)
+		return;
+	double* x = (double*)malloc(sizeof(double) * n);
+	double* y = (double*)malloc(sizeof(double) * n);
+	if (x == NULL || y == NULL)
+	{
+		printf("couldn't allocate memory for the bezier curve\n");
+		exit(1);
+	}
+	double previous_x = vx[0], previous_y = vy[0];
+	for (int step = 1; step <= s; step++)
+	{
+		//de Casteljau
+		double t = (double)step / s;
+		for (int i = 0; i < n; i++)
+		{
+			x[i] = vx[i];
+			y[i] = vy[i];
+		}
+		for (int k = n - 1; k > 0; k--)
+			for (int i = 0; i < k; i++)
+			{
+				x[i] += (x[i + 1] - x[i]) * t;
+				y[i] += (y[i + 1] - y[i]) * t;
+			}
+		raster_draw_line(target_raster, previous_x, previous_y, x[0], y[0], 1.0, color);
+		previous_x = x[0];
+		previous_y = y[0];
+	}
+	free(x);
+	free(y);
+}
+static void _renderer_raster_polygon(const short* vx, const short* vy, int n, bool filled, Color color)
+{
+	if (n <= 0)
+		return;
+	double* x = (double*)malloc(sizeof(double) * n);
+	double* y = (double*)malloc(sizeof(double) * n);
+	if (x == NULL || y == NULL)
+	{
+		printf("couldn't allocate memory for the polygon\n");
+		exit(1);
+	}
+	for (int i = 0; i < n; i++)
+	{
+		x[i] = vx[i];
+		y[i] = vy[i];
+	}
+	if (filled)
+		raster_draw_filled_polygon(target_raster, x, y, n, color);
+	else
+		raster_draw_polygon(target_raster, x, y, n, color);
+	free(x);
+	free(y);
+}
+
 void renderer_set_default_font(Font* font)
 {
 	default_font = font;
 }
 void renderer_set_clip_rect(int x, int y, int width, int height)
 {
+	if (target_raster != NULL)
+	{
+		raster_set_clip_rect(target_raster, x, y, width, height);
+		return;
+	}
+	if (target_svg != NULL)
+		return;
 	SDL_Rect rect = { x, y, width, height };
 	SDL_RenderSetClipRect(target_renderer, &rect);
 }
 void renderer_reset_clip_rect()
 {
+	if (target_raster != NULL)
+	{
+		raster_reset_clip_rect(target_raster);
+		return;
+	}
+	if (target_svg != NULL)
+		return;
 	SDL_RenderSetClipRect(target_renderer, NULL);
 }
 
@@ -51,18 +126,59 @@ void renderer_bind_framebuffer(Texture* framebuffer)
 	else
 		SDL_SetRenderTarget(target_renderer, framebuffer->texture);
 }
+void renderer_bind_raster(RasterImage* image)
+{
+	target_raster = image;
+}
+void renderer_bind_svg(SvgWriter* writer)
+{
+	target_svg = writer;
+}
 
 void renderer_clear(Color color)
 {
+	profiler_add_counter(PC_DRAW_CALLS, 1);
+	if (target_raster != NULL)
+	{
+		raster_clear(target_raster, color);
+		return;
+	}
+	if (target_svg != NULL)
+	{
+		svg_writer_clear(target_svg, color);
+		return;
+	}
 	SDL_SetRenderDrawColor(target_renderer, color.r, color.g, color.b, color.a);
 	SDL_RenderClear(target_renderer);
 }
 void renderer_draw_pixel(int x, int y, Color color)
 {
+	profiler_add_counter(PC_DRAW_CALLS, 1);
+	if (target_raster != NULL)
+	{
+		raster_draw_pixel(target_raster, x, y, color);
+		return;
+	}
+	if (target_svg != NULL)
+	{
+		svg_writer_rect(target_svg, x - 0.5, y - 0.5, 1.0, 1.0, 0.0, true, color);
+		return;
+	}
 	pixelRGBA(target_renderer, x, y, color.r, color.g, color.b, color.a);
 }
 void renderer_draw_line(int x1, int y1, int x2, int y2, int thickness, Color color)
 {
+	profiler_add_counter(PC_DRAW_CALLS, 1);
+	if (target_raster != NULL)
+	{
+		raster_draw_line(target_raster, x1, y1, x2, y2, thickness, color);
+		return;
+	}
+	if (target_svg != NULL)
+	{
+		svg_writer_line(target_svg, x1, y1, x2, y2, thickness, color);
+		return;
+	}
 	if (thickness == 1)
 	{
 		aalineRGBA(target_renderer, x1, y1, x2, y2, color.r, color.g, color.b, color.a);
@@ -91,89 +207,364 @@ void renderer_draw_line(int x1, int y1, int x2, int y2, int thickness, Color col
 }
 void renderer_draw_rect(int x, int y, int width, int height, Color color)
 {
+	profiler_add_counter(PC_DRAW_CALLS, 1);
+	if (target_raster != NULL)
+	{
+		raster_draw_rect(target_raster, x, y, width, height, 0, color);
+		return;
+	}
+	if (target_svg != NULL)
+	{
+		svg_writer_rect(target_svg, x, y, width, height, 0.0, false, color);
+		return;
+	}
 	rectangleRGBA(target_renderer, x, y, x + width, y + height, color.r, color.g, color.b, color.a);
 }
 void renderer_draw_filled_rect(int x, int y, int width, int height, Color color)
 {
+	profiler_add_counter(PC_DRAW_CALLS, 1);
+	if (target_raster != NULL)
+	{
+		raster_draw_filled_rect(target_raster, x, y, width, height, 0, color);
+		return;
+	}
+	if (target_svg != NULL)
+	{
+		svg_writer_rect(target_svg, x - 0.5, y - 0.5, width + 1.0, height + 1.0, 0.0, true, color);
+		return;
+	}
 	boxRGBA(target_renderer, x, y, x + width, y + height, color.r, color.g, color.b, color.a);
 }
 void renderer_draw_circle(int x, int y, int radius, Color color)
 {
+	profiler_add_counter(PC_DRAW_CALLS, 1);
+	if (target_raster != NULL)
+	{
+		raster_draw_ellipse(target_raster, x, y, radius, radius, color);
+		return;
+	}
+	if (target_svg != NULL)
+	{
+		svg_writer_ellipse(target_svg, x, y, radius, radius, false, color);
+		return;
+	}
 	aacircleRGBA(target_renderer, x, y, radius, color.r, color.g, color.b, color.a);
 }
 void renderer_draw_filled_circle(int x, int y, int radius, Color color)
 {
+	profiler_add_counter(PC_DRAW_CALLS, 1);
+	if (target_raster != NULL)
+	{
+		raster_draw_filled_ellipse(target_raster, x, y, radius, radius, color);
+		return;
+	}
+	if (target_svg != NULL)
+	{
+		svg_writer_ellipse(target_svg, x, y, radius + 0.5, radius + 0.5, true, color);
+		return;
+	}
 	aacircleRGBA(target_renderer, x, y, radius, color.r, color.g, color.b, color.a);
 	filledCircleRGBA(target_renderer, x, y, radius, color.r, color.g, color.b, color.a);
 }
 void renderer_draw_ellipse(int x, int y, int rx, int ry, Color color)
 {
+	profiler_add_counter(PC_DRAW_CALLS, 1);
+	if (target_raster != NULL)
+	{
+		raster_draw_ellipse(target_raster, x, y, rx, ry, color);
+		return;
+	}
+	if (target_svg != NULL)
+	{
+		svg_writer_ellipse(target_svg, x, y, rx, ry, false, color);
+		return;
+	}
 	aaellipseRGBA(target_renderer, x, y, rx, ry, color.r, color.g, color.b, color.a);
 }
 void renderer_draw_filled_ellipse(int x, int y, int rx, int ry, Color color)
 {
+	profiler_add_counter(PC_DRAW_CALLS, 1);
+	if (target_raster != NULL)
+	{
+		raster_draw_filled_ellipse(target_raster, x, y, rx, ry, color);
+		return;
+	}
+	if (target_svg != NULL)
+	{
+		svg_writer_ellipse(target_svg, x, y, rx + 0.5, ry + 0.5, true, color);
+		return;
+	}
 	filledEllipseRGBA(target_renderer, x, y, rx, ry, color.r, color.g, color.b, color.a);
 }
 void renderer_draw_triangle(int x1, int y1, int x2, int y2, int x3, int y3, Color color)
 {
+	profiler_add_counter(PC_DRAW_CALLS, 1);
+	if (target_raster != NULL)
+	{
+		raster_draw_polygon(target_raster, (const double[]){ x1, x2, x3 }, (const double[]){ y1, y2, y3 }, 3, color);
+		return;
+	}
+	//the vector backend only writes the primitives of the constructions (lines, rects and ellipses)
+	if (target_svg != NULL)
+		return;
 	aatrigonRGBA(target_renderer, x1, y1, x2, y2, x3, y3, color.r, color.g, color.b, color.a);
 }
 void renderer_draw_filled_triangle(int x1, int y1, int x2, int y2, int x3, int y3, Color color)
 {
+	profiler_add_counter(PC_DRAW_CALLS, 1);
+	if (target_raster != NULL)
+	{
+		raster_draw_filled_polygon(target_raster, (const double[]){ x1, x2, x3 }, (const double[]){ y1, y2, y3 }, 3, color);
+		return;
+	}
+	//the vector backend only writes the primitives of the constructions (lines, rects and ellipses)
+	if (target_svg != NULL)
+		return;
 	filledTrigonRGBA(target_renderer, x1, y1, x2, y2, x3, y3, color.r, color.g, color.b, color.a);
 }
 void renderer_draw_rounded_rect(int x, int y, int width, int height, int radius, Color color)
 {
+	profiler_add_counter(PC_DRAW_CALLS, 1);
+	if (target_raster != NULL)
+	{
+		raster_draw_rect(target_raster, x, y, width, height, radius, color);
+		return;
+	}
+	if (target_svg != NULL)
+	{
+		svg_writer_rect(target_svg, x, y, width, height, radius, false, color);
+		return;
+	}
 	roundedRectangleRGBA(target_renderer, x, y, x + width, y + height, radius, color.r, color.g, color.b, color.a);
 }
 void renderer_draw_filled_rounded_rect(int x, int y, int width, int height, int radius, Color color)
 {
+	profiler_add_counter(PC_DRAW_CALLS, 1);
+	if (target_raster != NULL)
+	{
+		raster_draw_filled_rect(target_raster, x, y, width, height, radius, color);
+		return;
+	}
+	if (target_svg != NULL)
+	{
+		svg_writer_rect(target_svg, x - 0.5, y - 0.5, width + 1.0, height + 1.0, radius + 0.5, true, color);
+		return;
+	}
 	roundedBoxRGBA(target_renderer, x, y, x + width, y + height, radius, color.r, color.g, color.b, color.a);
 }
 void renderer_draw_polygon(const short* vx, const short* vy, int n, Color color)
 {
+	profiler_add_counter(PC_DRAW_CALLS, 1);
+	if (target_raster != NULL)
+	{
+		_renderer_raster_polygon(vx, vy, n, false, color);
+		return;
+	}
+	//the vector backend only writes the primitives of the constructions (lines, rects and ellipses)
+	if (target_svg != NULL)
+		return;
 	aapolygonRGBA(target_renderer, vx, vy, n, color.r, color.g, color.b, color.a);
 }
 void renderer_draw_filled_polygon(const short* vx, const short* vy, int n, Color color)
 {
+	profiler_add_counter(PC_DRAW_CALLS, 1);
+	if (target_raster != NULL)
+	{
+		_renderer_raster_polygon(vx, vy, n, true, color);
+		return;
+	}
+	//the vector backend only writes the primitives of the constructions (lines, rects and ellipses)
+	if (target_svg != NULL)
+		return;
 	filledPolygonRGBA(target_renderer, vx, vy, n, color.r, color.g, color.b, color.a);
 }
 void renderer_draw_arc(int x, int y, int radius, int start, int end, Color color)
 {
+	profiler_add_counter(PC_DRAW_CALLS, 1);
+	if (target_raster != NULL)
+	{
+		raster_draw_arc(target_raster, x, y, radius, start, end, false, color);
+		return;
+	}
+	//the vector backend only writes the primitives of the constructions (lines, rects and ellipses)
+	if (target_svg != NULL)
+		return;
 	arcRGBA(target_renderer, x, y, radius, start, end, color.r, color.g, color.b, color.a);
 }
 void renderer_draw_pie(int x, int y, int radius, int start, int end, Color color)
 {
+	profiler_add_counter(PC_DRAW_CALLS, 1);
+	if (target_raster != NULL)
+	{
+		raster_draw_arc(target_raster, x, y, radius, start, end, true, color);
+		return;
+	}
+	//the vector backend only writes the primitives of the constructions (lines, rects and ellipses)
+	if (target_svg != NULL)
+		return;
 	pieRGBA(target_renderer, x, y, radius, start, end, color.r, color.g, color.b, color.a);
 }
 void renderer_draw_bezier(const short* vx, const short* vy, int n, int s, Color color)
 {
+	profiler_add_counter(PC_DRAW_CALLS, 1);
+	if (target_raster != NULL)
+	{
+		_renderer_raster_bezier(vx, vy, n, s, color);
+		return;
+	}
+	//the vector backend only writes the primitives of the constructions (lines, rects and ellipses)
+	if (target_svg != NULL)
+		return;
 	bezierRGBA(target_renderer, vx, vy, n, s, color.r, color.g, color.b, color.a);
 }
 void renderer_draw_texture(Texture* texture, int x, int y, int width, int height)
 {
+	profiler_add_counter(PC_DRAW_CALLS, 1);
+	//textures live on the GPU, the raster and vector backends don't draw them
+	if (target_raster != NULL || target_svg != NULL)
+		return;
 	SDL_Rect dest = { x, y, width, height };
 	SDL_RenderCopy(target_renderer, texture->texture, NULL, &dest);
 }
+static SDL_Vertex* text_vertices;
+static int* text_indices;
+static int text_quad_capacity;
+
+static void _renderer_reserve_text_quads(int count)
+{
+	if (count <= text_quad_capacity)
+		return;
+	while (text_quad_capacity < count)
+		text_quad_capacity = text_quad_capacity == 0 ? 64 : text_quad_capacity * 2;
+	text_vertices = (SDL_Vertex*)realloc(text_vertices, sizeof(SDL_Vertex) * 4 * text_quad_capacity);
+	text_indices = (int*)realloc(text_indices, sizeof(int) * 6 * text_quad_capacity);
+	if (text_vertices == NULL || text_indices == NULL)
+	{
+		printf("couldn't allocate memory for the text vertices\n");
+		exit(1);
+	}
+}
+static void _renderer_flush_text_quads(SDL_Texture* page, int quad_count)
+{
+	if (page == NULL || quad_count == 0)
+		return;
+	SDL_RenderGeometry(target_renderer, page, text_vertices, quad_count * 4, text_indices, quad_count * 6);
+	profiler_add_counter(PC_DRAW_CALLS, 1);
+}
+
 void renderer_draw_text(const char* text, int x, int y, Color color)
 {
-	if (default_font == NULL)
+	//the vector backend only writes the primitives of the constructions
+	if (default_font == NULL || target_svg != NULL)
 		return;
-	SDL_Surface* surface = TTF_RenderUTF8_Blended(default_font->font, text, color);
-	SDL_Texture* texture = SDL_CreateTextureFromSurface(target_renderer, surface);
-	SDL_Rect dest = { x, y, surface->w, surface->h };
-	SDL_RenderCopy(target_renderer, texture, NULL, &dest);
-	SDL_FreeSurface(surface);
-	SDL_DestroyTexture(texture);
+	if (target_raster != NULL)
+	{
+		SDL_Surface* surface = text[0] == '\0' ? NULL : TTF_RenderUTF8_Blended(default_font->font, text, color);
+		if (surface == NULL)
+			return;
+		profiler_add_counter(PC_DRAW_CALLS, 1);
+		raster_draw_surface(target_raster, surface, x, y);
+		SDL_FreeSurface(surface);
+		return;
+	}
+
+	int pen = x;
+	int quad_count = 0;
+	SDL_Texture* batch_page = NULL;
+	Uint32 previous = 0;
+	Uint32 codepoint;
+	while ((codepoint = _font_decode_utf8(&text)) != 0)
+	{
+		if (previous != 0)
+			pen += _font_get_kerning(default_font, previous, codepoint);
+		previous = codepoint;
+
+		FontGlyph* glyph = _font_get_glyph(default_font, codepoint);
+		SDL_Texture* page = _font_rasterize_glyph(default_font, target_renderer, glyph);
+		int advance = glyph->advance;
+		if (page == NULL)
+		{
+			pen += advance;
+			continue;
+		}
+		if (page != batch_page)
+		{
+			_renderer_flush_text_quads(batch_page, quad_count);
+			batch_page = page;
+			quad_count = 0;
+		}
+
+		_renderer_reserve_text_quads(quad_count + 1);
+		float left = (float)(pen + glyph->offset_x);
+		float top = (float)y;
+		float right = left + glyph->atlas_rect.w;
+		float bottom = top + glyph->atlas_rect.h;
+		float u1 = (float)glyph->atlas_rect.x / FONT_ATLAS_SIZE;
+		float v1 = (float)glyph->atlas_rect.y / FONT_ATLAS_SIZE;
+		float u2 = (float)(glyph->atlas_rect.x + glyph->atlas_rect.w) / FONT_ATLAS_SIZE;
+		float v2 = (float)(glyph->atlas_rect.y + glyph->atlas_rect.h) / FONT_ATLAS_SIZE;
+
+		SDL_Vertex* vertices = &text_vertices[quad_count * 4];
+		vertices[0] = (SDL_Vertex){ { left, top }, color, { u1, v1 } };
+		vertices[1] = (SDL_Vertex){ { right, top }, color, { u2, v1 } };
+		vertices[2] = (SDL_Vertex){ { right, bottom }, color, { u2, v2 } };
+		vertices[3] = (SDL_Vertex){ { left, bottom }, color, { u1, v2 } };
+		int* indices = &text_indices[quad_count * 6];
+		int first = quad_count * 4;
+		indices[0] = first;
+		indices[1] = first + 1;
+		indices[2] = first + 2;
+		indices[3] = first;
+		indices[4] = first + 2;
+		indices[5] = first + 3;
+		quad_count++;
+		pen += advance;
+	}
+	_renderer_flush_text_quads(batch_page, quad_count);
 }
 SDL_Point renderer_query_text_size(const char* text)
 {
 	SDL_Point size = { 0, 0 };
 	if (default_font == NULL)
-		return size;		
+		return size;
+	return font_query_text_size(default_font, text);
+}
+SDL_Point renderer_query_text_texture_size(const char* text)
+{
+	SDL_Point size = { 0, 0 };
+	if (default_font == NULL)
+		return size;
 	TTF_SizeUTF8(default_font->font, text, &size.x, &size.y);
 	return size;
 }
+Texture* renderer_create_text_texture(const char* text, Color color)
+{
+	if (default_font == NULL || text[0] == '\0')
+		return NULL;
+	SDL_Surface* surface = TTF_RenderUTF8_Blended(default_font->font, text, color);
+	if (surface == NULL)
+		return NULL;
+	SDL_Texture* text_texture = SDL_CreateTextureFromSurface(target_renderer, surface);
+	if (text_texture == NULL)
+	{
+		SDL_FreeSurface(surface);
+		return NULL;
+	}
+
+	Texture* texture = (Texture*)malloc(sizeof(Texture));
+	if (texture == NULL)
+	{
+		printf("failed to allocate memory for text texture\n");
+		exit(1);
+	}
+	texture->texture = text_texture;
+	texture->width = surface->w;
+	texture->height = surface->h;
+	SDL_FreeSurface(surface);
+	_texture_add(texture);
+
+	return texture;
+}
 
 void _renderer_set_target(SDL_Renderer* renderer)
 {
@@ -11,6 +11,8 @@
 #include "../color/color.h"
 #include "../font/font.h"
 #include "../texture/texture.h"
+#include "../raster/raster.h"
+#include "../svg/svg_writer.h"
 
 /**
  * @brief Sets the default font for the renderer
@@ -54,6 +56,19 @@ void renderer_resize_framebuffer(Texture* framebuffer, int width, int height);
  * @param framebuffer The framebuffer to destroy
  */
 void renderer_bind_framebuffer(Texture* framebuffer);
+/**
+ * @brief Binds a raster image, every draw call is rasterized into it on the CPU until it is unbound (textures are not drawn)
+ * 
+ * @param image The image to draw into (NULL to draw with the SDL renderer again)
+ */
+void renderer_bind_raster(RasterImage* image);
+/**
+ * @brief Binds an SVG writer, the lines, rects, circles and ellipses are written into it as vector elements until it is unbound
+ * (the other draw calls and the clip rect are ignored)
+ * 
+ * @param writer The writer to draw into (NULL to draw with the SDL renderer again)
+ */
+void renderer_bind_svg(SvgWriter* writer);
 
 /**
  * @brief Clears the screen with a color
@@ -254,12 +269,28 @@ void renderer_draw_texture(Texture* texture, int x, int y, int width, int height
  */
 void renderer_draw_text(const char* text, int x, int y, Color color);
 /**
- * @brief Returns the size of a text
+ * @brief Returns the size of a text drawn with renderer_draw_text
  * 
  * @param text The text to get the size of
  * @return SDL_Point The size of the text
  */
 SDL_Point renderer_query_text_size(const char* text);
+/**
+ * @brief Returns the size of the texture renderer_create_text_texture renders a text into
+ * (it can differ from renderer_query_text_size by a few pixels, the texture is not rendered through the glyph atlas)
+ * 
+ * @param text The text to get the size of
+ * @return SDL_Point The size of the text
+ */
+SDL_Point renderer_query_text_texture_size(const char* text);
+/**
+ * @brief Renders a text into a texture with the default font, so a static text can be drawn with a single texture copy
+ * 
+ * @param text The text to render
+ * @param color The color of the text
+ * @return Texture* The created texture (freed with texture_destroy or automatically when the program closes, NULL if the text is empty or couldn't be rendered)
+ */
+Texture* renderer_create_text_texture(const char* text, Color color);
 
 /**
  * @brief Sets the target renderer for the application (should not be called manually)
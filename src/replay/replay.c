@@ -0,0 +1,266 @@
+#include "replay.h"
+#include "../app/app.h"
+#include "../input/input.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define REPLAY_MAX_KEYS 16
+
+typedef struct ReplayFrame
+{
+    bool redraw;
+    SDL_Point mouse_position;
+    int mouse_buttons;
+    int mouse_wheel_delta;
+    SDL_Point window_size;
+    bool backspace_pressed;
+    int key_count;
+    int keys[REPLAY_MAX_KEYS];
+    char text_input[SDL_TEXTINPUTEVENT_TEXT_SIZE];
+} ReplayFrame;
+
+static ReplayMode mode = RM_NONE;
+static FILE* record_file = NULL;
+static ReplayFrame* frames = NULL;
+static size_t frame_count = 0;
+static size_t next_frame = 0;
+static double* frame_times = NULL;
+static Uint64 last_frame_start = 0;
+static Uint64 first_rendered_frame = 0;
+static Window* playback_window = NULL;
+static Uint8* original_keyboard_state = NULL;
+static Uint8 keyboard_state[SDL_NUM_SCANCODES];
+
+static int _replay_compare_times(const void* a, const void* b)
+{
+    double x = *(const double*)a;
+    double y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+static bool _replay_read_frame(FILE* file, ReplayFrame* frame)
+{
+    int redraw, backspace_pressed, text_length;
+    if (fscanf(file, "%d %d %d %d %d %d %d %d %d", &redraw, &frame->mouse_position.x, &frame->mouse_position.y,
+               &frame->mouse_buttons, &frame->mouse_wheel_delta, &frame->window_size.x, &frame->window_size.y,
+               &backspace_pressed, &frame->key_count) != 9)
+        return false;
+    if (frame->key_count < 0 || frame->key_count > REPLAY_MAX_KEYS)
+        return false;
+    for (int i = 0; i < frame->key_count; i++)
+        if (fscanf(file, "%d", &frame->keys[i]) != 1 || frame->keys[i] < 0 || frame->keys[i] >= SDL_NUM_SCANCODES)
+            return false;
+    if (fscanf(file, "%d", &text_length) != 1 || text_length < 0 || text_length >= SDL_TEXTINPUTEVENT_TEXT_SIZE)
+        return false;
+    fgetc(file);
+    if (fread(frame->text_input, 1, text_length, file) != (size_t)text_length)
+        return false;
+    frame->text_input[text_length] = '\0';
+    frame->redraw = redraw != 0;
+    frame->backspace_pressed = backspace_pressed != 0;
+    return true;
+}
+static void _replay_record_frame(Window* window, bool redraw_requested)
+{
+    InputData* input = &window->input_data;
+    UIData* ui = &window->ui_data;
+    int mouse_buttons = 0;
+    for (int i = 0; i < 5; i++)
+        if (input->current_mouse_button_state[i])
+            mouse_buttons |= 1 << i;
+    int keys[REPLAY_MAX_KEYS];
+    int key_count = 0;
+    for (int i = 0; i < input->key_count && key_count < REPLAY_MAX_KEYS; i++)
+        if (input->current_keyboard_state[i])
+            keys[key_count++] = i;
+
+    fprintf(record_file, "%d %d %d %d %d %d %d %d %d", redraw_requested, input->current_mouse_position.x, input->current_mouse_position.y,
+            mouse_buttons, input->mouse_wheel_delta, ui->main_container->base.size.x, ui->main_container->base.size.y,
+            ui->backspace_pressed, key_count);
+    for (int i = 0; i < key_count; i++)
+        fprintf(record_file, " %d", keys[i]);
+    fprintf(record_file, " %zu ", strlen(ui->text_input));
+    fputs(ui->text_input, record_file);
+    fputc('\n', record_file);
+}
+static void _replay_apply_frame(Window* window, ReplayFrame* frame)
+{
+    InputData* input = &window->input_data;
+    UIData* ui = &window->ui_data;
+    if (playback_window != window)
+    {
+        //the keyboard state of SDL can not be written, so the window reads the recorded one
+        playback_window = window;
+        original_keyboard_state = input->current_keyboard_state;
+        input->current_keyboard_state = keyboard_state;
+    }
+    memset(keyboard_state, 0, sizeof(keyboard_state));
+    for (int i = 0; i < frame->key_count; i++)
+        keyboard_state[frame->keys[i]] = 1;
+    for (int i = 0; i < 5; i++)
+        input->current_mouse_button_state[i] = (frame->mouse_buttons & (1 << i)) != 0;
+    input->current_mouse_position = frame->mouse_position;
+    input->mouse_wheel_delta = frame->mouse_wheel_delta;
+    strcpy(ui->text_input, frame->text_input);
+    ui->backspace_pressed = frame->backspace_pressed;
+
+    SDL_Point size = ui->main_container->base.size;
+    if (size.x != frame->window_size.x || size.y != frame->window_size.y)
+    {
+        SDL_SetWindowSize(window->window, frame->window_size.x, frame->window_size.y);
+        SDL_Event event;
+        memset(&event, 0, sizeof(SDL_Event));
+        event.type = SDL_WINDOWEVENT;
+        event.window.event = SDL_WINDOWEVENT_RESIZED;
+        event.window.windowID = SDL_GetWindowID(window->window);
+        event.window.data1 = frame->window_size.x;
+        event.window.data2 = frame->window_size.y;
+        _window_handle_event(window, &event);
+    }
+    _input_set_target(input);
+}
+
+bool replay_start_recording(const char* path)
+{
+    replay_stop();
+    record_file = fopen(path, "w");
+    if (record_file == NULL)
+    {
+        SDL_Log("couldn't open recording file: %s", path);
+        return false;
+    }
+    fprintf(record_file, "%s\n", REPLAY_HEADER);
+    mode = RM_RECORDING;
+    return true;
+}
+bool replay_start_playback(const char* path)
+{
+    replay_stop();
+    FILE* file = fopen(path, "r");
+    if (file == NULL)
+    {
+        SDL_Log("couldn't open recording file: %s", path);
+        return false;
+    }
+    char header[64];
+    if (fgets(header, sizeof(header), file) == NULL || strncmp(header, REPLAY_HEADER, strlen(REPLAY_HEADER)) != 0)
+    {
+        SDL_Log("not a recording: %s", path);
+        fclose(file);
+        return false;
+    }
+
+    size_t capacity = 0;
+    ReplayFrame frame;
+    while (_replay_read_frame(file, &frame))
+    {
+        if (frame_count == capacity)
+        {
+            capacity = capacity == 0 ? 1024 : capacity * 2;
+            frames = (ReplayFrame*)realloc(frames, sizeof(ReplayFrame) * capacity);
+            if (frames == NULL)
+            {
+                SDL_Log("couldn't allocate memory");
+                exit(1);
+            }
+        }
+        frames[frame_count++] = frame;
+    }
+    fclose(file);
+
+    frame_times = (double*)malloc(sizeof(double) * (frame_count + 1));
+    if (frame_times == NULL)
+    {
+        SDL_Log("couldn't allocate memory");
+        exit(1);
+    }
+    next_frame = 0;
+    first_rendered_frame = app_get_frame_stats().frame_count;
+    last_frame_start = 0;
+    mode = RM_PLAYBACK;
+    return true;
+}
+void replay_stop()
+{
+    if (record_file != NULL)
+        fclose(record_file);
+    record_file = NULL;
+    if (playback_window != NULL)
+        playback_window->input_data.current_keyboard_state = original_keyboard_state;
+    playback_window = NULL;
+    free(frames);
+    frames = NULL;
+    frame_count = 0;
+    next_frame = 0;
+    free(frame_times);
+    frame_times = NULL;
+    mode = RM_NONE;
+}
+ReplayMode replay_get_mode()
+{
+    return mode;
+}
+ReplayStats replay_get_stats()
+{
+    ReplayStats stats = { 0, 0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0 };
+    //the time of a frame is known when the next one starts
+    size_t count = next_frame == 0 ? 0 : next_frame - 1;
+    if (mode != RM_PLAYBACK || count == 0)
+        return stats;
+
+    double* sorted = (double*)malloc(sizeof(double) * count);
+    if (sorted == NULL)
+    {
+        SDL_Log("couldn't allocate memory");
+        exit(1);
+    }
+    memcpy(sorted, frame_times, sizeof(double) * count);
+    qsort(sorted, count, sizeof(double), _replay_compare_times);
+    for (size_t i = 0; i < count; i++)
+        stats.total_time += sorted[i];
+    stats.frame_count = count;
+    stats.rendered_frames = app_get_frame_stats().frame_count - first_rendered_frame;
+    stats.min = sorted[0];
+    stats.average = stats.total_time / count;
+    stats.median = sorted[count / 2];
+    stats.p99 = sorted[(count * 99) / 100 < count ? (count * 99) / 100 : count - 1];
+    stats.max = sorted[count - 1];
+    free(sorted);
+    return stats;
+}
+void replay_print_stats()
+{
+    ReplayStats stats = replay_get_stats();
+    printf("replayed %llu frames (%llu rendered) in %.3f s, %.1f fps\n", (unsigned long long)stats.frame_count,
+           (unsigned long long)stats.rendered_frames, stats.total_time, stats.total_time > 0.0 ? stats.frame_count / stats.total_time : 0.0);
+    printf("frame time (ms): min %.3f  avg %.3f  median %.3f  p99 %.3f  max %.3f\n",
+           stats.min * 1e3, stats.average * 1e3, stats.median * 1e3, stats.p99 * 1e3, stats.max * 1e3);
+}
+
+bool _replay_frame(Window* window, bool redraw_requested)
+{
+    if (mode == RM_RECORDING)
+    {
+        _replay_record_frame(window, redraw_requested);
+        return redraw_requested;
+    }
+    if (mode != RM_PLAYBACK)
+        return redraw_requested;
+
+    Uint64 now = SDL_GetPerformanceCounter();
+    if (next_frame > 0 && next_frame <= frame_count)
+        frame_times[next_frame - 1] = (double)(now - last_frame_start) / (double)SDL_GetPerformanceFrequency();
+    last_frame_start = now;
+    if (next_frame >= frame_count)
+    {
+        if (next_frame == frame_count)
+            next_frame++;
+        app_request_close();
+        return false;
+    }
+
+    ReplayFrame* frame = &frames[next_frame++];
+    _replay_apply_frame(window, frame);
+    return frame->redraw;
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#ifdef _WIN32
+    #include <SDL.h>
+#elif defined(__unix__) || defined(__linux__)
+    #include <SDL2/SDL.h>
+#endif
+
+#include <stdbool.h>
+
+#include "../window/window.h"
+
+#define REPLAY_HEADER "gaegebra-replay 1"
+
+/**
+ * @brief Whether the input is being recorded or replayed
+ */
+typedef enum ReplayMode
+{
+    RM_NONE,
+    RM_RECORDING,
+    RM_PLAYBACK
+} ReplayMode;
+
+/**
+ * @brief Frame time statistics of a playback (times are in seconds)
+ */
+typedef struct ReplayStats
+{
+    Uint64 frame_count;
+    Uint64 rendered_frames;
+    double total_time;
+    double min;
+    double average;
+    double median;
+    double p99;
+    double max;
+} ReplayStats;
+
+/**
+ * @brief Starts recording the input of the first window into a file (one line per frame: mouse, keyboard, text input, window size and whether the frame was redrawn)
+ *
+ * @param path The path of the recording
+ * @return true If the file could be opened
+ * @return false If the file could not be opened
+ */
+bool replay_start_recording(const char* path);
+/**
+ * @brief Loads a recording and starts feeding it to the first window instead of the real input, one recorded frame per app_update
+ * (the application requests closing after the last frame, call app_set_headless before app_init to replay without a visible window)
+ *
+ * @param path The path of the recording
+ * @return true If the recording was loaded
+ * @return false If the file could not be opened or it is not a recording
+ */
+bool replay_start_playback(const char* path);
+/**
+ * @brief Stops the recording or the playback (the recording file is closed)
+ */
+void replay_stop();
+/**
+ * @brief Returns whether the input is being recorded or replayed
+ *
+ * @return ReplayMode The current mode
+ */
+ReplayMode replay_get_mode();
+/**
+ * @brief Returns the frame time statistics of the playback so far
+ *
+ * @return ReplayStats The statistics
+ */
+ReplayStats replay_get_stats();
+/**
+ * @brief Prints the frame time statistics of the playback
+ */
+void replay_print_stats();
+
+/**
+ * @brief Records or replays the input of the current frame, called after the events were handled (should not be called manually)
+ *
+ * @param window The window whose input is recorded or replaced
+ * @param redraw_requested Whether the events of the frame requested a redraw
+ * @return bool Whether the frame has to be redrawn (the recorded value in playback)
+ */
+bool _replay_frame(Window* window, bool redraw_requested);
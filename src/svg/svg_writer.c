@@ -0,0 +1,212 @@
+#include "svg_writer.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+static void _svg_flush(SvgWriter* writer)
+{
+    if (writer->buffer_size > 0 && fwrite(writer->buffer, 1, writer->buffer_size, writer->file) != writer->buffer_size)
+        writer->failed = true;
+    writer->buffer_size = 0;
+}
+static void _svg_put(SvgWriter* writer, const char* text)
+{
+    size_t length = strlen(text);
+    if (writer->buffer_size + length > SVG_WRITER_BUFFER_SIZE)
+        _svg_flush(writer);
+    if (length > SVG_WRITER_BUFFER_SIZE)
+    {
+        if (fwrite(text, 1, length, writer->file) != length)
+            writer->failed = true;
+        return;
+    }
+    memcpy(writer->buffer + writer->buffer_size, text, length);
+    writer->buffer_size += length;
+}
+static void _svg_put_number(SvgWriter* writer, double value)
+{
+    //two decimals are more than enough for pixel coordinates, and formatting by hand is much faster than printf
+    char digits[32];
+    int count = 0;
+    long long hundredths = isfinite(value) ? llround(SDL_max(SDL_min(value, 1e12), -1e12) * 100.0) : 0;
+    bool negative = hundredths < 0;
+    if (negative)
+        hundredths = -hundredths;
+    long long fraction = hundredths % 100;
+    long long integer = hundredths / 100;
+    if (fraction != 0)
+    {
+        if (fraction % 10 != 0)
+            digits[count++] = (char)('0' + fraction % 10);
+        digits[count++] = (char)('0' + fraction / 10);
+        digits[count++] = '.';
+    }
+    do
+    {
+        digits[count++] = (char)('0' + integer % 10);
+        integer /= 10;
+    } while (integer > 0);
+    if (negative)
+        digits[count++] = '-';
+
+    char text[33];
+    for (int i = 0; i < count; i++)
+        text[i] = digits[count - 1 - i];
+    text[count] = '\0';
+    _svg_put(writer, text);
+}
+static void _svg_put_attribute(SvgWriter* writer, const char* name, double value)
+{
+    _svg_put(writer, name);
+    _svg_put(writer, "=\"");
+    _svg_put_number(writer, value);
+    _svg_put(writer, "\"");
+}
+static void _svg_put_paint(SvgWriter* writer, bool filled, double thickness, Color color)
+{
+    static const char hex[] = "0123456789abcdef";
+    char paint[8] = { '#', hex[color.r >> 4], hex[color.r & 15], hex[color.g >> 4], hex[color.g & 15], hex[color.b >> 4], hex[color.b & 15], '\0' };
+    if (filled)
+    {
+        _svg_put(writer, " fill=\"");
+        _svg_put(writer, paint);
+        _svg_put(writer, "\"");
+        if (color.a < 255)
+            _svg_put_attribute(writer, " fill-opacity", color.a / 255.0);
+    }
+    else
+    {
+        _svg_put(writer, " fill=\"none\" stroke=\"");
+        _svg_put(writer, paint);
+        _svg_put(writer, "\"");
+        if (thickness != 1.0)
+            _svg_put_attribute(writer, " stroke-width", thickness);
+        if (color.a < 255)
+            _svg_put_attribute(writer, " stroke-opacity", color.a / 255.0);
+    }
+    _svg_put(writer, "/>\n");
+}
+static bool _svg_is_visible(SvgWriter* writer, double left, double top, double right, double bottom)
+{
+    //the elements of a symbol are placed around (0, 0), the uses decide where they appear
+    if (writer->in_symbol)
+        return true;
+    return right >= -SVG_WRITER_CULL_MARGIN && bottom >= -SVG_WRITER_CULL_MARGIN &&
+           left <= writer->width + SVG_WRITER_CULL_MARGIN && top <= writer->height + SVG_WRITER_CULL_MARGIN;
+}
+
+SvgWriter* svg_writer_open(const char* path, int width, int height)
+{
+    if (width <= 0 || height <= 0)
+        return NULL;
+    FILE* file = fopen(path, "wb");
+    if (file == NULL)
+    {
+        SDL_Log("couldn't create image: %s", path);
+        return NULL;
+    }
+    SvgWriter* writer = (SvgWriter*)malloc(sizeof(SvgWriter));
+    if (writer == NULL)
+    {
+        printf("failed to allocate memory for the SVG writer\n");
+        exit(1);
+    }
+    writer->file = file;
+    writer->width = width;
+    writer->height = height;
+    writer->failed = false;
+    writer->in_symbol = false;
+    writer->buffer_size = 0;
+
+    _svg_put(writer, "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<svg xmlns=\"http://www.w3.org/2000/svg\" xmlns:xlink=\"http://www.w3.org/1999/xlink\" version=\"1.1\"");
+    _svg_put_attribute(writer, " width", width);
+    _svg_put_attribute(writer, " height", height);
+    _svg_put(writer, " viewBox=\"0 0 ");
+    _svg_put_number(writer, width);
+    _svg_put(writer, " ");
+    _svg_put_number(writer, height);
+    _svg_put(writer, "\">\n");
+    //integer coordinates are pixel centers
+    _svg_put(writer, "<g transform=\"translate(0.5 0.5)\">\n");
+    return writer;
+}
+void svg_writer_clear(SvgWriter* writer, Color color)
+{
+    svg_writer_rect(writer, -0.5, -0.5, writer->width, writer->height, 0.0, true, color);
+}
+void svg_writer_line(SvgWriter* writer, double x1, double y1, double x2, double y2, double thickness, Color color)
+{
+    double half = SDL_max(thickness, 1.0) * 0.5;
+    if (color.a == 0 || !_svg_is_visible(writer, SDL_min(x1, x2) - half, SDL_min(y1, y2) - half, SDL_max(x1, x2) + half, SDL_max(y1, y2) + half))
+        return;
+    _svg_put_attribute(writer, "<line x1", x1);
+    _svg_put_attribute(writer, " y1", y1);
+    _svg_put_attribute(writer, " x2", x2);
+    _svg_put_attribute(writer, " y2", y2);
+    _svg_put_paint(writer, false, thickness, color);
+}
+void svg_writer_rect(SvgWriter* writer, double x, double y, double width, double height, double radius, bool filled, Color color)
+{
+    if (color.a == 0 || !_svg_is_visible(writer, x - 0.5, y - 0.5, x + width + 0.5, y + height + 0.5))
+        return;
+    _svg_put_attribute(writer, "<rect x", x);
+    _svg_put_attribute(writer, " y", y);
+    _svg_put_attribute(writer, " width", width);
+    _svg_put_attribute(writer, " height", height);
+    if (radius > 0.0)
+        _svg_put_attribute(writer, " rx", radius);
+    _svg_put_paint(writer, filled, 1.0, color);
+}
+void svg_writer_ellipse(SvgWriter* writer, double x, double y, double rx, double ry, bool filled, Color color)
+{
+    if (color.a == 0 || !_svg_is_visible(writer, x - rx - 0.5, y - ry - 0.5, x + rx + 0.5, y + ry + 0.5))
+        return;
+    if (rx == ry)
+    {
+        _svg_put_attribute(writer, "<circle cx", x);
+        _svg_put_attribute(writer, " cy", y);
+        _svg_put_attribute(writer, " r", rx);
+    }
+    else
+    {
+        _svg_put_attribute(writer, "<ellipse cx", x);
+        _svg_put_attribute(writer, " cy", y);
+        _svg_put_attribute(writer, " rx", rx);
+        _svg_put_attribute(writer, " ry", ry);
+    }
+    _svg_put_paint(writer, filled, 1.0, color);
+}
+void svg_writer_begin_symbol(SvgWriter* writer, const char* id)
+{
+    _svg_put(writer, "<defs><symbol id=\"");
+    _svg_put(writer, id);
+    _svg_put(writer, "\" overflow=\"visible\">\n");
+    writer->in_symbol = true;
+}
+void svg_writer_end_symbol(SvgWriter* writer)
+{
+    _svg_put(writer, "</symbol></defs>\n");
+    writer->in_symbol = false;
+}
+void svg_writer_use(SvgWriter* writer, const char* id, double x, double y)
+{
+    _svg_put(writer, "<use xlink:href=\"#");
+    _svg_put(writer, id);
+    _svg_put(writer, "\"");
+    _svg_put_attribute(writer, " x", x);
+    _svg_put_attribute(writer, " y", y);
+    _svg_put(writer, "/>\n");
+}
+bool svg_writer_close(SvgWriter* writer)
+{
+    if (writer == NULL)
+        return false;
+    _svg_put(writer, "</g>\n</svg>\n");
+    _svg_flush(writer);
+    bool success = !writer->failed;
+    if (fclose(writer->file) != 0)
+        success = false;
+    free(writer);
+    return success;
+}
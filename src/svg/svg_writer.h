@@ -0,0 +1,120 @@
+#pragma once
+
+#ifdef _WIN32
+    #include <SDL.h>
+#elif defined(__unix__) || defined(__linux__)
+    #include <SDL2/SDL.h>
+#endif
+
+#include <stdbool.h>
+#include <stdio.h>
+
+#include "../color/color.h"
+
+#define SVG_WRITER_BUFFER_SIZE (1 << 16)
+#define SVG_WRITER_CULL_MARGIN 8.0
+
+/*
+ * Streaming SVG writer: the elements are formatted into a fixed buffer that is flushed to the file when it is full,
+ * so writing doesn't allocate and the time is linear in the number of elements.
+ * Integer coordinates are pixel centers (like in the renderer), the elements outside the image are skipped.
+ */
+
+/**
+ * @brief An SVG file that is being written
+ */
+typedef struct SvgWriter
+{
+    FILE* file;
+    int width;
+    int height;
+    bool failed;
+    bool in_symbol;
+
+    char buffer[SVG_WRITER_BUFFER_SIZE];
+    size_t buffer_size;
+} SvgWriter;
+
+/**
+ * @brief Creates an SVG file and writes its header
+ *
+ * @param path The path of the SVG file
+ * @param width The width of the image
+ * @param height The height of the image
+ * @return SvgWriter* The writer (NULL if the file could not be created)
+ */
+SvgWriter* svg_writer_open(const char* path, int width, int height);
+/**
+ * @brief Fills the whole image with a color
+ *
+ * @param writer The writer
+ * @param color The color
+ */
+void svg_writer_clear(SvgWriter* writer, Color color);
+/**
+ * @brief Writes a line
+ *
+ * @param writer The writer
+ * @param x1 The x coordinate of the first point
+ * @param y1 The y coordinate of the first point
+ * @param x2 The x coordinate of the second point
+ * @param y2 The y coordinate of the second point
+ * @param thickness The width of the line
+ * @param color The color of the line
+ */
+void svg_writer_line(SvgWriter* writer, double x1, double y1, double x2, double y2, double thickness, Color color);
+/**
+ * @brief Writes a rectangle
+ *
+ * @param writer The writer
+ * @param x The x coordinate of the top left corner
+ * @param y The y coordinate of the top left corner
+ * @param width The width of the rectangle
+ * @param height The height of the rectangle
+ * @param radius The radius of the rounded corners (0 for sharp corners)
+ * @param filled Whether the rectangle is filled (or only its 1 pixel wide outline is drawn)
+ * @param color The color of the rectangle
+ */
+void svg_writer_rect(SvgWriter* writer, double x, double y, double width, double height, double radius, bool filled, Color color);
+/**
+ * @brief Writes an ellipse (a circle if the radii are equal)
+ *
+ * @param writer The writer
+ * @param x The x coordinate of the center
+ * @param y The y coordinate of the center
+ * @param rx The horizontal radius
+ * @param ry The vertical radius
+ * @param filled Whether the ellipse is filled (or only its 1 pixel wide outline is drawn)
+ * @param color The color of the ellipse
+ */
+void svg_writer_ellipse(SvgWriter* writer, double x, double y, double rx, double ry, bool filled, Color color);
+/**
+ * @brief Starts a symbol, the next elements (around the point (0, 0)) are stored in it instead of being drawn
+ *
+ * @param writer The writer
+ * @param id The id of the symbol (used by svg_writer_use)
+ */
+void svg_writer_begin_symbol(SvgWriter* writer, const char* id);
+/**
+ * @brief Ends the current symbol
+ *
+ * @param writer The writer
+ */
+void svg_writer_end_symbol(SvgWriter* writer);
+/**
+ * @brief Draws a symbol at a point (a small reference instead of a copy of its elements, it is not culled)
+ *
+ * @param writer The writer
+ * @param id The id of the symbol
+ * @param x The x coordinate where the (0, 0) point of the symbol is drawn
+ * @param y The y coordinate where the (0, 0) point of the symbol is drawn
+ */
+void svg_writer_use(SvgWriter* writer, const char* id, double x, double y);
+/**
+ * @brief Finishes the image, closes the file and destroys the writer
+ *
+ * @param writer The writer
+ * @return true If the whole image was written
+ * @return false If writing failed
+ */
+bool svg_writer_close(SvgWriter* writer);
@@ -17,6 +17,15 @@ Texture* texture_load(SDL_Renderer* renderer, const char* path)
 	vector_push_back(textures, texture);
 	return texture;
 }
+void texture_destroy(Texture* texture)
+{
+	int index = vector_index_of(textures, texture);
+	if (index < 0)
+		return;
+	vector_remove_at(textures, index);
+	SDL_DestroyTexture(texture->texture);
+	free(texture);
+}
 
 void _texture_init()
 {
@@ -35,4 +44,5 @@ void _texture_close()
 		free(texture);
 	}
 	vector_destroy(textures);
+	textures = NULL;
 }
\ No newline at end of file
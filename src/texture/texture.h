@@ -26,6 +26,12 @@ typedef struct Texture
  * @return Texture* Returns the loaded texture
  */
 Texture* texture_load(SDL_Renderer* renderer, const char* path);
+/**
+ * @brief Destroys a texture before the program closes (does nothing if the texture was already freed)
+ * 
+ * @param texture The texture to destroy
+ */
+void texture_destroy(Texture* texture);
 
 /**
  * @brief Creates the texture vector that contains all the loaded textures (should not be called directly, it is needed for the _texture_close function)
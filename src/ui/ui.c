@@ -1,8 +1,25 @@
 #include "ui.h"
 #include "../app/app.h"
+#include "../renderer/renderer.h"
 
 UIData* target_ui_data = NULL;
 
+static void __ui_prepare_framebuffer(UIContainer* container, SDL_Point size)
+{
+    if (container->framebuffer != NULL && container->framebuffer->width == size.x && container->framebuffer->height == size.y)
+        return;
+
+    if (container->framebuffer == NULL)
+        container->framebuffer = renderer_create_framebuffer(size.x, size.y);
+    else
+        renderer_resize_framebuffer(container->framebuffer, size.x, size.y);
+    //the framebuffer is cleared to transparent and blended into, so its colors end up premultiplied by alpha
+    SDL_SetTextureBlendMode(container->framebuffer->texture,
+                            SDL_ComposeCustomBlendMode(SDL_BLENDFACTOR_ONE, SDL_BLENDFACTOR_ONE_MINUS_SRC_ALPHA, SDL_BLENDOPERATION_ADD,
+                                                       SDL_BLENDFACTOR_ONE, SDL_BLENDFACTOR_ONE_MINUS_SRC_ALPHA, SDL_BLENDOPERATION_ADD));
+    container->base.dirty = true;
+}
+
 void _ui_init(UIData* ui_data, int width, int height)
 {
     UIConstraints constraints;
@@ -34,7 +51,34 @@ void _ui_update(UIData* ui_data)
 }
 void _ui_render(UIData* ui_data)
 {
-    _ui_container_render((UIElement*)ui_data->main_container);
+    UIContainer* main_container = ui_data->main_container;
+    SDL_Point size = main_container->base.size;
+    if (size.x <= 0 || size.y <= 0)
+        return;
+
+    for (size_t i = 0; i < vector_size(main_container->children); i++)
+    {
+        UIElement* child = (UIElement*)vector_get(main_container->children, i);
+        if (!child->shown)
+            continue;
+        if (child->render != _ui_container_render)
+        {
+            child->render(child);
+            continue;
+        }
+
+        UIContainer* container = (UIContainer*)child;
+        __ui_prepare_framebuffer(container, size);
+        if (child->dirty)
+        {
+            renderer_bind_framebuffer(container->framebuffer);
+            renderer_clear(TRANSPARENT);
+            child->render(child);
+            renderer_bind_framebuffer(NULL);
+        }
+        renderer_draw_texture(container->framebuffer, 0, 0, size.x, size.y);
+    }
+    main_container->base.dirty = false;
 }
 void _ui_close(UIData* ui_data)
 {
@@ -36,7 +36,7 @@ void _ui_handle_event(UIData* ui_data, SDL_Event* event);
  */
 void _ui_update(UIData* ui_data);
 /**
- * @brief Renders the ui elements recursively
+ * @brief Renders the ui elements (every top level container is cached in a framebuffer, and only rendered again if it is dirty)
  * 
  * @param ui_data The ui data to render
  */
@@ -3,6 +3,7 @@
 #include "../../renderer/renderer.h"
 #include "../../input/input.h"
 #include "../../utils/math/math.h"
+#include "../../utils/trace/trace.h"
 
 #include <math.h>
 #include <string.h>
@@ -15,6 +16,7 @@ typedef struct _UIDropdownItem
 	Sint32 dropdown_index;
 	char text[UITEXT_MAX_LENGTH + 1];
 	MouseState mouse_state;
+	UITextCache text_cache;
 } _UIDropdownItem;
 
 typedef struct _UISplitButtonItem
@@ -25,6 +27,7 @@ typedef struct _UISplitButtonItem
 	Sint32 splitbutton_index;
 	char text[UITEXT_MAX_LENGTH + 1];
 	MouseState mouse_state;
+	UITextCache text_cache;
 } _UISplitButtonItem;
 
 static void _ui_panel_update(UIElement* self);
@@ -87,6 +90,9 @@ static void _ui_splitbuttonitem_destroy(UIElement* self);
 static void _ui_splitbuttonitem_on_click(_UISplitButtonItem* self);
 
 static void __ui_element_recalculate(UIElement* sibling, UIElement* element);
+static void __ui_text_cache_init(UITextCache* cache);
+static Texture* __ui_text_cache_get(UITextCache* cache, const char* text, Color color);
+static void __ui_text_cache_destroy(UITextCache* cache);
 static int __ui_calculate_size(UIConstraint* constraint, int parent_size);
 static int __ui_calculate_position(UIConstraint* constraint, int sibling_position, int sibling_size, int parent_position, int parent_size, int size);
 
@@ -100,6 +106,7 @@ UIContainer* ui_create_container(UIContainer* parent, UIConstraints constraints,
     element->position = (SDL_Point){0, 0};
     element->size = (SDL_Point){0, 0};
     element->shown = true;
+    element->dirty = true;
     element->update = _ui_container_update;
     element->recalculate = _ui_container_recalculate;
     element->render = _ui_container_render;
@@ -107,6 +114,7 @@ UIContainer* ui_create_container(UIContainer* parent, UIConstraints constraints,
 
     container->children = vector_create(0);
     container->on_size_changed = on_size_changed;
+    container->framebuffer = NULL;
     if (parent != NULL && parent->children->size > 0)
         container->base.recalculate((UIElement*)vector_get(parent->children, parent->children->size - 1), element);
     else
@@ -128,6 +136,7 @@ UIPanel* ui_create_panel(UIContainer* parent, UIConstraints constraints, Color c
     element->position = (SDL_Point){0, 0};
     element->size = (SDL_Point){0, 0};
     element->shown = true;
+    element->dirty = true;
     element->update = _ui_panel_update;
     element->recalculate = _ui_panel_recalculate;
     element->render = _ui_panel_render;
@@ -158,6 +167,7 @@ UILabel* ui_create_label(UIContainer* parent, UIConstraints constraints, const c
     element->position = (SDL_Point){0, 0};
     element->size = (SDL_Point){0, 0};
     element->shown = true;
+    element->dirty = true;
     element->update = _ui_label_update;
     element->recalculate = _ui_label_recalculate;
     element->render = _ui_label_render;
@@ -165,6 +175,7 @@ UILabel* ui_create_label(UIContainer* parent, UIConstraints constraints, const c
 
     strcpy(label->text, text);
     label->color = color;
+    __ui_text_cache_init(&label->text_cache);
 
     if (parent->children->size > 0)
         label->base.recalculate((UIElement*)vector_get(parent->children, parent->children->size - 1), element);
@@ -186,6 +197,7 @@ UIButton* ui_create_button(UIContainer* parent, UIConstraints constraints, const
     element->position = (SDL_Point){0, 0};
     element->size = (SDL_Point){0, 0};
     element->shown = true;
+    element->dirty = true;
     element->update = _ui_button_update;
     element->recalculate = _ui_button_recalculate;
     element->render = _ui_button_render;
@@ -197,6 +209,7 @@ UIButton* ui_create_button(UIContainer* parent, UIConstraints constraints, const
     button->text_color = text_color;
     button->corner_radius = 2;
     button->mouse_state = MS_NONE;
+    __ui_text_cache_init(&button->text_cache);
     button->on_click = on_click;
 
     if (parent->children->size > 0)
@@ -219,6 +232,7 @@ UIImageButton* ui_create_imagebutton(UIContainer* parent, UIConstraints constrai
     element->position = (SDL_Point){0, 0};
     element->size = (SDL_Point){0, 0};
     element->shown = true;
+    element->dirty = true;
     element->update = _ui_imagebutton_update;
     element->recalculate = _ui_imagebutton_recalculate;
     element->render = _ui_imagebutton_render;
@@ -248,6 +262,7 @@ UITextbox* ui_create_textbox(UIContainer* parent, UIConstraints constraints, con
     element->position = (SDL_Point){0, 0};
     element->size = (SDL_Point){0, 0};
     element->shown = true;
+    element->dirty = true;
     element->update = _ui_textbox_update;
     element->recalculate = _ui_textbox_recalculate;
     element->render = _ui_textbox_render;
@@ -281,6 +296,7 @@ UICheckbox* ui_create_checkbox(UIContainer* parent, UIConstraints constraints, C
     element->position = (SDL_Point){0, 0};
     element->size = (SDL_Point){0, 0};
     element->shown = true;
+    element->dirty = true;
     element->update = _ui_checkbox_update;
     element->recalculate = _ui_checkbox_recalculate;
     element->render = _ui_checkbox_render;
@@ -313,6 +329,7 @@ UISlider* ui_create_slider(UIContainer* parent, UIConstraints constraints, doubl
     element->position = (SDL_Point){0, 0};
     element->size = (SDL_Point){0, 0};
     element->shown = true;
+    element->dirty = true;
     element->update = _ui_slider_update;
     element->recalculate = _ui_slider_recalculate;
     element->render = _ui_slider_render;
@@ -346,6 +363,7 @@ UIDropdownList* ui_create_dropdown(UIContainer* parent, UIConstraints constraint
     element->position = (SDL_Point){0, 0};
     element->size = (SDL_Point){0, 0};
     element->shown = true;
+    element->dirty = true;
     element->update = _ui_dropdown_update;
     element->recalculate = _ui_dropdown_recalculate;
     element->render = _ui_dropdown_render;
@@ -396,6 +414,7 @@ UISplitButton* ui_create_splitbutton(UIContainer* parent, UIConstraints constrai
     element->position = (SDL_Point){0, 0};
     element->size = (SDL_Point){0, 0};
     element->shown = true;
+    element->dirty = true;
     element->update = _ui_splitbutton_update;
     element->recalculate = _ui_splitbutton_recalculate;
     element->render = _ui_splitbutton_render;
@@ -409,7 +428,7 @@ UISplitButton* ui_create_splitbutton(UIContainer* parent, UIConstraints constrai
         if (items[i] == ';')
         {
             item_count++;
-            length = renderer_query_text_size(temp).x;
+            length = renderer_query_text_texture_size(temp).x;
             if (length > max_length)
                 max_length = length;
             temp[0] = '\0';
@@ -417,7 +436,7 @@ UISplitButton* ui_create_splitbutton(UIContainer* parent, UIConstraints constrai
         else
             strncat(temp, items + i, 1);
     }
-    length = renderer_query_text_size(temp).x;
+    length = renderer_query_text_texture_size(temp).x;
     if (length > max_length)
         max_length = length;
     splitbutton->items = vector_create(item_count);
@@ -425,7 +444,7 @@ UISplitButton* ui_create_splitbutton(UIContainer* parent, UIConstraints constrai
     int idx = -1;
     items = strdup(items);
     char* token = strtok(items, ";");
-    constraints.width = new_pixel_constraint(renderer_query_text_size(token).x + 12);
+    constraints.width = new_pixel_constraint(renderer_query_text_texture_size(token).x + 12);
     vector_push_back(splitbutton->items, _ui_splitbuttonitem_create((UISplitButton*)splitbutton, constraints, idx++, token));
     element->constraints = constraints;
     constraints.y = new_offset_constraint(0);
@@ -458,11 +477,24 @@ UISplitButton* ui_create_splitbutton(UIContainer* parent, UIConstraints constrai
 
 void ui_show_element(UIElement* self)
 {
+    //only a real change invalidates the cached container and wakes up the main loop
+    if (self->shown)
+        return;
     self->shown = true;
+    ui_mark_dirty(self);
 }
 void ui_hide_element(UIElement* self)
 {
+    if (!self->shown)
+        return;
     self->shown = false;
+    ui_mark_dirty(self);
+}
+void ui_mark_dirty(UIElement* self)
+{
+    for (UIElement* element = self; element != NULL; element = element->parent)
+        element->dirty = true;
+    app_request_redraw();
 }
 
 void _ui_container_update(UIElement* self)
@@ -470,12 +502,14 @@ void _ui_container_update(UIElement* self)
     if (!self->shown)
         return;
 
+    TRACE_BEGIN("_ui_container_update");
     UIContainer* container = (UIContainer*)self;
     for (int32_t i = container->children->size - 1; i >= 0; i--)
     {
         UIElement* child = (UIElement*)vector_get(container->children, i);
         child->update(child);
     }
+    TRACE_END("_ui_container_update");
 }
 void _ui_container_recalculate(UIElement* sibling, UIElement* self)
 {
@@ -521,6 +555,7 @@ void _ui_container_recalculate(UIElement* sibling, UIElement* self)
     }
     if (container->on_size_changed)
         container->on_size_changed(container, self->size);
+    ui_mark_dirty(self);
 }
 void _ui_container_render(UIElement* self)
 {
@@ -532,7 +567,9 @@ void _ui_container_render(UIElement* self)
     {
         UIElement* child = (UIElement*)vector_get(container->children, i);
         child->render(child);
+        child->dirty = false;
     }
+    self->dirty = false;
 }
 void _ui_container_destroy(UIElement* self)
 {
@@ -580,16 +617,16 @@ static void _ui_label_update(UIElement* self)
     if (!self->shown)
         return;
 
-    SDL_Point size = renderer_query_text_size(((UILabel*)self)->text);
+    //the size is measured by _ui_label_recalculate, so the hit test doesn't measure the text every frame
     if (!_ui_get_target()->mouse_captured && check_collision_point_rect(input_get_mouse_position().x, input_get_mouse_position().y,
-                                   self->position.x, self->position.y, size.x, size.y))
+                                   self->position.x, self->position.y, self->size.x, self->size.y))
         _ui_get_target()->mouse_captured = true;
 }
 static void _ui_label_recalculate(UIElement* sibling, UIElement* self)
 {
     //recalculate size
     UILabel* label = (UILabel*)self;
-    self->size = renderer_query_text_size(label->text);
+    self->size = renderer_query_text_texture_size(label->text);
 
     //recalculate position
     self->position.x = __ui_calculate_position (&self->constraints.x,
@@ -606,6 +643,7 @@ static void _ui_label_recalculate(UIElement* sibling, UIElement* self)
                                                 self->size.y);
     if (self->position.x < 0 || self->position.y < 0)
         SDL_Log("invalid constraint type for ui element");
+    ui_mark_dirty(self);
 }
 static void _ui_label_render(UIElement* self)
 {
@@ -613,11 +651,14 @@ static void _ui_label_render(UIElement* self)
         return;
 
     UILabel* label = (UILabel*)self;
-    renderer_draw_text(label->text, self->position.x, self->position.y, label->color);
+    Texture* texture = __ui_text_cache_get(&label->text_cache, label->text, label->color);
+    if (texture != NULL)
+        renderer_draw_texture(texture, self->position.x, self->position.y, texture->width, texture->height);
 }
 static void _ui_label_destroy(UIElement* self)
 {
     UILabel* label = (UILabel*)self;
+    __ui_text_cache_destroy(&label->text_cache);
     free(label);
 }
 
@@ -627,6 +668,7 @@ static void _ui_button_update(UIElement* self)
         return;
 
     UIButton* button = (UIButton*)self;
+    MouseState old_mouse_state = button->mouse_state;
     if (!_ui_get_target()->mouse_captured && check_collision_point_rect(input_get_mouse_position().x, input_get_mouse_position().y,
                                    self->position.x, self->position.y, self->size.x, self->size.y))
     {
@@ -646,13 +688,15 @@ static void _ui_button_update(UIElement* self)
         button->mouse_state = MS_NONE;
     else if (input_is_mouse_button_released(SDL_BUTTON_LEFT))
         button->mouse_state = MS_NONE;
+    if (button->mouse_state != old_mouse_state)
+        ui_mark_dirty(self);
 }
 static void _ui_button_recalculate(UIElement* sibling, UIElement* self)
 {
     __ui_element_recalculate(sibling, self);
     
     UIButton* button = (UIButton*)self;
-    SDL_Point text_size = renderer_query_text_size(button->text);
+    SDL_Point text_size = renderer_query_text_texture_size(button->text);
     button->text_position = (SDL_Point){self->position.x + (self->size.x - text_size.x) / 2,
                                       self->position.y + (self->size.y - text_size.y) / 2};
 }
@@ -664,12 +708,14 @@ static void _ui_button_render(UIElement* self)
     UIButton* button = (UIButton*)self;
     Color color = color_clever_shift(button->color, button->mouse_state == MS_PRESS ? 15 : (button->mouse_state == MS_HOVER ? 10 : 0));
     renderer_draw_filled_rounded_rect(self->position.x, self->position.y, self->size.x, self->size.y, button->corner_radius, color);
-    if (button->text[0] != '\0')
-        renderer_draw_text(button->text, button->text_position.x, button->text_position.y, button->text_color);
+    Texture* texture = __ui_text_cache_get(&button->text_cache, button->text, button->text_color);
+    if (texture != NULL)
+        renderer_draw_texture(texture, button->text_position.x, button->text_position.y, texture->width, texture->height);
 }
 static void _ui_button_destroy(UIElement* self)
 {
     UIButton* button = (UIButton*)self;
+    __ui_text_cache_destroy(&button->text_cache);
     free(button);
 }
 
@@ -679,6 +725,7 @@ static void _ui_imagebutton_update(UIElement* self)
         return;
 
     UIImageButton* button = (UIImageButton*)self;
+    MouseState old_mouse_state = button->mouse_state;
     if (!_ui_get_target()->mouse_captured && check_collision_point_rect(input_get_mouse_position().x, input_get_mouse_position().y,
                                    self->position.x, self->position.y, self->size.x, self->size.y))
     {
@@ -698,6 +745,8 @@ static void _ui_imagebutton_update(UIElement* self)
         button->mouse_state = MS_NONE;
     else if (input_is_mouse_button_released(SDL_BUTTON_LEFT))
         button->mouse_state = MS_NONE;
+    if (button->mouse_state != old_mouse_state)
+        ui_mark_dirty(self);
 }
 static void _ui_imagebutton_recalculate(UIElement* sibling, UIElement* self)
 {
@@ -731,6 +780,9 @@ static void _ui_textbox_update(UIElement* self)
         return;
 
     UITextbox* textbox = (UITextbox*)self;
+    MouseState old_mouse_state = textbox->mouse_state;
+    bool old_focused = textbox->focused;
+    size_t old_length = strlen(textbox->text);
     if (textbox->focused) 
     {
         size_t textlen = strlen(textbox->text);
@@ -814,6 +866,8 @@ static void _ui_textbox_update(UIElement* self)
     }
     else if (textbox->mouse_state != MS_PRESS || input_is_mouse_button_released(SDL_BUTTON_LEFT))
         textbox->mouse_state = MS_NONE;
+    if (textbox->mouse_state != old_mouse_state || textbox->focused != old_focused || strlen(textbox->text) != old_length)
+        ui_mark_dirty(self);
 }
 static void _ui_textbox_recalculate(UIElement* sibling, UIElement* self)
 {
@@ -858,6 +912,8 @@ static void _ui_checkbox_update(UIElement* self)
         return;
 
     UICheckbox* checkbox = (UICheckbox*)self;
+    MouseState old_mouse_state = checkbox->mouse_state;
+    bool old_checked = checkbox->checked;
     if (!_ui_get_target()->mouse_captured && check_collision_point_rect(input_get_mouse_position().x, input_get_mouse_position().y,
                                    self->position.x, self->position.y, self->size.x, self->size.y))
     {
@@ -878,6 +934,8 @@ static void _ui_checkbox_update(UIElement* self)
         checkbox->mouse_state = MS_NONE;
     else if (input_is_mouse_button_released(SDL_BUTTON_LEFT))
         checkbox->mouse_state = MS_NONE;
+    if (checkbox->mouse_state != old_mouse_state || checkbox->checked != old_checked)
+        ui_mark_dirty(self);
 }
 static void _ui_checkbox_recalculate(UIElement* sibling, UIElement* self)
 {
@@ -926,6 +984,8 @@ static void _ui_slider_update(UIElement* self)
         return;
 
     UISlider* slider = (UISlider*)self;
+    MouseState old_mouse_state = slider->mouse_state;
+    double old_value = slider->value;
     if (!_ui_get_target()->mouse_captured && check_collision_point_rect(input_get_mouse_position().x, input_get_mouse_position().y,
                                    self->position.x, self->position.y, self->size.x, self->size.y))
     {
@@ -948,6 +1008,8 @@ static void _ui_slider_update(UIElement* self)
         if (slider->on_value_changed)
             slider->on_value_changed(slider, slider->value);
     }
+    if (slider->mouse_state != old_mouse_state || slider->value != old_value)
+        ui_mark_dirty(self);
 }
 static void _ui_slider_recalculate(UIElement* sibling, UIElement* self)
 {
@@ -976,6 +1038,7 @@ static void _ui_dropdown_update(UIElement* self)
         return;
 
     UIDropdownList* dropdown = (UIDropdownList*)self;
+    bool old_expanded = dropdown->expanded;
     UIElement* top_item = (UIElement*)vector_get(dropdown->items, 0);
     top_item->update(top_item);
     if (dropdown->expanded)
@@ -990,6 +1053,8 @@ static void _ui_dropdown_update(UIElement* self)
         !check_collision_point_rect(input_get_mouse_position().x, input_get_mouse_position().y,
         self->position.x, self->position.y, self->size.x, self->size.y))
         dropdown->expanded = false;
+    if (dropdown->expanded != old_expanded)
+        ui_mark_dirty(self);
 }
 static void _ui_dropdown_recalculate(UIElement* sibling, UIElement* self)
 {
@@ -1049,6 +1114,7 @@ static _UIDropdownItem* _ui_dropdownitem_create(UIDropdownList* parent, UIConstr
     element->position = (SDL_Point){0, 0};
     element->size = (SDL_Point){0, 0};
     element->shown = true;
+    element->dirty = true;
     element->update = _ui_dropdownitem_update;
     element->recalculate = _ui_dropdownitem_recalculate;
     element->render = _ui_dropdownitem_render;
@@ -1058,6 +1124,7 @@ static _UIDropdownItem* _ui_dropdownitem_create(UIDropdownList* parent, UIConstr
     item->dropdown_index = index;
     strcpy(item->text, text);
     item->mouse_state = MS_NONE;
+    __ui_text_cache_init(&item->text_cache);
 
     return item;
 }
@@ -1067,6 +1134,7 @@ static void _ui_dropdownitem_update(UIElement* self)
         return;
 
     _UIDropdownItem* item = (_UIDropdownItem*)self;
+    MouseState old_mouse_state = item->mouse_state;
     if (!_ui_get_target()->mouse_captured && check_collision_point_rect(input_get_mouse_position().x, input_get_mouse_position().y,
                                    self->position.x, self->position.y, self->size.x, self->size.y))
     {
@@ -1085,6 +1153,8 @@ static void _ui_dropdownitem_update(UIElement* self)
         item->mouse_state = MS_NONE;
     else if (input_is_mouse_button_released(SDL_BUTTON_LEFT))
         item->mouse_state = MS_NONE;
+    if (item->mouse_state != old_mouse_state)
+        ui_mark_dirty(self);
 }
 static void _ui_dropdownitem_recalculate(UIElement* sibling, UIElement* self)
 {
@@ -1104,11 +1174,14 @@ static void _ui_dropdownitem_render(UIElement* self)
                                       : color_clever_shift(item->parent_dropdown->color, shift)));
     renderer_draw_rounded_rect(self->position.x, self->position.y, self->size.x, self->size.y,
                                item->parent_dropdown->corner_radius, color_clever_shift(item->parent_dropdown->color, shift));
-    if (item->text[0] != '\0') renderer_draw_text(item->text, self->position.x + 6, self->position.y + (int)round((self->size.y - renderer_query_text_size(item->text).y) * 0.5), color_clever_shift(item->parent_dropdown->text_color, shift));
+    Texture* texture = __ui_text_cache_get(&item->text_cache, item->text, color_clever_shift(item->parent_dropdown->text_color, shift));
+    if (texture != NULL)
+        renderer_draw_texture(texture, self->position.x + 6, self->position.y + (int)round((self->size.y - texture->height) * 0.5), texture->width, texture->height);
 }
 static void _ui_dropdownitem_destroy(UIElement* self)
 {
     _UIDropdownItem* item = (_UIDropdownItem*)self;
+    __ui_text_cache_destroy(&item->text_cache);
     free(item);
 }
 static void _ui_dropdownitem_on_click(_UIDropdownItem* self)
@@ -1125,6 +1198,7 @@ static void _ui_dropdownitem_on_click(_UIDropdownItem* self)
         dropdown->expanded = false;
         dropdown->selected_item = self->dropdown_index;
     }
+    ui_mark_dirty((UIElement*)dropdown);
 }
 
 static void _ui_splitbutton_update(UIElement* self)
@@ -1133,6 +1207,7 @@ static void _ui_splitbutton_update(UIElement* self)
         return;
 
     UISplitButton* splitbutton = (UISplitButton*)self;        
+    bool old_expanded = splitbutton->expanded;
     UIElement* top_item = (UIElement*)vector_get(splitbutton->items, 0);
     top_item->update(top_item);
     if (splitbutton->expanded)
@@ -1151,6 +1226,8 @@ static void _ui_splitbutton_update(UIElement* self)
         if (_ui_get_target()->expanded_splitbutton == splitbutton)
             _ui_get_target()->expanded_splitbutton = NULL;
     }
+    if (splitbutton->expanded != old_expanded)
+        ui_mark_dirty(self);
 }
 static void _ui_splitbutton_recalculate(UIElement* sibling, UIElement* self)
 {
@@ -1204,6 +1281,7 @@ static _UISplitButtonItem* _ui_splitbuttonitem_create(UISplitButton* parent, UIC
     element->position = (SDL_Point){0, 0};
     element->size = (SDL_Point){0, 0};
     element->shown = true;
+    element->dirty = true;
     element->update = _ui_splitbuttonitem_update;
     element->recalculate = _ui_splitbuttonitem_recalculate;
     element->render = _ui_splitbuttonitem_render;
@@ -1213,6 +1291,7 @@ static _UISplitButtonItem* _ui_splitbuttonitem_create(UISplitButton* parent, UIC
     item->splitbutton_index = index;
     strcpy(item->text, text);
     item->mouse_state = MS_NONE;
+    __ui_text_cache_init(&item->text_cache);
 
     return item;
 }
@@ -1222,6 +1301,7 @@ static void _ui_splitbuttonitem_update(UIElement* self)
         return;
 
     _UISplitButtonItem* item = (_UISplitButtonItem*)self;
+    MouseState old_mouse_state = item->mouse_state;
     if (!_ui_get_target()->mouse_captured && check_collision_point_rect(input_get_mouse_position().x, input_get_mouse_position().y,
                                    self->position.x, self->position.y, self->size.x, self->size.y))
     {
@@ -1229,8 +1309,10 @@ static void _ui_splitbuttonitem_update(UIElement* self)
             _ui_get_target()->expanded_splitbutton != item->parent_splitbutton)
         {
             _ui_get_target()->expanded_splitbutton->expanded = false;
+            ui_mark_dirty((UIElement*)_ui_get_target()->expanded_splitbutton);
             _ui_get_target()->expanded_splitbutton = item->parent_splitbutton;
             item->parent_splitbutton->expanded = true;
+            ui_mark_dirty((UIElement*)item->parent_splitbutton);
         }
         else
         {
@@ -1250,6 +1332,8 @@ static void _ui_splitbuttonitem_update(UIElement* self)
         item->mouse_state = MS_NONE;
     else if (input_is_mouse_button_released(SDL_BUTTON_LEFT))
         item->mouse_state = MS_NONE;
+    if (item->mouse_state != old_mouse_state)
+        ui_mark_dirty(self);
 }
 static void _ui_splitbuttonitem_recalculate(UIElement* sibling, UIElement* self)
 {
@@ -1268,11 +1352,14 @@ static void _ui_splitbuttonitem_render(UIElement* self)
                                       : item->parent_splitbutton->color));
     renderer_draw_rounded_rect(self->position.x, self->position.y, self->size.x, self->size.y,
                                item->parent_splitbutton->corner_radius, item->parent_splitbutton->color);
-    if (item->text[0] != '\0') renderer_draw_text(item->text, self->position.x + 6, self->position.y + (int)round((self->size.y - renderer_query_text_size(item->text).y) * 0.5), item->parent_splitbutton->text_color);
+    Texture* texture = __ui_text_cache_get(&item->text_cache, item->text, item->parent_splitbutton->text_color);
+    if (texture != NULL)
+        renderer_draw_texture(texture, self->position.x + 6, self->position.y + (int)round((self->size.y - texture->height) * 0.5), texture->width, texture->height);
 }
 static void _ui_splitbuttonitem_destroy(UIElement* self)
 {
     _UISplitButtonItem* item = (_UISplitButtonItem*)self;
+    __ui_text_cache_destroy(&item->text_cache);
     free(item);
 }
 static void _ui_splitbuttonitem_on_click(_UISplitButtonItem* self)
@@ -1293,6 +1380,7 @@ static void _ui_splitbuttonitem_on_click(_UISplitButtonItem* self)
         splitbutton->expanded = false;
         _ui_get_target()->expanded_splitbutton = NULL;
     }
+    ui_mark_dirty((UIElement*)splitbutton);
 }
 
 static void __ui_element_recalculate(UIElement* sibling, UIElement* element)
@@ -1322,6 +1410,31 @@ static void __ui_element_recalculate(UIElement* sibling, UIElement* element)
                                                   element->size.y);
     if (element->position.x < 0 || element->position.y < 0)
         SDL_Log("invalid constraint type for ui element position");
+    ui_mark_dirty(element);
+}
+static void __ui_text_cache_init(UITextCache* cache)
+{
+    cache->texture = NULL;
+    cache->text[0] = '\0';
+    cache->color = (Color){0, 0, 0, 0};
+}
+static Texture* __ui_text_cache_get(UITextCache* cache, const char* text, Color color)
+{
+    if (cache->texture != NULL && strcmp(cache->text, text) == 0 &&
+        cache->color.r == color.r && cache->color.g == color.g && cache->color.b == color.b && cache->color.a == color.a)
+        return cache->texture;
+
+    __ui_text_cache_destroy(cache);
+    strcpy(cache->text, text);
+    cache->color = color;
+    cache->texture = renderer_create_text_texture(text, color);
+    return cache->texture;
+}
+static void __ui_text_cache_destroy(UITextCache* cache)
+{
+    if (cache->texture != NULL)
+        texture_destroy(cache->texture);
+    cache->texture = NULL;
 }
 static int __ui_calculate_size(UIConstraint* constraint, int parent_size)
 {
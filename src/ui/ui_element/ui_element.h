@@ -31,6 +31,7 @@ typedef struct UIElement
 	SDL_Point position;
 	SDL_Point size;
 	bool shown;
+	bool dirty;
 
 	UIElementUpdate update;
 	UIElementRecalculate recalculate;
@@ -50,6 +51,7 @@ typedef struct UIContainer
 
 	Vector* children;
 	UIContainerSizeChanged on_size_changed;
+	Texture* framebuffer;
 } UIContainer;
 
 /**
@@ -65,6 +67,16 @@ typedef struct UIPanel
 	Uint32 corner_radius;
 } UIPanel;
 
+/**
+ * @brief A rendered text texture, rebuilt only when the text or its color changes
+ */
+typedef struct UITextCache
+{
+	Texture* texture;
+	char text[UITEXT_MAX_LENGTH + 1];
+	Color color;
+} UITextCache;
+
 /**
  * @brief The UI label structure
  */
@@ -74,6 +86,7 @@ typedef struct UILabel
 
 	char text[UITEXT_MAX_LENGTH + 1];
 	Color color;
+	UITextCache text_cache;
 } UILabel;
 
 /**
@@ -97,6 +110,7 @@ typedef struct UIButton
 	Uint32 corner_radius;
 	MouseState mouse_state;
 	UIButtonClick on_click;
+	UITextCache text_cache;
 } UIButton;
 
 typedef struct UIImageButton UIImageButton;
@@ -323,17 +337,23 @@ UIDropdownList* ui_create_dropdown(UIContainer* parent, UIConstraints constraint
 UISplitButton* ui_create_splitbutton(UIContainer* parent, UIConstraints constraints, char* items, Color color, Color text_color, void (*on_item_clicked)(UISplitButton* self, Sint32 index), bool auto_dropdown);
 
 /**
- * @brief Shows a UI element (sets the shown flag to true)
+ * @brief Shows a UI element (sets the shown flag to true, the element is only redrawn if it was hidden)
  * 
  * @param self The UI element to show
  */
 void ui_show_element(UIElement* self);
 /**
- * @brief Hides a UI element (sets the shown flag to false)
+ * @brief Hides a UI element (sets the shown flag to false, the element is only redrawn if it was shown)
  * 
  * @param self The UI element to hide
  */
 void ui_hide_element(UIElement* self);
+/**
+ * @brief Marks a UI element and its parents dirty, so its top level container is rendered again (call it after changing the fields of an element directly)
+ * 
+ * @param self The UI element that changed
+ */
+void ui_mark_dirty(UIElement* self);
 
 /**
  * @brief Updates a UIContainer and its children recursively
@@ -0,0 +1,167 @@
+#include "thread_pool.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+static bool _thread_pool_take(_ThreadPoolWorker* worker, size_t* index)
+{
+    SDL_AtomicLock(&worker->lock);
+    bool taken = worker->next_task < worker->end_task;
+    if (taken)
+        *index = worker->next_task++;
+    SDL_AtomicUnlock(&worker->lock);
+    return taken;
+}
+static bool _thread_pool_steal(ThreadPool* pool, _ThreadPoolWorker* thief)
+{
+    //the victims are visited starting after the thief, so the thieves don't all hit the same worker
+    for (int i = 1; i < pool->worker_count; i++)
+    {
+        _ThreadPoolWorker* victim = &pool->workers[(thief->index + i) % pool->worker_count];
+        SDL_AtomicLock(&victim->lock);
+        size_t count = (victim->end_task - victim->next_task + 1) / 2;
+        size_t end = victim->end_task;
+        victim->end_task -= count;
+        SDL_AtomicUnlock(&victim->lock);
+        if (count == 0)
+            continue;
+        //only the thief adds to its own range, and it is empty now
+        SDL_AtomicLock(&thief->lock);
+        thief->next_task = end - count;
+        thief->end_task = end;
+        SDL_AtomicUnlock(&thief->lock);
+        return true;
+    }
+    return false;
+}
+static void _thread_pool_work(ThreadPool* pool, int worker)
+{
+    _ThreadPoolWorker* self = &pool->workers[worker];
+    for (;;)
+    {
+        size_t index;
+        if (_thread_pool_take(self, &index))
+            pool->task(pool->data, index, worker);
+        else if (!_thread_pool_steal(pool, self))
+            return;
+    }
+}
+static int _thread_pool_thread(void* data)
+{
+    _ThreadPoolWorker* worker = (_ThreadPoolWorker*)data;
+    ThreadPool* pool = worker->pool;
+    Uint32 generation = 0;
+    for (;;)
+    {
+        SDL_LockMutex(pool->mutex);
+        while (!pool->quit && pool->generation == generation)
+            SDL_CondWait(pool->start_condition, pool->mutex);
+        if (pool->quit)
+        {
+            SDL_UnlockMutex(pool->mutex);
+            return 0;
+        }
+        generation = pool->generation;
+        SDL_UnlockMutex(pool->mutex);
+
+        _thread_pool_work(pool, worker->index);
+
+        SDL_LockMutex(pool->mutex);
+        if (--pool->running_threads == 0)
+            SDL_CondSignal(pool->done_condition);
+        SDL_UnlockMutex(pool->mutex);
+    }
+}
+
+ThreadPool* thread_pool_create(int worker_count)
+{
+    ThreadPool* pool = (ThreadPool*)malloc(sizeof(ThreadPool));
+    if (pool == NULL)
+    {
+        printf("failed to allocate memory for thread pool\n");
+        exit(1);
+    }
+    if (worker_count <= 0)
+        worker_count = SDL_GetCPUCount();
+    pool->worker_count = worker_count < 1 ? 1 : worker_count;
+    pool->workers = (_ThreadPoolWorker*)malloc(sizeof(_ThreadPoolWorker) * pool->worker_count);
+    pool->mutex = SDL_CreateMutex();
+    pool->start_condition = SDL_CreateCond();
+    pool->done_condition = SDL_CreateCond();
+    if (pool->workers == NULL || pool->mutex == NULL || pool->start_condition == NULL || pool->done_condition == NULL)
+    {
+        printf("failed to create thread pool\n");
+        exit(1);
+    }
+    pool->task = NULL;
+    pool->data = NULL;
+    pool->task_count = 0;
+    pool->running_threads = 0;
+    pool->generation = 0;
+    pool->quit = false;
+
+    //the worker 0 is the thread calling thread_pool_run
+    pool->workers[0] = (_ThreadPoolWorker){ pool, 0, NULL, 0, 0, 0, { 0 } };
+    for (int i = 1; i < pool->worker_count; i++)
+    {
+        pool->workers[i] = (_ThreadPoolWorker){ pool, i, NULL, 0, 0, 0, { 0 } };
+        pool->workers[i].thread = SDL_CreateThread(_thread_pool_thread, "GaeGebra worker", &pool->workers[i]);
+        if (pool->workers[i].thread == NULL)
+        {
+            SDL_Log("couldn't create worker thread: %s", SDL_GetError());
+            pool->worker_count = i;
+            break;
+        }
+    }
+    return pool;
+}
+void thread_pool_destroy(ThreadPool* pool)
+{
+    if (pool == NULL)
+        return;
+    SDL_LockMutex(pool->mutex);
+    pool->quit = true;
+    SDL_CondBroadcast(pool->start_condition);
+    SDL_UnlockMutex(pool->mutex);
+    for (int i = 1; i < pool->worker_count; i++)
+        SDL_WaitThread(pool->workers[i].thread, NULL);
+    SDL_DestroyCond(pool->start_condition);
+    SDL_DestroyCond(pool->done_condition);
+    SDL_DestroyMutex(pool->mutex);
+    free(pool->workers);
+    free(pool);
+}
+int thread_pool_get_worker_count(ThreadPool* pool)
+{
+    return pool == NULL ? 1 : pool->worker_count;
+}
+void thread_pool_run(ThreadPool* pool, size_t task_count, ThreadPoolTask task, void* data)
+{
+    if (pool == NULL || pool->worker_count == 1 || task_count <= 1)
+    {
+        for (size_t i = 0; i < task_count; i++)
+            task(data, i, 0);
+        return;
+    }
+
+    SDL_LockMutex(pool->mutex);
+    pool->task = task;
+    pool->data = data;
+    pool->task_count = task_count;
+    for (int i = 0; i < pool->worker_count; i++)
+    {
+        pool->workers[i].next_task = task_count * i / pool->worker_count;
+        pool->workers[i].end_task = task_count * (i + 1) / pool->worker_count;
+    }
+    pool->running_threads = pool->worker_count - 1;
+    pool->generation++;
+    SDL_CondBroadcast(pool->start_condition);
+    SDL_UnlockMutex(pool->mutex);
+
+    _thread_pool_work(pool, 0);
+
+    SDL_LockMutex(pool->mutex);
+    while (pool->running_threads > 0)
+        SDL_CondWait(pool->done_condition, pool->mutex);
+    SDL_UnlockMutex(pool->mutex);
+}
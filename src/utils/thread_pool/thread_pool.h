@@ -0,0 +1,94 @@
+#pragma once
+
+#ifdef _WIN32
+    #include <SDL.h>
+#elif defined(__unix__) || defined(__linux__)
+    #include <SDL2/SDL.h>
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * @brief A task of a parallel loop
+ *
+ * @param data The data given to thread_pool_run
+ * @param index The index of the task (0 <= index < task count)
+ * @param worker The index of the worker running the task (0 is the calling thread, so per worker scratch data can be indexed with it)
+ */
+typedef void (*ThreadPoolTask)(void* data, size_t index, int worker);
+
+typedef struct ThreadPool ThreadPool;
+
+/**
+ * @brief A worker thread of a thread pool (should not be used manually)
+ */
+typedef struct _ThreadPoolWorker
+{
+    ThreadPool* pool;
+    int index;
+    SDL_Thread* thread;
+
+    //the tasks next_task..end_task-1 belong to the worker, it takes them from the front, the others steal from the back
+    SDL_SpinLock lock;
+    size_t next_task;
+    size_t end_task;
+    //keeps the ranges of the workers in different cache lines
+    char padding[64];
+} _ThreadPoolWorker;
+
+/*
+ * Work stealing: every parallel loop splits the tasks into one contiguous range per worker, so neighbouring tasks
+ * (which usually touch neighbouring data) run on the same thread. A worker that runs out of tasks steals the back half
+ * of the range of another worker, so uneven tasks are still balanced.
+ */
+
+/**
+ * @brief A fixed set of worker threads that run parallel loops (the calling thread is the worker 0)
+ */
+struct ThreadPool
+{
+    int worker_count;
+    _ThreadPoolWorker* workers;
+    SDL_mutex* mutex;
+    SDL_cond* start_condition;
+    SDL_cond* done_condition;
+
+    ThreadPoolTask task;
+    void* data;
+    size_t task_count;
+    int running_threads;
+    Uint32 generation;
+    bool quit;
+};
+
+/**
+ * @brief Creates a thread pool
+ *
+ * @param worker_count The number of workers including the calling thread (0 or less for one per CPU core)
+ * @return ThreadPool* The created thread pool
+ */
+ThreadPool* thread_pool_create(int worker_count);
+/**
+ * @brief Stops the threads and destroys the thread pool
+ *
+ * @param pool The thread pool to destroy
+ */
+void thread_pool_destroy(ThreadPool* pool);
+/**
+ * @brief Returns the number of workers (including the calling thread)
+ *
+ * @param pool The thread pool (NULL means no extra threads)
+ * @return int The number of workers
+ */
+int thread_pool_get_worker_count(ThreadPool* pool);
+/**
+ * @brief Runs the tasks 0..task_count-1 on the workers and waits until all of them are finished
+ * (every worker starts with a contiguous range of the tasks and steals from the others when it is done, the order of execution is not specified)
+ *
+ * @param pool The thread pool (NULL runs the tasks on the calling thread)
+ * @param task_count The number of tasks
+ * @param task The function that runs a task
+ * @param data The data passed to the tasks
+ */
+void thread_pool_run(ThreadPool* pool, size_t task_count, ThreadPoolTask task, void* data);
@@ -0,0 +1,129 @@
+#include "trace.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct TraceEvent
+{
+    const char* name;
+    char phase;
+    SDL_threadID thread;
+    Uint64 timestamp;
+    double value;
+} TraceEvent;
+
+static TraceEvent* events = NULL;
+static size_t event_count = 0;
+static size_t event_capacity = 0;
+static char* trace_path = NULL;
+static bool running = false;
+static Uint64 start_time = 0;
+static SDL_SpinLock lock = 0;
+
+static void _trace_record(const char* name, char phase, double value)
+{
+    SDL_AtomicLock(&lock);
+    Uint64 timestamp = SDL_GetPerformanceCounter();
+    if (running && event_count < TRACE_MAX_EVENTS)
+    {
+        if (event_count == event_capacity)
+        {
+            event_capacity = event_capacity == 0 ? 4096 : event_capacity * 2;
+            events = (TraceEvent*)realloc(events, sizeof(TraceEvent) * event_capacity);
+            if (events == NULL)
+            {
+                printf("failed to allocate memory for trace events\n");
+                exit(1);
+            }
+        }
+        events[event_count++] = (TraceEvent){ name, phase, SDL_ThreadID(), timestamp, value };
+    }
+    SDL_AtomicUnlock(&lock);
+}
+static void _trace_write_string(FILE* file, const char* text)
+{
+    fputc('"', file);
+    for (; *text != '\0'; text++)
+    {
+        if (*text == '"' || *text == '\\')
+            fputc('\\', file);
+        fputc(*text, file);
+    }
+    fputc('"', file);
+}
+
+void trace_start(const char* path)
+{
+    if (running)
+        trace_stop();
+
+    SDL_AtomicLock(&lock);
+    trace_path = (char*)malloc(strlen(path) + 1);
+    if (trace_path == NULL)
+    {
+        printf("failed to allocate memory for trace path\n");
+        exit(1);
+    }
+    strcpy(trace_path, path);
+    event_count = 0;
+    start_time = SDL_GetPerformanceCounter();
+    running = true;
+    SDL_AtomicUnlock(&lock);
+}
+void trace_stop()
+{
+    SDL_AtomicLock(&lock);
+    if (!running)
+    {
+        SDL_AtomicUnlock(&lock);
+        return;
+    }
+    running = false;
+    SDL_AtomicUnlock(&lock);
+
+    FILE* file = fopen(trace_path, "w");
+    if (file == NULL)
+        SDL_Log("couldn't open trace file: %s", trace_path);
+    else
+    {
+        double ticks_per_us = (double)SDL_GetPerformanceFrequency() / 1000000.0;
+        fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+        for (size_t i = 0; i < event_count; i++)
+        {
+            TraceEvent* event = &events[i];
+            fprintf(file, "%s{\"name\":", i == 0 ? "" : ",\n");
+            _trace_write_string(file, event->name);
+            fprintf(file, ",\"ph\":\"%c\",\"ts\":%.3f,\"pid\":1,\"tid\":%lu", event->phase,
+                    (event->timestamp - start_time) / ticks_per_us, (unsigned long)event->thread);
+            if (event->phase == 'C')
+                fprintf(file, ",\"args\":{\"value\":%g}", event->value);
+            fputc('}', file);
+        }
+        fprintf(file, "\n]}\n");
+        fclose(file);
+    }
+
+    free(events);
+    events = NULL;
+    event_count = 0;
+    event_capacity = 0;
+    free(trace_path);
+    trace_path = NULL;
+}
+bool trace_is_running()
+{
+    return running;
+}
+void trace_begin(const char* name)
+{
+    _trace_record(name, 'B', 0.0);
+}
+void trace_end(const char* name)
+{
+    _trace_record(name, 'E', 0.0);
+}
+void trace_counter(const char* name, double value)
+{
+    _trace_record(name, 'C', value);
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#ifdef _WIN32
+    #include <SDL.h>
+#elif defined(__unix__) || defined(__linux__)
+    #include <SDL2/SDL.h>
+#endif
+
+#include <stdbool.h>
+
+#define TRACE_MAX_EVENTS (1 << 20)
+
+/*
+ * The tracing macros are compiled out completely, unless GAEGEBRA_TRACE is defined
+ * (configure with -DGAEGEBRA_TRACE=ON). The names have to be string literals, because only the pointers are stored.
+ */
+#ifdef GAEGEBRA_TRACE
+    #define TRACE_BEGIN(name) trace_begin(name)
+    #define TRACE_END(name) trace_end(name)
+    #define TRACE_COUNTER(name, value) trace_counter(name, (double)(value))
+#else
+    #define TRACE_BEGIN(name) ((void)0)
+    #define TRACE_END(name) ((void)0)
+    #define TRACE_COUNTER(name, value) ((void)0)
+#endif
+
+/**
+ * @brief Starts recording trace events (the events are written to the file when the recording is stopped)
+ *
+ * @param path The path of the JSON file (can be opened in chrome://tracing or Perfetto)
+ */
+void trace_start(const char* path);
+/**
+ * @brief Stops recording and writes the recorded events into the file given to trace_start
+ */
+void trace_stop();
+/**
+ * @brief Checks if trace events are being recorded
+ *
+ * @return true If the recording is running
+ * @return false If the recording is stopped
+ */
+bool trace_is_running();
+/**
+ * @brief Records the beginning of a span on the calling thread (use the TRACE_BEGIN macro instead)
+ *
+ * @param name The name of the span (string literal)
+ */
+void trace_begin(const char* name);
+/**
+ * @brief Records the end of a span on the calling thread (use the TRACE_END macro instead)
+ *
+ * @param name The name of the span (string literal)
+ */
+void trace_end(const char* name);
+/**
+ * @brief Records the value of a counter (use the TRACE_COUNTER macro instead)
+ *
+ * @param name The name of the counter (string literal)
+ * @param value The value of the counter
+ */
+void trace_counter(const char* name, double value);
@@ -10,6 +10,7 @@
 #include "../app/app.h"
 #include "../input/input.h"
 #include "../renderer/renderer.h"
+#include "../profiler/profiler.h"
 
 Window* window_create(const char* title, int width, int height, int flags)
 {
@@ -19,13 +20,15 @@ Window* window_create(const char* title, int width, int height, int flags)
         SDL_Log("could not allocate memory");
         exit(1);
     }
+    if (app_is_headless())
+        flags |= SDL_WINDOW_HIDDEN;
     window->window = SDL_CreateWindow(title, SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, width, height, flags);
     if (window->window == NULL)
     {
         SDL_Log("unable to create window: %s", SDL_GetError());
         exit(1);
     }
-    window->renderer = SDL_CreateRenderer(window->window, -1, SDL_RENDERER_ACCELERATED);
+    window->renderer = SDL_CreateRenderer(window->window, -1, app_is_headless() ? SDL_RENDERER_SOFTWARE : SDL_RENDERER_ACCELERATED);
     if (window->renderer == NULL)
     {
         SDL_Log("unable to create renderer: %s", SDL_GetError());
@@ -79,14 +82,20 @@ void _window_handle_event(Window* window, SDL_Event* event)
 void _window_update(Window* window)
 {
     _input_set_target(&window->input_data);
+    profiler_begin(PS_UI_UPDATE);
     _ui_update(&window->ui_data);
+    profiler_end(PS_UI_UPDATE);
 }
 void _window_render(Window* window)
 {
     _renderer_set_target(window->renderer);
     _ui_set_target(&window->ui_data);
+    profiler_begin(PS_UI_RENDER);
     _ui_render(&window->ui_data);
+    profiler_end(PS_UI_RENDER);
+    profiler_begin(PS_PRESENT);
     SDL_RenderPresent(window->renderer);
+    profiler_end(PS_PRESENT);
 }
 void _window_close(Window* window)
 {